@@ -0,0 +1,16 @@
+#ifndef CACHE_STATS_HPP
+#define CACHE_STATS_HPP
+
+#include <cstdint>
+
+// Counters describing how well a cache is doing. Each cache documents
+// which of them it keeps.
+struct CacheStats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t evictions = 0;
+    uint64_t entries = 0;
+    uint64_t bytes = 0;
+};
+
+#endif // CACHE_STATS_HPP
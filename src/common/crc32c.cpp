@@ -0,0 +1,144 @@
+#include "crc32c.hpp"
+#include "serialization.hpp"
+#include <array>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <nmmintrin.h>
+#define CRC32C_X86 1
+#elif defined(__aarch64__) && defined(__ARM_FEATURE_CRC32)
+#include <arm_acle.h>
+#define CRC32C_ARM 1
+#endif
+
+namespace crc32c {
+
+namespace {
+
+constexpr uint32_t POLYNOMIAL = 0x82F63B78; // Castagnoli, reflected
+
+// Slicing-by-8 tables: tables[k][b] is the CRC of byte b followed by k zero bytes
+constexpr std::array<std::array<uint32_t, 256>, 8> make_tables() {
+    std::array<std::array<uint32_t, 256>, 8> tables{};
+    for (uint32_t i = 0; i < 256; ++i) {
+        uint32_t crc = i;
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = (crc >> 1) ^ ((crc & 1) ? POLYNOMIAL : 0);
+        }
+        tables[0][i] = crc;
+    }
+    for (uint32_t i = 0; i < 256; ++i) {
+        for (size_t k = 1; k < 8; ++k) {
+            tables[k][i] = (tables[k - 1][i] >> 8) ^ tables[0][tables[k - 1][i] & 0xFF];
+        }
+    }
+    return tables;
+}
+
+constexpr auto TABLES = make_tables();
+
+using ExtendFunction = uint32_t (*)(uint32_t, std::span<const byte>);
+
+#if defined(CRC32C_X86)
+
+// Compiled for SSE4.2 regardless of the build flags; only called once the CPU reported support
+__attribute__((target("sse4.2"))) uint32_t extend_hardware(uint32_t crc, std::span<const byte> data) {
+    const byte* p = data.data();
+    size_t size = data.size();
+    crc = ~crc;
+#if defined(__x86_64__)
+    uint64_t crc64 = crc;
+    while (size >= 8) {
+        uint64_t word;
+        serialization::read_value(p, word);
+        crc64 = _mm_crc32_u64(crc64, word);
+        p += 8;
+        size -= 8;
+    }
+    crc = static_cast<uint32_t>(crc64);
+#endif
+    while (size >= 4) {
+        uint32_t word;
+        serialization::read_value(p, word);
+        crc = _mm_crc32_u32(crc, word);
+        p += 4;
+        size -= 4;
+    }
+    while (size-- > 0) {
+        crc = _mm_crc32_u8(crc, *p++);
+    }
+    return ~crc;
+}
+
+ExtendFunction select_implementation() {
+    return __builtin_cpu_supports("sse4.2") ? extend_hardware : extend_portable;
+}
+
+#elif defined(CRC32C_ARM)
+
+// The build already targets CPUs with the CRC extension
+uint32_t extend_hardware(uint32_t crc, std::span<const byte> data) {
+    const byte* p = data.data();
+    size_t size = data.size();
+    crc = ~crc;
+    while (size >= 8) {
+        uint64_t word;
+        serialization::read_value(p, word);
+        crc = __crc32cd(crc, word);
+        p += 8;
+        size -= 8;
+    }
+    while (size-- > 0) {
+        crc = __crc32cb(crc, *p++);
+    }
+    return ~crc;
+}
+
+ExtendFunction select_implementation() {
+    return extend_hardware;
+}
+
+#else
+
+ExtendFunction select_implementation() {
+    return extend_portable;
+}
+
+#endif
+
+ExtendFunction implementation() {
+    static const ExtendFunction selected = select_implementation();
+    return selected;
+}
+
+} // namespace
+
+uint32_t extend(uint32_t crc, std::span<const byte> data) {
+    return implementation()(crc, data);
+}
+
+bool hardware_accelerated() {
+    return implementation() != extend_portable;
+}
+
+uint32_t extend_portable(uint32_t crc, std::span<const byte> data) {
+    const byte* p = data.data();
+    size_t size = data.size();
+    crc = ~crc;
+
+    while (size >= 8) {
+        uint64_t word;
+        serialization::read_value(p, word);
+        word ^= crc; // Read little-endian, so the CRC lines up with the first four bytes
+        crc = TABLES[7][word & 0xFF] ^ TABLES[6][(word >> 8) & 0xFF] ^ TABLES[5][(word >> 16) & 0xFF] ^
+              TABLES[4][(word >> 24) & 0xFF] ^ TABLES[3][(word >> 32) & 0xFF] ^ TABLES[2][(word >> 40) & 0xFF] ^
+              TABLES[1][(word >> 48) & 0xFF] ^ TABLES[0][word >> 56];
+        p += 8;
+        size -= 8;
+    }
+    while (size-- > 0) {
+        crc = (crc >> 8) ^ TABLES[0][(crc ^ *p++) & 0xFF];
+    }
+    return ~crc;
+}
+
+} // namespace crc32c
@@ -0,0 +1,29 @@
+#ifndef CRC32C_HPP
+#define CRC32C_HPP
+
+#include "types.hpp"
+#include <cstdint>
+#include <span>
+
+namespace crc32c {
+
+// Continues a CRC32C (Castagnoli) checksum over more data. Start with
+// crc = 0; extending in pieces gives the same result as one call over the
+// concatenated data. Uses the CPU's CRC32 instruction when it has one
+// (SSE4.2 on x86, the CRC extension on ARMv8).
+uint32_t extend(uint32_t crc, std::span<const byte> data);
+
+// Table-driven implementation extend() falls back to without hardware support
+uint32_t extend_portable(uint32_t crc, std::span<const byte> data);
+
+// Whether extend() runs on the CRC32 instruction
+bool hardware_accelerated();
+
+// CRC32C of a single buffer
+inline uint32_t compute(std::span<const byte> data) {
+    return extend(0, data);
+}
+
+} // namespace crc32c
+
+#endif // CRC32C_HPP
@@ -24,29 +24,31 @@ const bytes VALUE_CHAIN_GENESIS_BLOCK_DATA = {
     0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
     0x78, 0x17, 0x90, 0x39, 0xb7, 0x76, 0x97, 0xac, 0xcc, 0x81, 0xd4, 0x93, 0x81, 0xa5, 0x42, 0x96, 
     0x36, 0xdc, 0xd5, 0x5e, 0x26, 0xd0, 0x67, 0xdb, 0xe4, 0xad, 0x05, 0xa5, 0x7d, 0xc8, 0x3e, 0x02, 
-    0x00, 0x78, 0x16, 0x9b, 0x75, 0xdb, 0x03, 0x18, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
+    0x00, 0x78, 0x16, 0x9b, 0x75, 0xdb, 0x03, 0x18, 0x8f, 0x9b, 0xf3, 0xb2, 0xb0, 0xc1, 0x5a, 0x08, 
+    0x34, 0xd2, 0xf1, 0x5c, 0x1e, 0x25, 0xa4, 0xd8, 0x8c, 0x55, 0x34, 0x78, 0x77, 0x3c, 0x3b, 0xfa, 
+    0xb6, 0x43, 0xb8, 0xc7, 0x5e, 0xb0, 0x5c, 0xae, 0x2e, 0x8b, 0xc9, 0x06, 0x24, 0x38, 0xcb, 0x64, 
+    0x53, 0x76, 0xe3, 0x8a, 0xec, 0x92, 0x46, 0x6b, 0x2b, 0x2c, 0x0e, 0x36, 0xe6, 0x36, 0x21, 0x04, 
+    0xfe, 0xe8, 0x3f, 0xce, 0x9d, 0x2e, 0xd1, 0x1d, 0x26, 0xea, 0xfb, 0xd8, 0x84, 0x35, 0x58, 0x16, 
+    0x02, 0x79, 0x2d, 0xfc, 0x0e, 0xad, 0x33, 0x96, 0x6b, 0x71, 0x61, 0x48, 0x3c, 0x6e, 0x37, 0xb7, 
+    0x16, 0xe8, 0x39, 0x9e, 0xaf, 0xb5, 0x68, 0x9a, 0xc9, 0x0b, 0xf6, 0xdd, 0xd8, 0xf2, 0xb2, 0xb2, 
+    0xb9, 0xb7, 0x53, 0x50, 0xfa, 0x4a, 0xc7, 0x79, 0xd7, 0xda, 0x59, 0xa1, 0xe6, 0xde, 0x61, 0x46, 
+    0xab, 0x83, 0x02, 0xe6, 0x05, 0x53, 0xd5, 0x09, 0xe9, 0x06, 0x0b, 0x47, 0x6b, 0xe6, 0xe2, 0xdb, 
+    0x15, 0x07, 0xb8, 0x47, 0x58, 0x38, 0x31, 0xec, 0x13, 0x2a, 0xb0, 0xd1, 0x47, 0x55, 0xb2, 0xa5, 
+    0x77, 0x49, 0xc8, 0x18, 0xec, 0xeb, 0xa0, 0x87, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
     0xd8, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
     0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x3d, 0x1b, 0x97, 0x65, 0xf4, 0x03, 0xea, 0xf0, 
-    0x49, 0x2b, 0x9d, 0xaa, 0xfc, 0xe0, 0x94, 0x25, 0xb5, 0xd1, 0x6d, 0x20, 0x1f, 0x3f, 0xfe, 0x11, 
-    0xc5, 0x7a, 0x20, 0xaa, 0xee, 0x18, 0x63, 0x5e, 0x32, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x2e, 0x8b, 0xc9, 0x06, 0x24, 0x38, 0xcb, 0x64, 
+    0x53, 0x76, 0xe3, 0x8a, 0xec, 0x92, 0x46, 0x6b, 0x2b, 0x2c, 0x0e, 0x36, 0xe6, 0x36, 0x21, 0x04, 
+    0xfe, 0xe8, 0x3f, 0xce, 0x9d, 0x2e, 0xd1, 0x1d, 0x32, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
     0x28, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x46, 0x69, 0x72, 0x73, 0x74, 0x20, 0x56, 0x61, 
     0x6c, 0x75, 0x65, 0x43, 0x68, 0x61, 0x69, 0x6e, 0x20, 0x47, 0x65, 0x6e, 0x65, 0x73, 0x69, 0x73, 
     0x20, 0x42, 0x6c, 0x6f, 0x63, 0x6b, 0x20, 0x52, 0x65, 0x66, 0x65, 0x72, 0x65, 0x6e, 0x63, 0x65, 
-    0xec, 0x01, 0xc7, 0x1e, 0xd7, 0xbb, 0x5e, 0x35, 0xb8, 0x1c, 0x9b, 0x6c, 0x5d, 0xd6, 0xb4, 0x95, 
-    0xfb, 0xa3, 0x8b, 0x9c, 0xec, 0xe6, 0x6c, 0x6f, 0x1b, 0x74, 0x9e, 0x0e, 0x93, 0x33, 0xc7, 0x89, 
-    0xf2, 0xe5, 0x58, 0x43, 0x2e, 0x1c, 0x87, 0x43, 0x88, 0xa0, 0xbf, 0x16, 0x41, 0x73, 0x24, 0xa5, 
-    0x25, 0xe4, 0x75, 0xbc, 0x60, 0xa7, 0x50, 0x66, 0xeb, 0xb7, 0x47, 0x76, 0xfb, 0xc7, 0x44, 0x13, 
-    0x7f, 0xe0, 0xf0, 0x70, 0x8a, 0x8a, 0x86, 0x90, 0x6c, 0x52, 0x5f, 0xfd, 0x5e, 0x74, 0xf1, 0xdb, 
-    0xc7, 0xdd, 0x83, 0x21, 0xf4, 0xef, 0x59, 0x20, 0x13, 0x56, 0xbe, 0xa0, 0x8d, 0x72, 0x4d, 0xbe, 
-    0x3d, 0x1b, 0x97, 0x65, 0xf4, 0x03, 0xea, 0xf0, 0x49, 0x2b, 0x9d, 0xaa, 0xfc, 0xe0, 0x94, 0x25, 
-    0xb5, 0xd1, 0x6d, 0x20, 0x1f, 0x3f, 0xfe, 0x11, 0xc5, 0x7a, 0x20, 0xaa, 0xee, 0x18, 0x63, 0x5e, 
-    0x7d, 0x96, 0x15, 0x1c, 0x3f, 0x90, 0x42, 0x28, 0x31, 0x9f, 0x73, 0x68, 0x01, 0xa2, 0x31, 0xa8, 
-    0x27, 0xb3, 0x21, 0xa5, 0xef, 0x64, 0xa4, 0xa2, 0x77, 0x57, 0xd7, 0xd1, 0xd3, 0xae, 0xc5, 0x11, 
-    0xb0, 0x0b, 0xf8, 0x3e, 0x13, 0x70, 0x29, 0x51, 0xdf, 0xc9, 0x33, 0x87, 0xde, 0xe4, 0xf1, 0x2f, 
-    0x27, 0x69, 0x11, 0xa8, 0xa4, 0x89, 0x56, 0xd2, 0xd2, 0x90, 0x9b, 0x7b, 0x50, 0x82, 0xa2, 0xea, 
-    0x74, 0x6d, 0x7e, 0xef, 0xe2, 0xb8, 0x5a, 0x85, 0x5a, 0x4b, 0xa6, 0xf6, 0x91, 0x96, 0xd0, 0xae, 
-    0x8a, 0x83, 0xdd, 0xab, 0xc4, 0xca, 0x59, 0xaa, 0x08, 0x82, 0x30, 0x77, 0xac, 0xab, 0x18, 0x25
+    0x01, 0xf9, 0xa0, 0x52, 0x16, 0xfd, 0x1e, 0xee, 0x15, 0x8e, 0x83, 0xfe, 0x4a, 0x18, 0xeb, 0x53, 
+    0x51, 0x88, 0x9a, 0x5c, 0x40, 0x76, 0xae, 0x92, 0x58, 0xd2, 0xe8, 0xc4, 0x8a, 0x26, 0x71, 0x21, 
+    0x35, 0xdf, 0x2c, 0xf9, 0x7b, 0x00, 0xd8, 0xb2, 0xa6, 0x9e, 0xdf, 0x3d, 0x37, 0x40, 0x18, 0x37, 
+    0x1b, 0x36, 0x11, 0x8f, 0x58, 0x2e, 0xe1, 0x1c, 0xe4, 0x65, 0xfc, 0x55, 0x0c, 0x5b, 0xc9, 0xac, 
+    0xea, 0x71, 0x53, 0x6a, 0x50, 0x84, 0xac, 0x70, 0x46, 0xdc, 0x62, 0xe4, 0xe9, 0x25, 0x08, 0x62, 
+    0x47, 0x82, 0xf4, 0x94, 0x35, 0x83, 0x7c, 0xbd, 0xc6, 0xcb, 0x17, 0xf8, 0x57, 0xa9, 0x69, 0xc2
 };
 
 const Hash TIME_CHAIN_GENESIS_HASH = {
@@ -57,10 +59,10 @@ const Hash TIME_CHAIN_GENESIS_HASH = {
 };
 
 const Hash VALUE_CHAIN_GENESIS_HASH = {
-    0x74, 0x6d, 0x7e, 0xef, 0xe2, 0xb8, 0x5a, 0x85, 
-    0x5a, 0x4b, 0xa6, 0xf6, 0x91, 0x96, 0xd0, 0xae, 
-    0x8a, 0x83, 0xdd, 0xab, 0xc4, 0xca, 0x59, 0xaa, 
-    0x08, 0x82, 0x30, 0x77, 0xac, 0xab, 0x18, 0x25
+    0xe9, 0x06, 0x0b, 0x47, 0x6b, 0xe6, 0xe2, 0xdb, 
+    0x15, 0x07, 0xb8, 0x47, 0x58, 0x38, 0x31, 0xec, 
+    0x13, 0x2a, 0xb0, 0xd1, 0x47, 0x55, 0xb2, 0xa5, 
+    0x77, 0x49, 0xc8, 0x18, 0xec, 0xeb, 0xa0, 0x87
 };
 
 } // namespace genesis
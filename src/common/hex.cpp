@@ -0,0 +1,223 @@
+#include "hex.hpp"
+#include <array>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define HEX_X86 1
+#endif
+
+namespace hex {
+
+namespace {
+
+constexpr char DIGITS[] = "0123456789abcdef";
+
+// Value of each character as a hex digit, or -1
+constexpr std::array<int8_t, 256> make_values() {
+    std::array<int8_t, 256> values{};
+    values.fill(-1);
+    for (int i = 0; i < 10; ++i) {
+        values['0' + i] = static_cast<int8_t>(i);
+    }
+    for (int i = 0; i < 6; ++i) {
+        values['a' + i] = static_cast<int8_t>(10 + i);
+        values['A' + i] = static_cast<int8_t>(10 + i);
+    }
+    return values;
+}
+
+constexpr auto VALUES = make_values();
+
+#if defined(HEX_X86)
+
+// The SIMD paths are compiled for their instruction set regardless of the
+// build flags and only called once the CPU reported support. Each handles
+// whole vectors and leaves the tail to the portable code.
+
+__attribute__((target("ssse3"))) char* encode_ssse3(std::span<const byte> data, char* out) {
+    const __m128i digits = _mm_loadu_si128(reinterpret_cast<const __m128i*>(DIGITS));
+    const __m128i low_nibble = _mm_set1_epi8(0x0f);
+    size_t i = 0;
+    for (; i + 16 <= data.size(); i += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data.data() + i));
+        __m128i high = _mm_shuffle_epi8(digits, _mm_and_si128(_mm_srli_epi16(v, 4), low_nibble));
+        __m128i low = _mm_shuffle_epi8(digits, _mm_and_si128(v, low_nibble));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm_unpacklo_epi8(high, low));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 16), _mm_unpackhi_epi8(high, low));
+        out += 32;
+    }
+    return encode_portable(data.subspan(i), out);
+}
+
+// Maps 16 hex characters to their values; bytes of valid are 0xff where
+// the character was a digit
+__attribute__((target("ssse3"))) __m128i digit_values(__m128i c, __m128i& valid) {
+    __m128i decimal = _mm_sub_epi8(c, _mm_set1_epi8('0'));
+    __m128i letter = _mm_sub_epi8(_mm_or_si128(c, _mm_set1_epi8(0x20)), _mm_set1_epi8('a'));
+    __m128i is_decimal = _mm_cmpeq_epi8(_mm_min_epu8(decimal, _mm_set1_epi8(9)), decimal);
+    __m128i is_letter = _mm_cmpeq_epi8(_mm_min_epu8(letter, _mm_set1_epi8(5)), letter);
+    valid = _mm_or_si128(is_decimal, is_letter);
+    return _mm_or_si128(_mm_and_si128(is_decimal, decimal),
+                        _mm_and_si128(is_letter, _mm_add_epi8(letter, _mm_set1_epi8(10))));
+}
+
+__attribute__((target("ssse3"))) bool decode_ssse3(std::string_view text, byte* out) {
+    // Multiplying adjacent pairs by 16 and 1 joins the high and low nibbles
+    const __m128i weights = _mm_set1_epi16(0x0110);
+    size_t i = 0;
+    for (; i + 32 <= text.size(); i += 32) {
+        __m128i valid_first, valid_second;
+        __m128i first = digit_values(_mm_loadu_si128(reinterpret_cast<const __m128i*>(text.data() + i)), valid_first);
+        __m128i second =
+            digit_values(_mm_loadu_si128(reinterpret_cast<const __m128i*>(text.data() + i + 16)), valid_second);
+        if (_mm_movemask_epi8(_mm_and_si128(valid_first, valid_second)) != 0xffff) {
+            return false;
+        }
+        __m128i packed = _mm_packus_epi16(_mm_maddubs_epi16(first, weights), _mm_maddubs_epi16(second, weights));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out), packed);
+        out += 16;
+    }
+    return decode_portable(text.substr(i), out);
+}
+
+__attribute__((target("avx2"))) char* encode_avx2(std::span<const byte> data, char* out) {
+    const __m256i digits = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(DIGITS)));
+    const __m256i low_nibble = _mm256_set1_epi8(0x0f);
+    size_t i = 0;
+    for (; i + 32 <= data.size(); i += 32) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data.data() + i));
+        __m256i high = _mm256_shuffle_epi8(digits, _mm256_and_si256(_mm256_srli_epi16(v, 4), low_nibble));
+        __m256i low = _mm256_shuffle_epi8(digits, _mm256_and_si256(v, low_nibble));
+        // Unpacking works within 128-bit lanes, so the halves come out interleaved
+        __m256i first = _mm256_unpacklo_epi8(high, low);
+        __m256i second = _mm256_unpackhi_epi8(high, low);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), _mm256_permute2x128_si256(first, second, 0x20));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + 32), _mm256_permute2x128_si256(first, second, 0x31));
+        out += 64;
+    }
+    return encode_ssse3(data.subspan(i), out);
+}
+
+__attribute__((target("avx2"))) __m256i digit_values(__m256i c, __m256i& valid) {
+    __m256i decimal = _mm256_sub_epi8(c, _mm256_set1_epi8('0'));
+    __m256i letter = _mm256_sub_epi8(_mm256_or_si256(c, _mm256_set1_epi8(0x20)), _mm256_set1_epi8('a'));
+    __m256i is_decimal = _mm256_cmpeq_epi8(_mm256_min_epu8(decimal, _mm256_set1_epi8(9)), decimal);
+    __m256i is_letter = _mm256_cmpeq_epi8(_mm256_min_epu8(letter, _mm256_set1_epi8(5)), letter);
+    valid = _mm256_or_si256(is_decimal, is_letter);
+    return _mm256_or_si256(_mm256_and_si256(is_decimal, decimal),
+                           _mm256_and_si256(is_letter, _mm256_add_epi8(letter, _mm256_set1_epi8(10))));
+}
+
+__attribute__((target("avx2"))) bool decode_avx2(std::string_view text, byte* out) {
+    const __m256i weights = _mm256_set1_epi16(0x0110);
+    size_t i = 0;
+    for (; i + 64 <= text.size(); i += 64) {
+        __m256i valid_first, valid_second;
+        __m256i first =
+            digit_values(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(text.data() + i)), valid_first);
+        __m256i second =
+            digit_values(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(text.data() + i + 32)), valid_second);
+        if (_mm256_movemask_epi8(_mm256_and_si256(valid_first, valid_second)) != -1) {
+            return false;
+        }
+        // Packing also works per lane; put the 64-bit quarters back in order
+        __m256i packed =
+            _mm256_packus_epi16(_mm256_maddubs_epi16(first, weights), _mm256_maddubs_epi16(second, weights));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), _mm256_permute4x64_epi64(packed, 0xD8));
+        out += 32;
+    }
+    return decode_ssse3(text.substr(i), out);
+}
+
+std::vector<Implementation> supported_implementations() {
+    std::vector<Implementation> supported;
+    if (__builtin_cpu_supports("avx2")) {
+        supported.push_back({encode_avx2, decode_avx2, "avx2"});
+    }
+    if (__builtin_cpu_supports("ssse3")) {
+        supported.push_back({encode_ssse3, decode_ssse3, "ssse3"});
+    }
+    supported.push_back({encode_portable, decode_portable, "portable"});
+    return supported;
+}
+
+#else
+
+std::vector<Implementation> supported_implementations() {
+    return {{encode_portable, decode_portable, "portable"}};
+}
+
+#endif
+
+Implementation select_implementation() {
+    return supported_implementations().front();
+}
+
+const Implementation& implementation() {
+    static const Implementation selected = select_implementation();
+    return selected;
+}
+
+} // namespace
+
+char* encode(std::span<const byte> data, char* out) {
+    return implementation().encode(data, out);
+}
+
+std::string encode(std::span<const byte> data) {
+    std::string text(encoded_size(data.size()), '\0');
+    encode(data, text.data());
+    return text;
+}
+
+bool decode(std::string_view text, byte* out) {
+    if (text.size() % 2 != 0) {
+        return false;
+    }
+    return implementation().decode(text, out);
+}
+
+std::optional<bytes> decode(std::string_view text) {
+    if (text.size() % 2 != 0) {
+        return std::nullopt;
+    }
+    bytes data(text.size() / 2);
+    if (!decode(text, data.data())) {
+        return std::nullopt;
+    }
+    return data;
+}
+
+const char* instruction_set() {
+    return implementation().name;
+}
+
+std::vector<Implementation> implementations() {
+    return supported_implementations();
+}
+
+char* encode_portable(std::span<const byte> data, char* out) {
+    for (byte b : data) {
+        *out++ = DIGITS[b >> 4];
+        *out++ = DIGITS[b & 0x0f];
+    }
+    return out;
+}
+
+bool decode_portable(std::string_view text, byte* out) {
+    if (text.size() % 2 != 0) {
+        return false;
+    }
+    for (size_t i = 0; i < text.size(); i += 2) {
+        int high = VALUES[static_cast<unsigned char>(text[i])];
+        int low = VALUES[static_cast<unsigned char>(text[i + 1])];
+        if (high < 0 || low < 0) {
+            return false;
+        }
+        *out++ = static_cast<byte>((high << 4) | low);
+    }
+    return true;
+}
+
+} // namespace hex
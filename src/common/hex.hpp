@@ -0,0 +1,55 @@
+#ifndef HEX_HPP
+#define HEX_HPP
+
+#include "types.hpp"
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Hexadecimal encoding of hashes, keys and other binary fields for file
+// names, logs and the tools. Uses AVX2 or SSSE3 when the CPU has them.
+namespace hex {
+
+// Number of characters encoding size bytes
+constexpr size_t encoded_size(size_t size) {
+    return size * 2;
+}
+
+// Writes 2 * data.size() lowercase hex digits to out and returns the
+// position just past them. No terminator is written.
+char* encode(std::span<const byte> data, char* out);
+
+std::string encode(std::span<const byte> data);
+
+// Decodes text into text.size() / 2 bytes at out. Digits may be upper or
+// lower case. Fails, possibly after writing part of out, if text has an odd
+// length or a character that is not a hex digit.
+bool decode(std::string_view text, byte* out);
+
+std::optional<bytes> decode(std::string_view text);
+
+// Scalar implementations the functions above fall back to without SIMD support
+char* encode_portable(std::span<const byte> data, char* out);
+bool decode_portable(std::string_view text, byte* out);
+
+// Instruction set encode() and decode() run on: "avx2", "ssse3" or "portable"
+const char* instruction_set();
+
+// An encode() and decode() pair and the instruction set it runs on. Its
+// decode expects text of even length, which decode() checks beforehand.
+struct Implementation {
+    char* (*encode)(std::span<const byte> data, char* out);
+    bool (*decode)(std::string_view text, byte* out);
+    const char* name;
+};
+
+// Every implementation this CPU can run, the one encode() and decode()
+// pick first and the portable one last, so each can be checked against
+// the others
+std::vector<Implementation> implementations();
+
+} // namespace hex
+
+#endif // HEX_HPP
@@ -0,0 +1,454 @@
+#ifndef SCHEMA_HPP
+#define SCHEMA_HPP
+
+#include "serialization.hpp"
+#include "types.hpp"
+#include <cstring>
+#include <limits>
+#include <optional>
+#include <ranges>
+#include <span>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+// Compile-time descriptions of serialized layouts. A type lists its fields
+// once, in wire order, as a schema::Record; the encoder, decoder, size
+// computation, signing preimage and field offsets all come from that list,
+// for every serialization::Format. Records made only of Fixed fields have a
+// compile-time v1 size, and their v1 codecs reduce to memcpys at constant
+// offsets (plus byte swaps for integers on big-endian hosts).
+//
+// Each field type provides, for a Format F:
+//   FIXED, min_size(format)         whether its v1 size is known, and its smallest size
+//   size<F>(object)                 its serialized size in object
+//   write<F>(out, object)           writes it, returning the position after it
+//   read<F>(in, object)             reads it from the front of in, advancing in
+//   skip<F>(in)                     checks it is well formed and advances past it
+namespace schema {
+
+using serialization::Format;
+
+namespace detail {
+
+template <typename>
+struct member_traits;
+
+template <typename Class, typename Type>
+struct member_traits<Type Class::*> {
+    using class_type = Class;
+    using type = Type;
+};
+
+// Reads a length or count: a uint64_t in v1, a varint in v2
+template <Format F>
+bool read_length(std::span<const byte>& in, uint64_t& length) {
+    if constexpr (F == Format::v2) {
+        return serialization::read_varint(in, length);
+    } else {
+        if (in.size() < sizeof(uint64_t)) {
+            return false;
+        }
+        serialization::read_value(in.data(), length);
+        in = in.subspan(sizeof(uint64_t));
+        return true;
+    }
+}
+
+template <Format F>
+byte* write_length(byte* out, uint64_t length) {
+    if constexpr (F == Format::v2) {
+        return serialization::write_varint(out, length);
+    } else {
+        return serialization::write_value(out, length);
+    }
+}
+
+template <Format F>
+constexpr size_t length_size(uint64_t length) {
+    return F == Format::v2 ? serialization::varint_size(length) : sizeof(uint64_t);
+}
+
+template <typename Field>
+constexpr bool is_digest = requires { Field::DIGEST; };
+
+// Position of the one Digest among Fields
+template <typename... Fields>
+constexpr size_t digest_index() {
+    constexpr bool digests[] = {is_digest<Fields>...};
+    static_assert((size_t{0} + ... + is_digest<Fields>) == 1, "a Record needs exactly one Digest field");
+    size_t index = 0;
+    while (!digests[index]) {
+        ++index;
+    }
+    return index;
+}
+
+} // namespace detail
+
+// A byte array or integer. Arrays are stored as their raw bytes; integers
+// are stored little-endian in v1 and as varints in v2.
+template <auto Member>
+struct Fixed {
+    using Class = typename detail::member_traits<decltype(Member)>::class_type;
+    using Type = typename detail::member_traits<decltype(Member)>::type;
+    static_assert(std::is_trivially_copyable_v<Type>);
+
+    static constexpr bool VARINT = std::is_unsigned_v<Type>;
+    static constexpr bool FIXED = true;
+
+    static constexpr size_t min_size(Format format) {
+        return format == Format::v2 && VARINT ? 1 : sizeof(Type);
+    }
+
+    template <Format F>
+    static constexpr size_t size(const Class& object) {
+        if constexpr (F == Format::v2 && VARINT) {
+            return serialization::varint_size(object.*Member);
+        } else {
+            return sizeof(Type);
+        }
+    }
+
+    template <Format F>
+    static byte* write(byte* out, const Class& object) {
+        if constexpr (F == Format::v2 && VARINT) {
+            return serialization::write_varint(out, object.*Member);
+        } else {
+            return serialization::write_value(out, object.*Member);
+        }
+    }
+
+    // Reads the v1 field from a position already known to be in bounds
+    static void load(const byte* in, Class& object) {
+        serialization::read_value(in, object.*Member);
+    }
+
+    template <Format F>
+    static bool read(std::span<const byte>& in, Class& object) {
+        if constexpr (F == Format::v2 && VARINT) {
+            uint64_t value = 0;
+            if (!serialization::read_varint(in, value) || value > std::numeric_limits<Type>::max()) {
+                return false;
+            }
+            object.*Member = static_cast<Type>(value);
+            return true;
+        } else {
+            if (in.size() < sizeof(Type)) {
+                return false;
+            }
+            load(in.data(), object);
+            in = in.subspan(sizeof(Type));
+            return true;
+        }
+    }
+
+    template <Format F>
+    static bool skip(std::span<const byte>& in) {
+        if constexpr (F == Format::v2 && VARINT) {
+            uint64_t value = 0;
+            return serialization::read_varint(in, value) && value <= std::numeric_limits<Type>::max();
+        } else {
+            if (in.size() < sizeof(Type)) {
+                return false;
+            }
+            in = in.subspan(sizeof(Type));
+            return true;
+        }
+    }
+};
+
+// A record's hash: a Fixed field over the v1 encoding of every field in
+// front of it. Fields behind it are left out of the hash, so a record can
+// keep a constant-size hashed header and commit to the rest another way.
+template <auto Member>
+struct Digest : Fixed<Member> {
+    static constexpr bool DIGEST = true;
+};
+
+// A byte vector behind its length
+template <auto Member>
+struct Blob {
+    using Class = typename detail::member_traits<decltype(Member)>::class_type;
+
+    static constexpr bool FIXED = false;
+
+    static constexpr size_t min_size(Format format) {
+        return format == Format::v2 ? 1 : sizeof(uint64_t);
+    }
+
+    template <Format F>
+    static size_t size(const Class& object) {
+        size_t length = (object.*Member).size();
+        return detail::length_size<F>(length) + length;
+    }
+
+    template <Format F>
+    static byte* write(byte* out, const Class& object) {
+        const auto& field = object.*Member;
+        out = detail::write_length<F>(out, field.size());
+        return serialization::write_bytes(out, field);
+    }
+
+    template <Format F>
+    static bool read(std::span<const byte>& in, Class& object) {
+        uint64_t length = 0;
+        if (!detail::read_length<F>(in, length) || length > in.size()) {
+            return false;
+        }
+        (object.*Member).assign(in.begin(), in.begin() + length);
+        in = in.subspan(length);
+        return true;
+    }
+
+    template <Format F>
+    static bool skip(std::span<const byte>& in) {
+        uint64_t length = 0;
+        if (!detail::read_length<F>(in, length) || length > in.size()) {
+            return false;
+        }
+        in = in.subspan(length);
+        return true;
+    }
+};
+
+// A vector of records behind their count, each record behind its size.
+// Elements are encoded with their own Schema, in the same format.
+template <auto Member>
+struct Sequence {
+    using Class = typename detail::member_traits<decltype(Member)>::class_type;
+    using Element = std::ranges::range_value_t<typename detail::member_traits<decltype(Member)>::type>;
+    using ElementSchema = typename Element::Schema;
+
+    static constexpr bool FIXED = false;
+
+    static constexpr size_t min_size(Format format) {
+        return format == Format::v2 ? 1 : sizeof(uint64_t);
+    }
+
+    template <Format F>
+    static size_t size(const Class& object) {
+        const auto& elements = object.*Member;
+        size_t total = detail::length_size<F>(elements.size());
+        for (const Element& element : elements) {
+            size_t element_size = ElementSchema::template size<ElementSchema::FIELD_COUNT, F>(element);
+            total += detail::length_size<F>(element_size) + element_size;
+        }
+        return total;
+    }
+
+    template <Format F>
+    static byte* write(byte* out, const Class& object) {
+        const auto& elements = object.*Member;
+        out = detail::write_length<F>(out, elements.size());
+        for (const Element& element : elements) {
+            out = detail::write_length<F>(out, ElementSchema::template size<ElementSchema::FIELD_COUNT, F>(element));
+            out = ElementSchema::template write<ElementSchema::FIELD_COUNT, F>(out, element);
+        }
+        return out;
+    }
+
+    template <Format F>
+    static bool read(std::span<const byte>& in, Class& object) {
+        uint64_t count = 0;
+        if (!read_count<F>(in, count)) {
+            return false;
+        }
+        auto& elements = object.*Member;
+        elements.clear();
+        elements.reserve(count);
+        for (uint64_t i = 0; i < count; ++i) {
+            uint64_t length = 0;
+            if (!detail::read_length<F>(in, length) || length > in.size()) {
+                return false;
+            }
+            if (!ElementSchema::template read<F>(in.first(length), elements.emplace_back())) {
+                return false;
+            }
+            in = in.subspan(length);
+        }
+        return true;
+    }
+
+    template <Format F>
+    static bool skip(std::span<const byte>& in) {
+        uint64_t count = 0;
+        if (!read_count<F>(in, count)) {
+            return false;
+        }
+        for (uint64_t i = 0; i < count; ++i) {
+            uint64_t length = 0;
+            if (!detail::read_length<F>(in, length) || length > in.size() ||
+                !ElementSchema::template matches<F>(in.first(length))) {
+                return false;
+            }
+            in = in.subspan(length);
+        }
+        return true;
+    }
+
+private:
+    // Bounds the count by what the input could hold before anything is reserved for it
+    template <Format F>
+    static bool read_count(std::span<const byte>& in, uint64_t& count) {
+        size_t smallest = detail::length_size<F>(0) + ElementSchema::min_size(F);
+        return detail::read_length<F>(in, count) && count <= in.size() / smallest;
+    }
+};
+
+// A serialized layout: Fields in wire order, of which the first SignedCount
+// make up the signing preimage. The Digest field is the record's hash,
+// taken over the v1 encoding of everything in front of it.
+//
+// A class that keeps its own v1 encoding can make Record use it by
+// befriending its Schema and providing
+//   byte* write_cached(byte* out) const       writes the whole v1 record
+//   void restore_cached(data, format)         called with a record's bytes
+//                                             after its fields were read
+template <size_t SignedCount, typename... Fields>
+struct Record {
+    using Class = typename std::tuple_element_t<0, std::tuple<Fields...>>::Class;
+    template <size_t I>
+    using Field = std::tuple_element_t<I, std::tuple<Fields...>>;
+
+    static constexpr size_t FIELD_COUNT = sizeof...(Fields);
+    static constexpr size_t SIGNED_COUNT = SignedCount;
+    static constexpr size_t HASHED_COUNT = detail::digest_index<Fields...>();
+    static_assert(SignedCount < HASHED_COUNT);
+
+    // Whether the v1 layout has a compile-time size, and its smallest size
+    static constexpr bool FIXED = (Fields::FIXED && ...);
+    static constexpr size_t MIN_SIZE = (Fields::min_size(Format::v1) + ...);
+
+    // Smallest encoding in a format, not counting the v2 version byte
+    static constexpr size_t min_size(Format format) {
+        return (Fields::min_size(format) + ...);
+    }
+
+    // Whether the first Count fields all have a compile-time v1 size
+    template <size_t Count>
+    static constexpr bool fixed_prefix() {
+        return []<size_t... I>(std::index_sequence<I...>) {
+            return (true && ... && Field<I>::FIXED);
+        }(std::make_index_sequence<Count>{});
+    }
+
+    // Where field I starts in v1, for fields behind a fixed-size prefix
+    template <size_t I>
+        requires(fixed_prefix<I>())
+    static constexpr size_t offset() {
+        return []<size_t... J>(std::index_sequence<J...>) {
+            return (size_t{0} + ... + Field<J>::min_size(Format::v1));
+        }(std::make_index_sequence<I>{});
+    }
+
+    // Serialized size of the first Count fields
+    template <size_t Count = FIELD_COUNT, Format F = Format::v1>
+    static constexpr size_t size(const Class& object) {
+        if constexpr (F == Format::v1 && fixed_prefix<Count>()) {
+            return offset<Count>();
+        } else {
+            return [&]<size_t... I>(std::index_sequence<I...>) {
+                return (size_t{0} + ... + Field<I>::template size<F>(object));
+            }(std::make_index_sequence<Count>{});
+        }
+    }
+
+    // Writes the first Count fields, returning the position after them
+    template <size_t Count = FIELD_COUNT, Format F = Format::v1>
+    static byte* write(byte* out, const Class& object) {
+        if constexpr (Count == FIELD_COUNT && F == Format::v1 && requires { object.write_cached(out); }) {
+            return object.write_cached(out);
+        } else {
+            [&]<size_t... I>(std::index_sequence<I...>) {
+                ((out = Field<I>::template write<F>(out, object)), ...);
+            }(std::make_index_sequence<Count>{});
+            return out;
+        }
+    }
+
+    // Reads a record that must take up all of data
+    template <Format F = Format::v1>
+    static bool read(std::span<const byte> data, Class& object) {
+        std::span<const byte> record = data;
+        bool complete;
+        if constexpr (F == Format::v1 && FIXED) {
+            complete = data.size() == MIN_SIZE;
+            if (complete) {
+                [&]<size_t... I>(std::index_sequence<I...>) {
+                    (Field<I>::load(data.data() + offset<I>(), object), ...);
+                }(std::make_index_sequence<FIELD_COUNT>{});
+            }
+        } else {
+            complete = [&]<size_t... I>(std::index_sequence<I...>) {
+                return (Field<I>::template read<F>(data, object) && ...);
+            }(std::make_index_sequence<FIELD_COUNT>{});
+            complete = complete && data.empty();
+        }
+        if constexpr (requires { object.restore_cached(record, F); }) {
+            if (complete) {
+                object.restore_cached(record, F);
+            }
+        }
+        return complete;
+    }
+
+    // Whether data holds exactly one well-formed record, without decoding it
+    template <Format F = Format::v1>
+    static bool matches(std::span<const byte> data) {
+        if constexpr (F == Format::v1 && FIXED) {
+            return data.size() == MIN_SIZE;
+        } else {
+            bool complete = [&]<size_t... I>(std::index_sequence<I...>) {
+                return (Field<I>::template skip<F>(data) && ...);
+            }(std::make_index_sequence<FIELD_COUNT>{});
+            return complete && data.empty();
+        }
+    }
+
+    // Full encodings, including the version byte in front of v2
+    static size_t encoded_size(const Class& object, Format format) {
+        if (format == Format::v2) {
+            return 1 + size<FIELD_COUNT, Format::v2>(object);
+        }
+        return size(object);
+    }
+
+    static byte* encode(byte* out, const Class& object, Format format) {
+        if (format == Format::v2) {
+            *out++ = serialization::FORMAT_V2_TAG;
+            return write<FIELD_COUNT, Format::v2>(out, object);
+        }
+        return write(out, object);
+    }
+
+    // Which format data is encoded in, if either. v1 has no version byte,
+    // so it is tried first: a v2 encoding is never also a well-formed v1
+    // record of exactly its length in practice, while a v1 encoding may
+    // well start with the v2 tag.
+    static std::optional<Format> detect(std::span<const byte> data) {
+        if (matches(data)) {
+            return Format::v1;
+        }
+        if (!data.empty() && data[0] == serialization::FORMAT_V2_TAG && matches<Format::v2>(data.subspan(1))) {
+            return Format::v2;
+        }
+        return std::nullopt;
+    }
+
+    // Reads a record in whichever format it is encoded in
+    static bool decode(std::span<const byte> data, Class& object) {
+        auto format = detect(data);
+        if (format == Format::v1) {
+            return read(data, object);
+        }
+        if (format == Format::v2) {
+            return read<Format::v2>(data.subspan(1), object);
+        }
+        return false;
+    }
+};
+
+} // namespace schema
+
+#endif // SCHEMA_HPP
@@ -0,0 +1,108 @@
+#ifndef SERIALIZATION_HPP
+#define SERIALIZATION_HPP
+
+#include "types.hpp"
+#include <bit>
+#include <cstring>
+#include <span>
+#include <type_traits>
+
+// Helpers for writing fields into a preallocated buffer. Callers size the
+// buffer up front from serialized_size(), so the writers do no bounds
+// checking; each returns the position just past what it wrote.
+namespace serialization {
+
+// Encodings blocks and transactions can be serialized in. v1 is the
+// original layout, with fixed-width little-endian integers. v2 starts
+// with a version byte and writes every integer as a LEB128 varint, which
+// is little-endian by construction and usually much shorter. Hashes and
+// signatures always cover the v1 layout, so a block has the same hash in
+// either encoding.
+enum class Format : uint8_t {
+    v1 = 1,
+    v2 = 2,
+};
+
+// Leading byte of every v2 encoding
+constexpr byte FORMAT_V2_TAG = static_cast<byte>(Format::v2);
+
+// Longest LEB128 encoding of a uint64_t
+constexpr size_t MAX_VARINT_SIZE = 10;
+
+inline byte* write_bytes(byte* out, std::span<const byte> field) {
+    if (!field.empty()) {
+        std::memcpy(out, field.data(), field.size());
+    }
+    return out + field.size();
+}
+
+// Writes a fixed-width field as the v1 format stores it: integers
+// little-endian whatever the host's byte order, byte arrays as they are.
+// On little-endian hosts both directions are plain copies.
+template <typename T>
+    requires std::is_trivially_copyable_v<T>
+inline byte* write_value(byte* out, const T& value) {
+    if constexpr (std::is_integral_v<T> && std::endian::native != std::endian::little) {
+        T swapped = std::byteswap(value);
+        std::memcpy(out, &swapped, sizeof(T));
+    } else {
+        std::memcpy(out, &value, sizeof(T));
+    }
+    return out + sizeof(T);
+}
+
+// Reads a field written by write_value() from a position known to be in bounds
+template <typename T>
+    requires std::is_trivially_copyable_v<T>
+inline void read_value(const byte* in, T& value) {
+    std::memcpy(&value, in, sizeof(T));
+    if constexpr (std::is_integral_v<T> && std::endian::native != std::endian::little) {
+        value = std::byteswap(value);
+    }
+}
+
+constexpr size_t varint_size(uint64_t value) {
+    size_t size = 1;
+    while (value >= 0x80) {
+        value >>= 7;
+        ++size;
+    }
+    return size;
+}
+
+// Writes value as a LEB128 varint: seven bits per byte, least significant
+// group first, with the high bit set on every byte but the last
+inline byte* write_varint(byte* out, uint64_t value) {
+    while (value >= 0x80) {
+        *out++ = static_cast<byte>(value | 0x80);
+        value >>= 7;
+    }
+    *out++ = static_cast<byte>(value);
+    return out;
+}
+
+// Reads a varint from the front of in and advances past it. Only the
+// shortest encoding of each value is accepted, so every value has exactly
+// one v2 encoding.
+inline bool read_varint(std::span<const byte>& in, uint64_t& value) {
+    value = 0;
+    for (size_t i = 0; i < in.size() && i < MAX_VARINT_SIZE; ++i) {
+        byte b = in[i];
+        if (i == MAX_VARINT_SIZE - 1 && b > 1) {
+            return false; // More than 64 bits
+        }
+        value |= static_cast<uint64_t>(b & 0x7f) << (7 * i);
+        if ((b & 0x80) == 0) {
+            if (b == 0 && i > 0) {
+                return false; // Padded with a redundant zero group
+            }
+            in = in.subspan(i + 1);
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace serialization
+
+#endif // SERIALIZATION_HPP
@@ -0,0 +1,112 @@
+#include "thread_pool.hpp"
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
+namespace {
+
+// One parallel_for() call. Helpers that start after every chunk has been
+// claimed find nothing to do, so the job is shared with them rather than
+// living on the caller's stack.
+struct Job {
+    const std::function<void(size_t, size_t)>* body;
+    size_t count;
+    size_t chunk_size;
+    size_t chunks;
+    std::atomic<size_t> next_chunk{0};
+
+    std::mutex mutex;
+    std::condition_variable done_cv;
+    size_t done_chunks = 0;
+
+    // Runs chunks until none are left unclaimed
+    void work() {
+        size_t finished = 0;
+        for (size_t chunk = next_chunk++; chunk < chunks; chunk = next_chunk++) {
+            size_t begin = chunk * chunk_size;
+            (*body)(begin, std::min(count, begin + chunk_size));
+            ++finished;
+        }
+        if (finished > 0) {
+            std::lock_guard<std::mutex> lock(mutex);
+            done_chunks += finished;
+            if (done_chunks == chunks) {
+                done_cv.notify_all();
+            }
+        }
+    }
+};
+
+} // namespace
+
+ThreadPool::ThreadPool(size_t threads) : stopping_(false) {
+    workers_.reserve(threads);
+    for (size_t i = 0; i < threads; ++i) {
+        workers_.emplace_back(&ThreadPool::run_worker, this);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    work_cv_.notify_all();
+    for (std::thread& worker : workers_) {
+        worker.join();
+    }
+}
+
+size_t ThreadPool::size() const {
+    return workers_.size();
+}
+
+void ThreadPool::parallel_for(size_t count, size_t min_chunk, const std::function<void(size_t, size_t)>& body) {
+    if (count == 0) {
+        return;
+    }
+    min_chunk = std::max<size_t>(min_chunk, 1);
+    size_t chunks = std::min((count + min_chunk - 1) / min_chunk, workers_.size() + 1);
+    if (chunks <= 1) {
+        body(0, count);
+        return;
+    }
+
+    auto job = std::make_shared<Job>();
+    job->body = &body;
+    job->count = count;
+    job->chunk_size = (count + chunks - 1) / chunks;
+    job->chunks = (count + job->chunk_size - 1) / job->chunk_size;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (size_t i = 1; i < job->chunks; ++i) {
+            tasks_.emplace_back([job] { job->work(); });
+        }
+    }
+    work_cv_.notify_all();
+
+    job->work();
+    std::unique_lock<std::mutex> lock(job->mutex);
+    job->done_cv.wait(lock, [&] { return job->done_chunks == job->chunks; });
+}
+
+ThreadPool& ThreadPool::shared() {
+    static ThreadPool pool(std::max(std::thread::hardware_concurrency(), 1u) - 1);
+    return pool;
+}
+
+void ThreadPool::run_worker() {
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            work_cv_.wait(lock, [this] { return stopping_ || !tasks_.empty(); });
+            if (tasks_.empty()) {
+                return;
+            }
+            task = std::move(tasks_.front());
+            tasks_.pop_front();
+        }
+        task();
+    }
+}
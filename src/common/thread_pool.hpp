@@ -0,0 +1,47 @@
+#ifndef THREAD_POOL_HPP
+#define THREAD_POOL_HPP
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads for data-parallel work such as hashing the
+// transactions of a block. parallel_for() splits a range into chunks that
+// the workers and the calling thread claim one at a time, so it makes
+// progress even when every worker is busy, and may be called from inside
+// another parallel_for().
+class ThreadPool {
+public:
+    explicit ThreadPool(size_t threads);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Number of worker threads, not counting callers
+    size_t size() const;
+
+    // Calls body(begin, end) over consecutive pieces of [0, count), each at
+    // least min_chunk long except the last, and returns once all have run.
+    // body must not throw.
+    void parallel_for(size_t count, size_t min_chunk, const std::function<void(size_t, size_t)>& body);
+
+    // Pool shared by the whole process, with one worker per hardware thread
+    // besides the caller's
+    static ThreadPool& shared();
+
+private:
+    void run_worker();
+
+    std::mutex mutex_;
+    std::condition_variable work_cv_;
+    std::deque<std::function<void()>> tasks_;
+    bool stopping_;
+    std::vector<std::thread> workers_;
+};
+
+#endif // THREAD_POOL_HPP
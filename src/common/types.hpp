@@ -2,6 +2,7 @@
 #define TYPES_HPP
 
 #include <cstdint>
+#include <cstring>
 #include <array>
 #include <vector>
 #include <string>
@@ -14,6 +15,16 @@ using bytes = std::vector<byte>;
 constexpr size_t HASH_SIZE = 32;
 using Hash = std::array<byte, HASH_SIZE>;
 
+// Hasher for unordered containers keyed by Hash. Hashes are SHA-256
+// output, so the leading bytes are already uniformly distributed.
+struct HashHasher {
+    size_t operator()(const Hash& hash) const noexcept {
+        size_t value;
+        std::memcpy(&value, hash.data(), sizeof(value));
+        return value;
+    }
+};
+
 // Public and private key types
 constexpr size_t PUBLIC_KEY_SIZE = 32;
 using PublicKey = std::array<byte, PUBLIC_KEY_SIZE>;
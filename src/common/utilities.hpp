@@ -6,12 +6,6 @@
 
 namespace utilities {
 
-// Converts a hexadecimal string to a byte vector
-bytes hex_to_bytes(const std::string& hex);
-
-// Converts a byte vector to a hexadecimal string
-std::string bytes_to_hex(const bytes& data);
-
 // Retrieves the current time as TimePoint
 TimePoint get_current_time();
 
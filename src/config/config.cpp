@@ -10,17 +10,45 @@ bool Config::load_from_command_line(int argc, char* argv[]) {
     // Default values
     node_role = "dual";
     port = 8001;
+    storage_backend = "file";
+    block_format = "v1";
+    sync_writes = false;
+    bloom_filter = true;
+    time_chain_cache_mb = 4;
+    value_chain_cache_mb = 32;
+    write_queue_blocks = 64;
 
     for (int i = 1; i < argc; ++i) {
         if (std::strcmp(argv[i], "--port") == 0 && i + 1 < argc) {
             port = std::stoi(argv[++i]);
         } else if (std::strcmp(argv[i], "--role") == 0 && i + 1 < argc) {
             node_role = argv[++i];
+        } else if (std::strcmp(argv[i], "--storage") == 0 && i + 1 < argc) {
+            storage_backend = argv[++i];
+        } else if (std::strcmp(argv[i], "--block-format") == 0 && i + 1 < argc) {
+            block_format = argv[++i];
+        } else if (std::strcmp(argv[i], "--sync-writes") == 0) {
+            sync_writes = true;
+        } else if (std::strcmp(argv[i], "--no-bloom-filter") == 0) {
+            bloom_filter = false;
+        } else if (std::strcmp(argv[i], "--time-cache-mb") == 0 && i + 1 < argc) {
+            time_chain_cache_mb = std::stoul(argv[++i]);
+        } else if (std::strcmp(argv[i], "--value-cache-mb") == 0 && i + 1 < argc) {
+            value_chain_cache_mb = std::stoul(argv[++i]);
+        } else if (std::strcmp(argv[i], "--write-queue") == 0 && i + 1 < argc) {
+            write_queue_blocks = std::stoul(argv[++i]);
         } else {
             // Unknown argument
             return false;
         }
     }
 
+    if (storage_backend != "file" && storage_backend != "segment" && storage_backend != "uring") {
+        return false;
+    }
+    if (block_format != "v1" && block_format != "v2") {
+        return false;
+    }
+
     return true;
 }
@@ -2,6 +2,7 @@
 #define CONFIG_HPP
 
 #include <string>
+#include <cstddef>
 
 class Config {
 public:
@@ -11,6 +12,13 @@ public:
 
     std::string node_role;
     int port;
+    std::string storage_backend;
+    std::string block_format;
+    bool sync_writes;
+    bool bloom_filter;
+    size_t time_chain_cache_mb;
+    size_t value_chain_cache_mb;
+    size_t write_queue_blocks;
 
 private:
     Config() = default;
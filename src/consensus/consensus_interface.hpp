@@ -1,7 +1,7 @@
 #ifndef CONSENSUS_INTERFACE_HPP
 #define CONSENSUS_INTERFACE_HPP
 
-#include <optional>
+#include <functional>
 
 template <typename BlockType>
 class ConsensusInterface {
@@ -17,8 +17,11 @@ public:
     // Checks if the node is eligible to produce a block
     virtual bool is_eligible_to_produce_block() = 0;
 
-    // Produces a new block if eligible
-    virtual std::optional<BlockType> produce_block() = 0;
+    // Produces a new block if eligible and hands it to storage without
+    // waiting for the write. on_stored is called with the block once it is
+    // stored, possibly from the storage's writer thread, and not at all if
+    // storing fails. Returns whether a block was produced.
+    virtual bool produce_block(std::function<void(const BlockType&)> on_stored) = 0;
 
     // Handles a block received from the network
     virtual void handle_block(const BlockType& block) = 0;
@@ -0,0 +1,58 @@
+#include "signature_cache.hpp"
+#include <algorithm>
+
+SignatureCache::SignatureCache(size_t capacity)
+    : shard_capacity_(std::max<size_t>(capacity / SHARDS, 1))
+{
+}
+
+void SignatureCache::insert(const Hash &transaction_hash)
+{
+  Shard &shard = shard_for(transaction_hash);
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  if (!shard.hashes.insert(transaction_hash).second)
+  {
+    return;
+  }
+  shard.order.push_back(transaction_hash);
+  if (shard.order.size() > shard_capacity_)
+  {
+    shard.hashes.erase(shard.order.front());
+    shard.order.pop_front();
+    ++shard.evictions;
+  }
+}
+
+bool SignatureCache::contains(const Hash &transaction_hash)
+{
+  Shard &shard = shard_for(transaction_hash);
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  return shard.hashes.contains(transaction_hash);
+}
+
+bool SignatureCache::lookup(const Hash &transaction_hash)
+{
+  bool found = contains(transaction_hash);
+  ++(found ? hits_ : misses_);
+  return found;
+}
+
+CacheStats SignatureCache::get_stats()
+{
+  CacheStats stats;
+  stats.hits = hits_;
+  stats.misses = misses_;
+  for (Shard &shard : shards_)
+  {
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    stats.evictions += shard.evictions;
+    stats.entries += shard.hashes.size();
+  }
+  return stats;
+}
+
+SignatureCache::Shard &SignatureCache::shard_for(const Hash &transaction_hash)
+{
+  // HashHasher reads the leading bytes; shard on a later one so both stay uniform
+  return shards_[transaction_hash[HASH_SIZE - 1] % SHARDS];
+}
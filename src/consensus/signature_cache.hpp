@@ -0,0 +1,55 @@
+#ifndef SIGNATURE_CACHE_HPP
+#define SIGNATURE_CACHE_HPP
+
+#include "../common/cache_stats.hpp"
+#include "../common/types.hpp"
+#include <array>
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <unordered_set>
+
+// Hashes of transactions whose signatures have already been verified, so
+// a transaction checked when it entered the pool is not checked again
+// when it arrives inside a block. A transaction's hash covers its sender,
+// its signed fields and its signature, so a hit stands for exactly the
+// check that was done, provided the caller has confirmed the hash matches
+// the transaction's fields. Bounded by capacity; once full, the oldest
+// entries make room. Split into shards with their own locks, so parallel
+// admission and block validation rarely wait on each other.
+class SignatureCache {
+public:
+    explicit SignatureCache(size_t capacity);
+
+    // Records that the transaction with this hash has a valid signature
+    void insert(const Hash& transaction_hash);
+
+    // Whether the transaction with this hash was verified
+    bool contains(const Hash& transaction_hash);
+
+    // contains(), counting a hit or a miss. Block validation looks up
+    // through this, so the stats say how much verification the cache saved
+    bool lookup(const Hash& transaction_hash);
+
+    // entries is the number of cached hashes; bytes is not tracked
+    CacheStats get_stats();
+
+private:
+    static constexpr size_t SHARDS = 16;
+
+    struct Shard {
+        std::mutex mutex;
+        std::unordered_set<Hash, HashHasher> hashes;
+        std::deque<Hash> order; // Oldest first
+        uint64_t evictions = 0;
+    };
+
+    Shard& shard_for(const Hash& transaction_hash);
+
+    size_t shard_capacity_;
+    std::array<Shard, SHARDS> shards_;
+    std::atomic<uint64_t> hits_{0};
+    std::atomic<uint64_t> misses_{0};
+};
+
+#endif // SIGNATURE_CACHE_HPP
@@ -12,10 +12,10 @@ TimeChainConsensus::TimeChainConsensus(
     const PrivateKey &private_key)
     : storage_(storage),
       network_manager_(network_manager),
-      private_key_(private_key),
+      signer_(private_key),
+      public_key_(signer_.get_public_key()),
       rng_(std::random_device{}())
 {
-  public_key_ = cryptography::derive_public_key(private_key_);
 }
 
 bool TimeChainConsensus::initialize()
@@ -95,11 +95,11 @@ bool TimeChainConsensus::is_eligible_to_produce_block()
   return eligible;
 }
 
-std::optional<TimeBlock> TimeChainConsensus::produce_block()
+bool TimeChainConsensus::produce_block(std::function<void(const TimeBlock &)> on_stored)
 {
   if (!is_eligible_to_produce_block())
   {
-    return std::nullopt;
+    return false;
   }
 
   // Get the latest block from storage
@@ -122,37 +122,42 @@ std::optional<TimeBlock> TimeChainConsensus::produce_block()
 
   // Sign the block
   bytes block_data = block.get_data_to_sign();
-  Signature signature = cryptography::sign_message(block_data, private_key_);
+  Signature signature = signer_.sign(block_data);
   block.set_signature(signature);
 
-  // Store the block
-  if (storage_->store_block(block))
-  {
-    utilities::log_info("Produced and stored new TimeBlock.");
-    return block;
-  }
-  else
-  {
-    utilities::log_error("Failed to store new TimeBlock.");
-    return std::nullopt;
-  }
+  // The block goes out through the writer's batched commits without
+  // waiting for them; it is only relayed once it is stored, and a failed
+  // write also drops it from the queue
+  storage_->store_block_async(block, [block, on_stored = std::move(on_stored)](bool stored)
+                              {
+    if (!stored)
+    {
+      utilities::log_error("Failed to store new TimeBlock.");
+      return;
+    }
+    utilities::log_info("Produced new TimeBlock.");
+    on_stored(block); });
+  return true;
 }
 
 void TimeChainConsensus::handle_block(const TimeBlock &block)
 {
   if (validate_block(block))
   {
-    // Store the block
-    if (storage_->store_block(block))
-    {
-      utilities::log_info("Received and stored new TimeBlock.");
-
-      // Additional actions, such as broadcasting the block to peers, can be added here
-    }
-    else
-    {
-      utilities::log_error("Failed to store received TimeBlock.");
-    }
+    // Acting on the block waits for its write, so a failed store is never
+    // relayed, but the caller moves on to the next block straight away
+    storage_->store_block_async(block, [](bool stored)
+                                {
+      if (stored)
+      {
+        utilities::log_info("Received and stored new TimeBlock.");
+
+        // Additional actions, such as broadcasting the block to peers, can be added here
+      }
+      else
+      {
+        utilities::log_error("Failed to store received TimeBlock.");
+      } });
   }
   else
   {
@@ -6,6 +6,7 @@
 #include "../storage/storage_interface.hpp"
 #include "../networking/network_manager.hpp"
 #include "../cryptography/cryptography.hpp"
+#include "../cryptography/signer.hpp"
 #include <memory>
 #include <random>
 
@@ -20,13 +21,13 @@ public:
   bool initialize() override;
   bool validate_block(const TimeBlock &block) override;
   bool is_eligible_to_produce_block() override;
-  std::optional<TimeBlock> produce_block() override;
+  bool produce_block(std::function<void(const TimeBlock &)> on_stored) override;
   void handle_block(const TimeBlock &block) override;
 
 private:
   std::shared_ptr<StorageInterface<TimeBlock>> storage_;
   std::shared_ptr<NetworkManager> network_manager_;
-  PrivateKey private_key_;
+  Signer signer_;
   PublicKey public_key_;
 
   // Random number generator for stochastic function
@@ -15,10 +15,11 @@ ValueChainConsensus::ValueChainConsensus(
     : storage_(storage),
       network_manager_(network_manager),
       time_chain_(time_chain),
-      private_key_(private_key),
-      rng_(std::random_device{}())
+      signer_(private_key),
+      public_key_(signer_.get_public_key()),
+      rng_(std::random_device{}()),
+      signature_cache_(SIGNATURE_CACHE_ENTRIES)
 {
-  public_key_ = cryptography::derive_public_key(private_key_);
 }
 
 bool ValueChainConsensus::initialize()
@@ -72,6 +73,14 @@ bool ValueChainConsensus::validate_block(const ValueBlock &block)
     return false;
   }
 
+  // The header's hash and signature do not cover the transactions; the
+  // Merkle root ties them to it
+  if (!verify_merkle_root(block))
+  {
+    utilities::log_error("Block transactions do not match its Merkle root.");
+    return false;
+  }
+
   // Verify transactions
   if (!verify_transactions(block))
   {
@@ -109,11 +118,11 @@ bool ValueChainConsensus::is_eligible_to_produce_block()
   return eligible;
 }
 
-std::optional<ValueBlock> ValueChainConsensus::produce_block()
+bool ValueChainConsensus::produce_block(std::function<void(const ValueBlock &)> on_stored)
 {
   if (!is_eligible_to_produce_block())
   {
-    return std::nullopt;
+    return false;
   }
 
   // Gather transactions to include in the block
@@ -122,7 +131,7 @@ std::optional<ValueBlock> ValueChainConsensus::produce_block()
   if (transactions.empty())
   {
     // No transactions to include, so we don't produce a block
-    return std::nullopt;
+    return false;
   }
 
   // Get the latest block from storage
@@ -147,49 +156,55 @@ std::optional<ValueBlock> ValueChainConsensus::produce_block()
   ValueBlock block(previous_hash, time_block_hash, current_time, transactions, public_key_);
 
   // Sign the block
-  bytes block_data = block.get_data_to_sign();
-  Signature signature = cryptography::sign_message(block_data, private_key_);
+  std::span<const byte> block_data = block.get_data_to_sign();
+  Signature signature = signer_.sign(block_data);
   block.set_signature(signature);
 
-  // Store the block
-  if (storage_->store_block(block))
-  {
-    utilities::log_info("Produced and stored new ValueBlock.");
-    return block;
-  }
-  else
-  {
-    utilities::log_error("Failed to store new ValueBlock.");
-    return std::nullopt;
-  }
+  // The block goes out through the writer's batched commits without
+  // waiting for them; it is only relayed once it is stored, and a failed
+  // write also drops it from the queue
+  storage_->store_block_async(block, [block, on_stored = std::move(on_stored)](bool stored)
+                              {
+    if (!stored)
+    {
+      utilities::log_error("Failed to store new ValueBlock.");
+      return;
+    }
+    utilities::log_info("Produced new ValueBlock.");
+    on_stored(block); });
+  return true;
 }
 
 void ValueChainConsensus::handle_block(const ValueBlock &block)
 {
   if (validate_block(block))
   {
-    // Store the block
-    if (storage_->store_block(block))
-    {
-      utilities::log_info("Received and stored new ValueBlock.");
-
-      // Remove transactions included in the block from the transaction pool
+    // Acting on the block waits for its write, so a failed store is never
+    // relayed or pruned from the pool, but the caller moves on to the next
+    // block straight away
+    storage_->store_block_async(block, [this, transactions = block.get_transactions()](bool stored)
+                                {
+      if (stored)
       {
-        std::lock_guard<std::mutex> lock(transaction_pool_mutex_);
-        for (const auto &tx : block.get_transactions())
+        utilities::log_info("Received and stored new ValueBlock.");
+
+        // Remove transactions included in the block from the transaction pool
         {
-          auto it = std::remove(transaction_pool_.begin(), transaction_pool_.end(), tx);
-          transaction_pool_.erase(it, transaction_pool_.end());
+          std::lock_guard<std::mutex> lock(transaction_pool_mutex_);
+          for (const auto &tx : transactions)
+          {
+            auto it = std::remove(transaction_pool_.begin(), transaction_pool_.end(), tx);
+            transaction_pool_.erase(it, transaction_pool_.end());
+          }
         }
-      }
 
-      // Optionally, broadcast the block to peers
-      // network_manager_->broadcast_data(block.serialize());
-    }
-    else
-    {
-      utilities::log_error("Failed to store received ValueBlock.");
-    }
+        // Optionally, broadcast the block to peers
+        // network_manager_->broadcast_data(block.serialize());
+      }
+      else
+      {
+        utilities::log_error("Failed to store received ValueBlock.");
+      } });
   }
   else
   {
@@ -197,11 +212,32 @@ void ValueChainConsensus::handle_block(const ValueBlock &block)
   }
 }
 
-void ValueChainConsensus::add_transaction(const Transaction &transaction)
+bool ValueChainConsensus::add_transaction(const Transaction &transaction)
 {
+  // The cache is keyed by hash, so the hash must be the transaction's own
+  if (!transaction.hash_matches())
+  {
+    utilities::log_error("Rejected transaction whose hash does not match its fields.");
+    return false;
+  }
+  if (!signature_cache_.contains(transaction.get_hash()))
+  {
+    if (!transaction.verify())
+    {
+      utilities::log_error("Rejected transaction with an invalid signature.");
+      return false;
+    }
+    signature_cache_.insert(transaction.get_hash());
+  }
   std::lock_guard<std::mutex> lock(transaction_pool_mutex_);
   transaction_pool_.push_back(transaction);
   utilities::log_info("Transaction added to the pool.");
+  return true;
+}
+
+CacheStats ValueChainConsensus::get_signature_cache_stats()
+{
+  return signature_cache_.get_stats();
 }
 
 std::vector<Transaction> ValueChainConsensus::gather_transactions()
@@ -244,8 +280,8 @@ std::vector<Transaction> ValueChainConsensus::gather_transactions()
   Transaction coinbase_transaction(coinbase_sender_public_key, recipient_public_key, amount, data);
 
   // Sign the transaction with the miner's private key
-  bytes tx_data_to_sign = coinbase_transaction.get_data_to_sign();
-  Signature signature = cryptography::sign_message(tx_data_to_sign, private_key_);
+  std::span<const byte> tx_data_to_sign = coinbase_transaction.get_data_to_sign();
+  Signature signature = signer_.sign(tx_data_to_sign);
   coinbase_transaction.set_signature(signature);
 
   // Insert the coinbase transaction at the beginning
@@ -278,22 +314,41 @@ bool ValueChainConsensus::verify_time_reference(const ValueBlock &block)
 
 bool ValueChainConsensus::verify_transactions(const ValueBlock &block)
 {
-  // Implement transaction verification logic
-  for (const auto &transaction : block.get_transactions())
+  // Transactions already verified at admission are skipped; the Merkle
+  // root check has confirmed their hashes. The rest are verified in
+  // parallel, stopping at the first bad one.
+  const std::vector<Transaction> &transactions = block.get_transactions();
+  std::vector<cryptography::SignatureCheck> checks = Transaction::signature_checks(
+      transactions, [this](const Transaction &transaction)
+      { return signature_cache_.lookup(transaction.get_hash()); });
+  if (auto invalid = cryptography::first_invalid_signature(checks))
   {
-    if (!transaction.verify())
+    utilities::log_error("Invalid transaction signature detected (unverified transaction " + std::to_string(*invalid) + ").");
+    return false;
+  }
+  size_t signed_transactions = 0;
+  for (const Transaction &transaction : transactions)
+  {
+    if (!transaction.is_coinbase_transaction())
     {
-      utilities::log_error("Invalid transaction detected.");
-      return false;
+      signature_cache_.insert(transaction.get_hash());
+      ++signed_transactions;
     }
-    // Additional checks, such as double-spending prevention, can be added here
   }
+  utilities::log_info("Verified " + std::to_string(checks.size()) + " of " + std::to_string(signed_transactions) +
+                      " transaction signature(s); the rest were verified before.");
+  // Additional checks, such as double-spending prevention, can be added here
   return true;
 }
 
+bool ValueChainConsensus::verify_merkle_root(const ValueBlock &block)
+{
+  return block.transactions_match_root();
+}
+
 bool ValueChainConsensus::verify_signature(const ValueBlock &block)
 {
-  bytes data_to_verify = block.get_data_to_sign();
+  std::span<const byte> data_to_verify = block.get_data_to_sign();
   const Signature &signature = block.get_signature();
   const PublicKey &block_public_key = block.get_public_key();
 
@@ -7,6 +7,8 @@
 #include "../storage/storage_interface.hpp"
 #include "../networking/network_manager.hpp"
 #include "../cryptography/cryptography.hpp"
+#include "../cryptography/signer.hpp"
+#include "signature_cache.hpp"
 #include "../time_chain/time_chain.hpp"
 #include <memory>
 #include <random>
@@ -25,17 +27,20 @@ public:
   bool initialize() override;
   bool validate_block(const ValueBlock &block) override;
   bool is_eligible_to_produce_block() override;
-  std::optional<ValueBlock> produce_block() override;
+  bool produce_block(std::function<void(const ValueBlock &)> on_stored) override;
   void handle_block(const ValueBlock &block) override;
 
-  // Method to add a transaction to the transaction pool
-  void add_transaction(const Transaction &transaction);
+  // Adds a transaction to the transaction pool if its signature verifies
+  bool add_transaction(const Transaction &transaction);
+
+  // Hits are transaction signatures that did not need verifying again
+  CacheStats get_signature_cache_stats();
 
 private:
   std::shared_ptr<StorageInterface<ValueBlock>> storage_;
   std::shared_ptr<NetworkManager> network_manager_;
   std::shared_ptr<TimeChain> time_chain_;
-  PrivateKey private_key_;
+  Signer signer_;
   PublicKey public_key_;
 
   // Random number generator for stochastic function
@@ -45,9 +50,15 @@ private:
   std::mutex transaction_pool_mutex_;
   std::vector<Transaction> transaction_pool_;
 
+  // Transactions whose signatures were verified at admission or in an
+  // earlier block
+  static constexpr size_t SIGNATURE_CACHE_ENTRIES = 1 << 16;
+  SignatureCache signature_cache_;
+
   // Helper methods
   bool verify_time_reference(const ValueBlock &block);
   bool verify_transactions(const ValueBlock &block);
+  bool verify_merkle_root(const ValueBlock &block);
   std::vector<Transaction> gather_transactions();
   bool verify_signature(const ValueBlock &block);
   uint64_t get_current_time();
@@ -1,6 +1,7 @@
 #include "cryptography.hpp"
 #include "schnorr_signature.hpp"
-#include "utilities.hpp"
+#include "sha256_hasher.hpp"
+#include "hex.hpp"
 
 #include <openssl/evp.h>
 #include <openssl/rand.h>
@@ -8,24 +9,17 @@
 namespace cryptography
 {
 
-  Hash sha256(const bytes &data)
+  Hash sha256(std::span<const byte> data)
   {
-    Hash hash;
-    EVP_MD_CTX *ctx = EVP_MD_CTX_new();
-    const EVP_MD *md = EVP_sha256();
-
-    EVP_DigestInit_ex(ctx, md, nullptr);
-    EVP_DigestUpdate(ctx, data.data(), data.size());
-    EVP_DigestFinal_ex(ctx, hash.data(), nullptr);
-
-    EVP_MD_CTX_free(ctx);
-    return hash;
+    // One context per thread, reused for every hash the thread computes
+    thread_local Sha256Hasher hasher;
+    return hasher.update(data).finalize();
   }
 
-  Hash double_sha256(const bytes &data)
+  Hash double_sha256(std::span<const byte> data)
   {
     Hash first_hash = sha256(data);
-    return sha256(bytes(first_hash.begin(), first_hash.end()));
+    return sha256(first_hash);
   }
 
   PrivateKey generate_private_key()
@@ -43,7 +37,7 @@ namespace cryptography
   std::string public_key_to_address(const PublicKey &public_key)
   {
     // Perform SHA256 hash
-    Hash sha_hash = sha256(bytes(public_key.begin(), public_key.end()));
+    Hash sha_hash = sha256(public_key);
 
     // Perform RIPEMD160 hash using EVP
     EVP_MD_CTX *ctx = EVP_MD_CTX_new();
@@ -58,20 +52,16 @@ namespace cryptography
 
     EVP_MD_CTX_free(ctx);
 
-    // Convert to bytes
-    bytes ripemd_bytes(ripemd_hash, ripemd_hash + ripemd_length);
-
     // For simplicity, encode the RIPEMD160 hash in hexadecimal
-    std::string address = utilities::bytes_to_hex(ripemd_bytes);
-    return address;
+    return hex::encode(std::span<const byte>(ripemd_hash, ripemd_length));
   }
 
-  Signature sign_message(const bytes &message, const PrivateKey &private_key)
+  Signature sign_message(std::span<const byte> message, const PrivateKey &private_key)
   {
     return SchnorrSignature::sign(message, private_key);
   }
 
-  bool verify_signature(const bytes &message, const Signature &signature, const PublicKey &public_key)
+  bool verify_signature(std::span<const byte> message, const Signature &signature, const PublicKey &public_key)
   {
     return SchnorrSignature::verify(message, signature, public_key);
   }
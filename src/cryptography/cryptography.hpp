@@ -2,13 +2,14 @@
 #define CRYPTOGRAPHY_HPP
 
 #include "types.hpp"
+#include <span>
 #include <string>
 
 namespace cryptography {
 
 // Hashing functions
-Hash sha256(const bytes& data);
-Hash double_sha256(const bytes& data);
+Hash sha256(std::span<const byte> data);
+Hash double_sha256(std::span<const byte> data);
 
 // Key generation
 PrivateKey generate_private_key();
@@ -18,8 +19,8 @@ PublicKey derive_public_key(const PrivateKey& private_key);
 std::string public_key_to_address(const PublicKey& public_key);
 
 // Other cryptographic utilities
-bool verify_signature(const bytes& message, const Signature& signature, const PublicKey& public_key);
-Signature sign_message(const bytes& message, const PrivateKey& private_key);
+bool verify_signature(std::span<const byte> message, const Signature& signature, const PublicKey& public_key);
+Signature sign_message(std::span<const byte> message, const PrivateKey& private_key);
 
 } // namespace cryptography
 
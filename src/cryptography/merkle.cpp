@@ -0,0 +1,224 @@
+#include "merkle.hpp"
+#include "cryptography.hpp"
+#include "serialization.hpp"
+#include "sha256_hasher.hpp"
+#include "thread_pool.hpp"
+#include "utilities.hpp"
+#include <algorithm>
+
+namespace cryptography
+{
+
+  namespace
+  {
+    // Pairs below this are cheaper to hash than to hand to other threads
+    constexpr size_t PARALLEL_PAIRS = 1024;
+
+    // Prefixes that keep leaf and inner node preimages apart
+    constexpr byte LEAF_PREFIX = 0x00;
+    constexpr byte NODE_PREFIX = 0x01;
+
+    // The bottom level of the tree: every leaf hashed under the leaf prefix
+    std::vector<Hash> leaf_level(std::span<const Hash> leaves)
+    {
+      std::vector<Hash> nodes(leaves.size());
+      auto hash_leaves = [&](size_t begin, size_t end)
+      {
+        for (size_t i = begin; i < end; ++i)
+        {
+          nodes[i] = merkle_leaf(leaves[i]);
+        }
+      };
+      if (leaves.size() >= PARALLEL_PAIRS)
+      {
+        ThreadPool::shared().parallel_for(leaves.size(), PARALLEL_PAIRS / 4, hash_leaves);
+      }
+      else
+      {
+        hash_leaves(0, leaves.size());
+      }
+      return nodes;
+    }
+
+    // The level above level; an unpaired last node moves up unchanged
+    std::vector<Hash> next_level(const std::vector<Hash> &level)
+    {
+      size_t pairs = level.size() / 2;
+      std::vector<Hash> parents(pairs);
+      auto hash_pairs = [&](size_t begin, size_t end)
+      {
+        for (size_t i = begin; i < end; ++i)
+        {
+          parents[i] = merkle_parent(level[2 * i], level[2 * i + 1]);
+        }
+      };
+      if (pairs >= PARALLEL_PAIRS)
+      {
+        ThreadPool::shared().parallel_for(pairs, PARALLEL_PAIRS / 4, hash_pairs);
+      }
+      else
+      {
+        hash_pairs(0, pairs);
+      }
+      if (level.size() % 2 == 1)
+      {
+        parents.push_back(level.back());
+      }
+      return parents;
+    }
+  }
+
+  Hash merkle_leaf(const Hash &leaf)
+  {
+    thread_local Sha256Hasher hasher;
+    return hasher.update(std::span(&LEAF_PREFIX, 1)).update(leaf).finalize();
+  }
+
+  Hash merkle_parent(const Hash &left, const Hash &right)
+  {
+    thread_local Sha256Hasher hasher;
+    return hasher.update(std::span(&NODE_PREFIX, 1)).update(left).update(right).finalize();
+  }
+
+  Hash merkle_root(std::span<const Hash> leaves)
+  {
+    if (leaves.empty())
+    {
+      return Hash{};
+    }
+    std::vector<Hash> level = leaf_level(leaves);
+    while (level.size() > 1)
+    {
+      level = next_level(level);
+    }
+    return level.front();
+  }
+
+  std::optional<size_t> MerkleProof::path_length(uint64_t index, uint64_t leaf_count)
+  {
+    if (index >= leaf_count)
+    {
+      return std::nullopt;
+    }
+    size_t length = 0;
+    for (uint64_t width = leaf_count; width > 1; width = (width + 1) / 2, index /= 2)
+    {
+      // Only the last node of an odd level has no sibling
+      if (index % 2 == 1 || index + 1 < width)
+      {
+        ++length;
+      }
+    }
+    return length;
+  }
+
+  Hash MerkleProof::root_from(const Hash &leaf) const
+  {
+    Hash node = merkle_leaf(leaf);
+    auto sibling = siblings.begin();
+    uint64_t position = index;
+    for (uint64_t width = leaf_count; width > 1 && sibling != siblings.end(); width = (width + 1) / 2, position /= 2)
+    {
+      if (position % 2 == 1)
+      {
+        node = merkle_parent(*sibling++, node);
+      }
+      else if (position + 1 < width)
+      {
+        node = merkle_parent(node, *sibling++);
+      }
+    }
+    return node;
+  }
+
+  bool MerkleProof::verify(const Hash &leaf, const Hash &root) const
+  {
+    return path_length(index, leaf_count) == siblings.size() && root_from(leaf) == root;
+  }
+
+  size_t MerkleProof::serialized_size() const
+  {
+    return 2 * sizeof(uint64_t) + siblings.size() * HASH_SIZE;
+  }
+
+  bytes MerkleProof::serialize() const
+  {
+    bytes data(serialized_size());
+    byte *out = serialization::write_value(data.data(), index);
+    out = serialization::write_value(out, leaf_count);
+    for (const Hash &sibling : siblings)
+    {
+      out = serialization::write_bytes(out, sibling);
+    }
+    return data;
+  }
+
+  bool MerkleProof::deserialize(std::span<const byte> data)
+  {
+    if (data.size() < 2 * sizeof(uint64_t))
+    {
+      utilities::log_error("MerkleProof too short: " + std::to_string(data.size()) + " bytes.");
+      return false;
+    }
+    uint64_t read_index = 0;
+    uint64_t read_leaf_count = 0;
+    serialization::read_value(data.data(), read_index);
+    serialization::read_value(data.data() + sizeof(uint64_t), read_leaf_count);
+    auto length = path_length(read_index, read_leaf_count);
+    if (!length || data.size() != 2 * sizeof(uint64_t) + *length * HASH_SIZE)
+    {
+      utilities::log_error("MerkleProof for leaf " + std::to_string(read_index) + " of " +
+                           std::to_string(read_leaf_count) + " has the wrong size: " + std::to_string(data.size()) + " bytes.");
+      return false;
+    }
+    index = read_index;
+    leaf_count = read_leaf_count;
+    siblings.resize(*length);
+    for (size_t i = 0; i < siblings.size(); ++i)
+    {
+      std::copy_n(data.begin() + 2 * sizeof(uint64_t) + i * HASH_SIZE, HASH_SIZE, siblings[i].begin());
+    }
+    return true;
+  }
+
+  MerkleTree::MerkleTree(std::span<const Hash> leaves)
+  {
+    levels_.push_back(leaf_level(leaves));
+    while (levels_.back().size() > 1)
+    {
+      levels_.push_back(next_level(levels_.back()));
+    }
+    root_ = levels_.back().empty() ? Hash{} : levels_.back().front();
+  }
+
+  const Hash &MerkleTree::root() const
+  {
+    return root_;
+  }
+
+  size_t MerkleTree::leaf_count() const
+  {
+    return levels_.front().size();
+  }
+
+  MerkleProof MerkleTree::prove(size_t index) const
+  {
+    MerkleProof proof;
+    proof.index = index;
+    proof.leaf_count = leaf_count();
+    for (size_t level = 0; level + 1 < levels_.size(); ++level, index /= 2)
+    {
+      const std::vector<Hash> &nodes = levels_[level];
+      if (index % 2 == 1)
+      {
+        proof.siblings.push_back(nodes[index - 1]);
+      }
+      else if (index + 1 < nodes.size())
+      {
+        proof.siblings.push_back(nodes[index + 1]);
+      }
+    }
+    return proof;
+  }
+
+} // namespace cryptography
@@ -0,0 +1,70 @@
+#ifndef MERKLE_HPP
+#define MERKLE_HPP
+
+#include "types.hpp"
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace cryptography {
+
+// Root of a binary Merkle tree over leaf hashes. Each leaf enters the tree
+// as the SHA-256 of a 0x00 byte and the leaf, and each parent is the
+// SHA-256 of a 0x01 byte and its two children, so an inner node can never
+// pass for a leaf. A node left without a sibling at the end of a level
+// moves up unchanged rather than being paired with itself. Short of a
+// SHA-256 collision, no two leaf lists share a root. The root of no leaves
+// is all zeros. Large levels are hashed on the shared thread pool.
+Hash merkle_root(std::span<const Hash> leaves);
+
+// Bottom-level node of a leaf
+Hash merkle_leaf(const Hash& leaf);
+
+// Parent of two adjacent nodes
+Hash merkle_parent(const Hash& left, const Hash& right);
+
+// Path from one leaf to the root: the sibling at every level where the
+// node has one, bottom up. The leaf's position and the tree's width say
+// which side each sibling is on and which levels have none.
+struct MerkleProof {
+    uint64_t index = 0;
+    uint64_t leaf_count = 0;
+    std::vector<Hash> siblings;
+
+    // Number of siblings on the path from index in a tree of leaf_count
+    // leaves, or nothing if index is not a leaf of such a tree
+    static std::optional<size_t> path_length(uint64_t index, uint64_t leaf_count);
+
+    // Root the path leads to from leaf
+    Hash root_from(const Hash& leaf) const;
+
+    // Whether leaf sits at index in the tree with this root
+    bool verify(const Hash& leaf, const Hash& root) const;
+
+    // [index][leaf count][siblings...], integers little-endian
+    size_t serialized_size() const;
+    bytes serialize() const;
+    // Rejects proofs whose sibling count does not fit their position
+    bool deserialize(std::span<const byte> data);
+};
+
+// A Merkle tree that keeps every level, so proofs for any of its leaves
+// are read off without hashing. Has the same root as merkle_root().
+class MerkleTree {
+public:
+    explicit MerkleTree(std::span<const Hash> leaves);
+
+    const Hash& root() const;
+    size_t leaf_count() const;
+
+    // Proof for the leaf at index, which must be below leaf_count()
+    MerkleProof prove(size_t index) const;
+
+private:
+    std::vector<std::vector<Hash>> levels_; // Leaf nodes first, root last
+    Hash root_;
+};
+
+} // namespace cryptography
+
+#endif // MERKLE_HPP
@@ -1,68 +1,129 @@
 #include "schnorr_signature.hpp"
 #include "cryptography.hpp"
+#include "signer.hpp"
 #include <secp256k1.h>
 #include <secp256k1_schnorrsig.h>
+#include <array>
+#include <deque>
+#include <mutex>
 #include <stdexcept>
+#include <unordered_map>
 
-Signature SchnorrSignature::sign(const bytes &message, const PrivateKey &private_key)
-{
-    Signature signature;
-    Hash hash = cryptography::sha256(message);
-
-    secp256k1_keypair keypair;
-    if (!secp256k1_keypair_create(get_context(), &keypair, private_key.data()))
-    {
-        throw std::runtime_error("Failed to create keypair for signing");
-    }
+#include <openssl/rand.h>
 
-    if (!secp256k1_schnorrsig_sign(get_context(), signature.data(), hash.data(), &keypair, nullptr))
+namespace
+{
+    // Parsed forms of recently seen x-only keys. Parsing decompresses the
+    // point, a field square root, which a sender who signs many
+    // transactions would otherwise pay for on every verification. Sharded
+    // so parallel verification rarely waits on another thread; each shard
+    // forgets its oldest key once full.
+    class PublicKeyCache
     {
-        throw std::runtime_error("Failed to sign message");
-    }
+    public:
+        bool parse(const secp256k1_context *context, const PublicKey &public_key, secp256k1_xonly_pubkey &parsed)
+        {
+            Shard &shard = shards_[public_key[PUBLIC_KEY_SIZE - 1] % SHARDS];
+            {
+                std::lock_guard<std::mutex> lock(shard.mutex);
+                auto it = shard.keys.find(public_key);
+                if (it != shard.keys.end())
+                {
+                    parsed = it->second;
+                    return true;
+                }
+            }
+            if (!secp256k1_xonly_pubkey_parse(context, &parsed, public_key.data()))
+            {
+                return false;
+            }
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            if (shard.keys.emplace(public_key, parsed).second)
+            {
+                shard.order.push_back(public_key);
+                if (shard.order.size() > KEYS_PER_SHARD)
+                {
+                    shard.keys.erase(shard.order.front());
+                    shard.order.pop_front();
+                }
+            }
+            return true;
+        }
 
-    return signature;
-}
+    private:
+        static constexpr size_t SHARDS = 16;
+        static constexpr size_t KEYS_PER_SHARD = 1024;
 
-PublicKey SchnorrSignature::derive_public_key(const PrivateKey &private_key)
-{
-    PublicKey public_key;
+        struct Shard
+        {
+            std::mutex mutex;
+            // Keys are curve coordinates, as evenly spread as hashes
+            std::unordered_map<PublicKey, secp256k1_xonly_pubkey, HashHasher> keys;
+            std::deque<PublicKey> order;
+        };
 
-    secp256k1_keypair keypair;
-    if (!secp256k1_keypair_create(get_context(), &keypair, private_key.data()))
-    {
-        throw std::runtime_error("Failed to create keypair for public key derivation");
-    }
+        std::array<Shard, SHARDS> shards_;
+    };
 
-    secp256k1_xonly_pubkey xonly_pubkey;
-    if (!secp256k1_keypair_xonly_pub(get_context(), &xonly_pubkey, nullptr, &keypair))
+    PublicKeyCache &public_key_cache()
     {
-        throw std::runtime_error("Failed to extract x-only public key");
+        static PublicKeyCache cache;
+        return cache;
     }
+}
 
-    if (!secp256k1_xonly_pubkey_serialize(get_context(), public_key.data(), &xonly_pubkey))
-    {
-        throw std::runtime_error("Failed to serialize public key");
-    }
+Signature SchnorrSignature::sign(std::span<const byte> message, const PrivateKey &private_key)
+{
+    // One-off; callers signing repeatedly with one key keep a Signer
+    return Signer(private_key).sign(message);
+}
 
-    return public_key;
+PublicKey SchnorrSignature::derive_public_key(const PrivateKey &private_key)
+{
+    return Signer(private_key).get_public_key();
 }
 
-bool SchnorrSignature::verify(const bytes &message, const Signature &signature, const PublicKey &public_key)
+bool SchnorrSignature::verify(std::span<const byte> message, const Signature &signature, const PublicKey &public_key)
 {
-    Hash hash = cryptography::sha256(message);
+    return verify_hash(cryptography::sha256(message), signature, public_key);
+}
 
+bool SchnorrSignature::verify_hash(const Hash &message_hash, const Signature &signature, const PublicKey &public_key)
+{
     secp256k1_xonly_pubkey pubkey;
-    if (!secp256k1_xonly_pubkey_parse(get_context(), &pubkey, public_key.data()))
+    if (!public_key_cache().parse(get_context(), public_key, pubkey))
     {
         return false;
     }
 
-    int result = secp256k1_schnorrsig_verify(get_context(), signature.data(), hash.data(), 32, &pubkey);
+    int result = secp256k1_schnorrsig_verify(get_context(), signature.data(), message_hash.data(), HASH_SIZE, &pubkey);
     return result == 1;
 }
 
 secp256k1_context *SchnorrSignature::get_context()
 {
-    static secp256k1_context *context = secp256k1_context_create(SECP256K1_CONTEXT_SIGN | SECP256K1_CONTEXT_VERIFY);
-    return context;
+    // Threads never share a context, and each is randomized with its own
+    // seed to blind signing against side channels
+    struct ThreadContext
+    {
+        secp256k1_context *context;
+
+        ThreadContext()
+        {
+            static const secp256k1_context *base = secp256k1_context_create(SECP256K1_CONTEXT_SIGN | SECP256K1_CONTEXT_VERIFY);
+            context = secp256k1_context_clone(base);
+            unsigned char seed[32];
+            if (RAND_bytes(seed, sizeof(seed)) == 1)
+            {
+                secp256k1_context_randomize(context, seed);
+            }
+        }
+
+        ~ThreadContext()
+        {
+            secp256k1_context_destroy(context);
+        }
+    };
+    thread_local ThreadContext thread_context;
+    return thread_context.context;
 }
@@ -2,6 +2,7 @@
 #define SCHNORR_SIGNATURE_HPP
 
 #include "types.hpp"
+#include <span>
 #include <secp256k1.h>
 #include <secp256k1_schnorrsig.h>
 
@@ -12,12 +13,18 @@ public:
     static PublicKey derive_public_key(const PrivateKey &private_key);
 
     // Signs a message using the private key
-    static Signature sign(const bytes &message, const PrivateKey &private_key);
+    static Signature sign(std::span<const byte> message, const PrivateKey &private_key);
 
     // Verifies a signature given the message and public key
-    static bool verify(const bytes &message, const Signature &signature, const PublicKey &public_key);
+    static bool verify(std::span<const byte> message, const Signature &signature, const PublicKey &public_key);
+
+    // Verifies a signature given the SHA-256 of the message, which is what sign() signs
+    static bool verify_hash(const Hash &message_hash, const Signature &signature, const PublicKey &public_key);
 
 private:
+    friend class Signer;
+
+    // The calling thread's context, cloned from a shared one and randomized
     static secp256k1_context *get_context();
 };
 
@@ -0,0 +1,407 @@
+#include "sha256_batch.hpp"
+#include "cryptography.hpp"
+#include <array>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#include <immintrin.h>
+#define SHA256_BATCH_X86 1
+#endif
+
+namespace cryptography
+{
+
+  namespace
+  {
+    constexpr size_t BLOCK_SIZE = 64;
+
+    constexpr std::array<uint32_t, 8> INITIAL_STATE = {0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+                                                       0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19};
+
+    alignas(16) constexpr uint32_t ROUND_CONSTANTS[64] = {
+        0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+        0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+        0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+        0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+        0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+        0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+        0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+        0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2};
+
+    using Implementation = Sha256ManyImplementation;
+
+    // Writes the one or two blocks that end message into blocks: its last
+    // partial block, the 0x80 terminator, zeros, and the message length in
+    // bits, big-endian. Returns how many blocks that took.
+    size_t pad_tail(std::span<const byte> message, byte *blocks)
+    {
+      size_t partial = message.size() % BLOCK_SIZE;
+      std::memset(blocks, 0, 2 * BLOCK_SIZE);
+      if (partial > 0)
+      {
+        std::memcpy(blocks, message.data() + message.size() - partial, partial);
+      }
+      blocks[partial] = 0x80;
+      size_t count = partial + 1 + sizeof(uint64_t) <= BLOCK_SIZE ? 1 : 2;
+      uint64_t bits = static_cast<uint64_t>(message.size()) * 8;
+      for (size_t i = 0; i < sizeof(uint64_t); ++i)
+      {
+        blocks[count * BLOCK_SIZE - 1 - i] = static_cast<byte>(bits >> (8 * i));
+      }
+      return count;
+    }
+
+    void write_word(byte *out, uint32_t word)
+    {
+      out[0] = static_cast<byte>(word >> 24);
+      out[1] = static_cast<byte>(word >> 16);
+      out[2] = static_cast<byte>(word >> 8);
+      out[3] = static_cast<byte>(word);
+    }
+
+#if defined(SHA256_BATCH_X86)
+
+    // The SIMD paths are compiled for their instruction sets regardless of
+    // the build flags and only called once the CPU reported support.
+
+    // Runs count blocks through the SHA extensions, one message at a time.
+    // state holds the eight working words in their usual order.
+    __attribute__((target("sha,sse4.1"))) void compress_sha(uint32_t *state, const byte *blocks, size_t count)
+    {
+      const __m128i byte_swap = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+
+      // The round instructions take the state as ABEF and CDGH
+      __m128i dcba = _mm_loadu_si128(reinterpret_cast<const __m128i *>(state));
+      __m128i hgfe = _mm_loadu_si128(reinterpret_cast<const __m128i *>(state + 4));
+      __m128i cdab = _mm_shuffle_epi32(dcba, 0xB1);
+      __m128i efgh = _mm_shuffle_epi32(hgfe, 0x1B);
+      __m128i abef = _mm_alignr_epi8(cdab, efgh, 8);
+      __m128i cdgh = _mm_blend_epi16(efgh, cdab, 0xF0);
+
+      for (; count > 0; --count, blocks += BLOCK_SIZE)
+      {
+        __m128i abef_start = abef;
+        __m128i cdgh_start = cdgh;
+        __m128i schedule[4];
+        for (int i = 0; i < 4; ++i)
+        {
+          schedule[i] = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(blocks + 16 * i)), byte_swap);
+        }
+
+        // Four rounds per group; the message schedule for later groups is
+        // extended alongside, four words at a time
+#pragma GCC unroll 16
+        for (int group = 0; group < 16; ++group)
+        {
+          __m128i &current = schedule[group % 4];
+          __m128i words = _mm_add_epi32(current, _mm_load_si128(reinterpret_cast<const __m128i *>(ROUND_CONSTANTS + 4 * group)));
+          cdgh = _mm_sha256rnds2_epu32(cdgh, abef, words);
+          if (group >= 3 && group < 15)
+          {
+            __m128i &next = schedule[(group + 1) % 4];
+            next = _mm_add_epi32(next, _mm_alignr_epi8(current, schedule[(group + 3) % 4], 4));
+            next = _mm_sha256msg2_epu32(next, current);
+          }
+          abef = _mm_sha256rnds2_epu32(abef, cdgh, _mm_shuffle_epi32(words, 0x0E));
+          if (group >= 1 && group < 13)
+          {
+            __m128i &previous = schedule[(group + 3) % 4];
+            previous = _mm_sha256msg1_epu32(previous, current);
+          }
+        }
+
+        abef = _mm_add_epi32(abef, abef_start);
+        cdgh = _mm_add_epi32(cdgh, cdgh_start);
+      }
+
+      __m128i feba = _mm_shuffle_epi32(abef, 0x1B);
+      __m128i dchg = _mm_shuffle_epi32(cdgh, 0xB1);
+      _mm_storeu_si128(reinterpret_cast<__m128i *>(state), _mm_blend_epi16(feba, dchg, 0xF0));
+      _mm_storeu_si128(reinterpret_cast<__m128i *>(state + 4), _mm_alignr_epi8(dchg, feba, 8));
+    }
+
+    __attribute__((target("sha,sse4.1"))) void sha256_many_sha(std::span<const std::span<const byte>> messages,
+                                                              std::span<Hash> hashes)
+    {
+      alignas(16) byte tail[2 * BLOCK_SIZE];
+      for (size_t i = 0; i < messages.size(); ++i)
+      {
+        std::span<const byte> message = messages[i];
+        std::array<uint32_t, 8> state = INITIAL_STATE;
+        compress_sha(state.data(), message.data(), message.size() / BLOCK_SIZE);
+        compress_sha(state.data(), tail, pad_tail(message, tail));
+        for (size_t word = 0; word < state.size(); ++word)
+        {
+          write_word(hashes[i].data() + 4 * word, state[word]);
+        }
+      }
+    }
+
+    constexpr size_t LANES = 8;
+
+    // Working words of eight messages: state[word][lane]
+    using LaneState = std::array<std::array<uint32_t, LANES>, 8>;
+
+    __attribute__((target("avx2"))) inline __m256i rotate_right(__m256i x, int bits)
+    {
+      return _mm256_or_si256(_mm256_srli_epi32(x, bits), _mm256_slli_epi32(x, 32 - bits));
+    }
+
+    // Runs one block of each of eight messages through the compression
+    // function, each in its own 32-bit lane
+    __attribute__((target("avx2"))) void compress_avx2(LaneState &state, const byte *const *blocks)
+    {
+      const __m256i byte_swap = _mm256_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+                                                 3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+
+      // Transpose each half block so that vector t holds word t of every lane
+      __m256i w[16];
+      for (size_t half = 0; half < 2; ++half)
+      {
+        __m256i rows[LANES];
+        for (size_t lane = 0; lane < LANES; ++lane)
+        {
+          rows[lane] = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(blocks[lane] + 32 * half));
+        }
+        __m256i pairs[LANES];
+        for (size_t i = 0; i < LANES; i += 2)
+        {
+          pairs[i] = _mm256_unpacklo_epi32(rows[i], rows[i + 1]);
+          pairs[i + 1] = _mm256_unpackhi_epi32(rows[i], rows[i + 1]);
+        }
+        __m256i quads[LANES];
+        for (size_t i = 0; i < LANES; i += 4)
+        {
+          quads[i] = _mm256_unpacklo_epi64(pairs[i], pairs[i + 2]);
+          quads[i + 1] = _mm256_unpackhi_epi64(pairs[i], pairs[i + 2]);
+          quads[i + 2] = _mm256_unpacklo_epi64(pairs[i + 1], pairs[i + 3]);
+          quads[i + 3] = _mm256_unpackhi_epi64(pairs[i + 1], pairs[i + 3]);
+        }
+        for (size_t i = 0; i < 4; ++i)
+        {
+          w[8 * half + i] = _mm256_shuffle_epi8(_mm256_permute2x128_si256(quads[i], quads[i + 4], 0x20), byte_swap);
+          w[8 * half + i + 4] = _mm256_shuffle_epi8(_mm256_permute2x128_si256(quads[i], quads[i + 4], 0x31), byte_swap);
+        }
+      }
+
+      __m256i v[8];
+      for (size_t i = 0; i < 8; ++i)
+      {
+        v[i] = _mm256_load_si256(reinterpret_cast<const __m256i *>(state[i].data()));
+      }
+      __m256i a = v[0], b = v[1], c = v[2], d = v[3], e = v[4], f = v[5], g = v[6], h = v[7];
+
+#pragma GCC unroll 64
+      for (int t = 0; t < 64; ++t)
+      {
+        if (t >= 16)
+        {
+          __m256i w2 = w[(t - 2) % 16];
+          __m256i w15 = w[(t - 15) % 16];
+          __m256i sigma1 = _mm256_xor_si256(_mm256_xor_si256(rotate_right(w2, 17), rotate_right(w2, 19)),
+                                            _mm256_srli_epi32(w2, 10));
+          __m256i sigma0 = _mm256_xor_si256(_mm256_xor_si256(rotate_right(w15, 7), rotate_right(w15, 18)),
+                                            _mm256_srli_epi32(w15, 3));
+          w[t % 16] = _mm256_add_epi32(_mm256_add_epi32(w[t % 16], sigma0),
+                                       _mm256_add_epi32(w[(t - 7) % 16], sigma1));
+        }
+        __m256i big_sigma1 = _mm256_xor_si256(_mm256_xor_si256(rotate_right(e, 6), rotate_right(e, 11)),
+                                              rotate_right(e, 25));
+        __m256i choose = _mm256_xor_si256(_mm256_and_si256(e, f), _mm256_andnot_si256(e, g));
+        __m256i t1 = _mm256_add_epi32(_mm256_add_epi32(h, big_sigma1),
+                                      _mm256_add_epi32(_mm256_add_epi32(choose, w[t % 16]),
+                                                       _mm256_set1_epi32(static_cast<int>(ROUND_CONSTANTS[t]))));
+        __m256i big_sigma0 = _mm256_xor_si256(_mm256_xor_si256(rotate_right(a, 2), rotate_right(a, 13)),
+                                              rotate_right(a, 22));
+        __m256i majority = _mm256_or_si256(_mm256_and_si256(a, b), _mm256_and_si256(c, _mm256_or_si256(a, b)));
+        __m256i t2 = _mm256_add_epi32(big_sigma0, majority);
+        h = g;
+        g = f;
+        f = e;
+        e = _mm256_add_epi32(d, t1);
+        d = c;
+        c = b;
+        b = a;
+        a = _mm256_add_epi32(t1, t2);
+      }
+
+      __m256i result[8] = {a, b, c, d, e, f, g, h};
+      for (size_t i = 0; i < 8; ++i)
+      {
+        _mm256_store_si256(reinterpret_cast<__m256i *>(state[i].data()), _mm256_add_epi32(v[i], result[i]));
+      }
+    }
+
+    // A message being hashed in one of the eight lanes
+    struct Lane
+    {
+      static constexpr size_t IDLE = SIZE_MAX;
+
+      size_t message = IDLE;
+      const byte *next_block = nullptr;
+      size_t full_blocks = 0;
+      size_t tail_blocks = 0;
+      size_t tail_used = 0;
+      alignas(32) byte tail[2 * BLOCK_SIZE];
+    };
+
+    // Keeps all eight lanes busy: a lane that finishes its message starts
+    // on the next one, so messages of different lengths share the work.
+    // Lanes left without a message at the end hash a dummy block.
+    __attribute__((target("avx2"))) void sha256_many_avx2(std::span<const std::span<const byte>> messages,
+                                                          std::span<Hash> hashes)
+    {
+      if (messages.size() < LANES / 2)
+      {
+        // Too few to fill the lanes
+        sha256_many_portable(messages, hashes);
+        return;
+      }
+
+      alignas(32) static constexpr byte IDLE_BLOCK[BLOCK_SIZE] = {};
+      alignas(32) LaneState state;
+      std::array<Lane, LANES> lanes;
+      size_t next_message = 0;
+      size_t active = 0;
+
+      auto start = [&](size_t index)
+      {
+        Lane &lane = lanes[index];
+        if (next_message == messages.size())
+        {
+          lane.message = Lane::IDLE;
+          return false;
+        }
+        lane.message = next_message++;
+        std::span<const byte> message = messages[lane.message];
+        lane.next_block = message.data();
+        lane.full_blocks = message.size() / BLOCK_SIZE;
+        lane.tail_blocks = pad_tail(message, lane.tail);
+        lane.tail_used = 0;
+        for (size_t word = 0; word < 8; ++word)
+        {
+          state[word][index] = INITIAL_STATE[word];
+        }
+        return true;
+      };
+
+      for (size_t index = 0; index < LANES; ++index)
+      {
+        active += start(index);
+      }
+      while (active > 0)
+      {
+        const byte *blocks[LANES];
+        for (size_t index = 0; index < LANES; ++index)
+        {
+          Lane &lane = lanes[index];
+          if (lane.message == Lane::IDLE)
+          {
+            blocks[index] = IDLE_BLOCK;
+          }
+          else if (lane.full_blocks > 0)
+          {
+            blocks[index] = lane.next_block;
+            lane.next_block += BLOCK_SIZE;
+            --lane.full_blocks;
+          }
+          else
+          {
+            blocks[index] = lane.tail + BLOCK_SIZE * lane.tail_used++;
+          }
+        }
+
+        compress_avx2(state, blocks);
+
+        for (size_t index = 0; index < LANES; ++index)
+        {
+          Lane &lane = lanes[index];
+          if (lane.message == Lane::IDLE || lane.full_blocks > 0 || lane.tail_used < lane.tail_blocks)
+          {
+            continue;
+          }
+          for (size_t word = 0; word < 8; ++word)
+          {
+            write_word(hashes[lane.message].data() + 4 * word, state[word][index]);
+          }
+          if (!start(index))
+          {
+            --active;
+          }
+        }
+      }
+    }
+
+    bool cpu_has_sha_extensions()
+    {
+      unsigned int eax, ebx, ecx, edx;
+      if (!__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx))
+      {
+        return false;
+      }
+      return (ebx & bit_SHA) != 0 && __builtin_cpu_supports("sse4.1");
+    }
+
+    std::vector<Implementation> supported_implementations()
+    {
+      std::vector<Implementation> supported;
+      if (cpu_has_sha_extensions())
+      {
+        supported.push_back({sha256_many_sha, "sha"});
+      }
+      if (__builtin_cpu_supports("avx2"))
+      {
+        supported.push_back({sha256_many_avx2, "avx2"});
+      }
+      supported.push_back({sha256_many_portable, "portable"});
+      return supported;
+    }
+
+#else
+
+    std::vector<Implementation> supported_implementations()
+    {
+      return {{sha256_many_portable, "portable"}};
+    }
+
+#endif
+
+    Implementation select_implementation()
+    {
+      return supported_implementations().front();
+    }
+
+    const Implementation &implementation()
+    {
+      static const Implementation selected = select_implementation();
+      return selected;
+    }
+
+  } // namespace
+
+  void sha256_many(std::span<const std::span<const byte>> messages, std::span<Hash> hashes)
+  {
+    implementation().hash(messages, hashes);
+  }
+
+  void sha256_many_portable(std::span<const std::span<const byte>> messages, std::span<Hash> hashes)
+  {
+    for (size_t i = 0; i < messages.size(); ++i)
+    {
+      hashes[i] = sha256(messages[i]);
+    }
+  }
+
+  const char *sha256_many_instruction_set()
+  {
+    return implementation().name;
+  }
+
+  std::vector<Sha256ManyImplementation> sha256_many_implementations()
+  {
+    return supported_implementations();
+  }
+
+} // namespace cryptography
@@ -0,0 +1,35 @@
+#ifndef SHA256_BATCH_HPP
+#define SHA256_BATCH_HPP
+
+#include "types.hpp"
+#include <span>
+#include <vector>
+
+namespace cryptography {
+
+// Hashes messages[i] into hashes[i], which must have one entry per message.
+// For the many short messages of block validation: on CPUs with the SHA
+// extensions each message runs straight through the SHA instructions
+// without an OpenSSL context, and with AVX2 eight messages are hashed side
+// by side, one per 32-bit lane. Results are identical to sha256().
+void sha256_many(std::span<const std::span<const byte>> messages, std::span<Hash> hashes);
+
+// One sha256() per message; what sha256_many() falls back to without SIMD support
+void sha256_many_portable(std::span<const std::span<const byte>> messages, std::span<Hash> hashes);
+
+// Instruction set sha256_many() runs on: "sha", "avx2" or "portable"
+const char* sha256_many_instruction_set();
+
+// A sha256_many() implementation and the instruction set it runs on
+struct Sha256ManyImplementation {
+    void (*hash)(std::span<const std::span<const byte>> messages, std::span<Hash> hashes);
+    const char* name;
+};
+
+// Every implementation this CPU can run, the one sha256_many() picks first
+// and the portable one last, so each can be checked against the others
+std::vector<Sha256ManyImplementation> sha256_many_implementations();
+
+} // namespace cryptography
+
+#endif // SHA256_BATCH_HPP
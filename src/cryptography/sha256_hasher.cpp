@@ -0,0 +1,38 @@
+#include "sha256_hasher.hpp"
+#include <new>
+
+#include <openssl/evp.h>
+
+namespace cryptography
+{
+
+  Sha256Hasher::Sha256Hasher() : context_(EVP_MD_CTX_new())
+  {
+    if (context_ == nullptr || !EVP_DigestInit_ex(context_, EVP_sha256(), nullptr))
+    {
+      EVP_MD_CTX_free(context_);
+      throw std::bad_alloc();
+    }
+  }
+
+  Sha256Hasher::~Sha256Hasher()
+  {
+    EVP_MD_CTX_free(context_);
+  }
+
+  Sha256Hasher &Sha256Hasher::update(std::span<const byte> data)
+  {
+    EVP_DigestUpdate(context_, data.data(), data.size());
+    return *this;
+  }
+
+  Hash Sha256Hasher::finalize()
+  {
+    Hash hash;
+    EVP_DigestFinal_ex(context_, hash.data(), nullptr);
+    // A null digest restarts with the one already set, skipping the algorithm lookup
+    EVP_DigestInit_ex(context_, nullptr, nullptr);
+    return hash;
+  }
+
+} // namespace cryptography
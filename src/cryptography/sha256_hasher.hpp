@@ -0,0 +1,36 @@
+#ifndef SHA256_HASHER_HPP
+#define SHA256_HASHER_HPP
+
+#include "types.hpp"
+#include <span>
+
+struct evp_md_ctx_st;
+
+namespace cryptography {
+
+// Incremental SHA-256, for preimages made of several fields that would
+// otherwise be concatenated into a buffer first. The OpenSSL context is
+// allocated once and reused after each finalize(), so a long-lived hasher
+// does no allocation per digest. Not thread-safe; sha256() keeps one per
+// thread.
+class Sha256Hasher {
+public:
+    Sha256Hasher();
+    ~Sha256Hasher();
+
+    Sha256Hasher(const Sha256Hasher&) = delete;
+    Sha256Hasher& operator=(const Sha256Hasher&) = delete;
+
+    Sha256Hasher& update(std::span<const byte> data);
+
+    // Digest of everything passed to update() since construction or the
+    // previous finalize(); the hasher then starts over empty
+    Hash finalize();
+
+private:
+    evp_md_ctx_st* context_;
+};
+
+} // namespace cryptography
+
+#endif // SHA256_HASHER_HPP
@@ -0,0 +1,59 @@
+#include "signature_batch.hpp"
+#include "schnorr_signature.hpp"
+#include "thread_pool.hpp"
+#include <atomic>
+#include <memory>
+
+namespace cryptography
+{
+
+  namespace
+  {
+    // Checks per chunk handed to the thread pool; each takes tens of
+    // microseconds, so small chunks still amortise the hand-off
+    constexpr size_t CHECKS_PER_CHUNK = 8;
+
+    bool verify_check(const SignatureCheck &check)
+    {
+      return SchnorrSignature::verify_hash(check.message_hash, check.signature, check.public_key);
+    }
+  }
+
+  std::vector<bool> verify_batch(std::span<const SignatureCheck> checks)
+  {
+    // std::vector<bool> packs bits, so threads write whole bytes first
+    std::unique_ptr<bool[]> valid(new bool[checks.size()]);
+    ThreadPool::shared().parallel_for(checks.size(), CHECKS_PER_CHUNK, [&](size_t begin, size_t end)
+                                      {
+      for (size_t i = begin; i < end; ++i)
+      {
+        valid[i] = verify_check(checks[i]);
+      } });
+    return std::vector<bool>(valid.get(), valid.get() + checks.size());
+  }
+
+  std::optional<size_t> first_invalid_signature(std::span<const SignatureCheck> checks)
+  {
+    std::atomic<size_t> first_invalid = checks.size();
+    ThreadPool::shared().parallel_for(checks.size(), CHECKS_PER_CHUNK, [&](size_t begin, size_t end)
+                                      {
+      for (size_t i = begin; i < end && i < first_invalid.load(std::memory_order_relaxed); ++i)
+      {
+        if (!verify_check(checks[i]))
+        {
+          size_t known = first_invalid.load(std::memory_order_relaxed);
+          while (i < known && !first_invalid.compare_exchange_weak(known, i, std::memory_order_relaxed))
+          {
+          }
+          return;
+        }
+      } });
+    size_t index = first_invalid.load();
+    if (index == checks.size())
+    {
+      return std::nullopt;
+    }
+    return index;
+  }
+
+} // namespace cryptography
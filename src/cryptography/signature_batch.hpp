@@ -0,0 +1,31 @@
+#ifndef SIGNATURE_BATCH_HPP
+#define SIGNATURE_BATCH_HPP
+
+#include "types.hpp"
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace cryptography {
+
+// One signature to verify. message_hash is the SHA-256 of the signed
+// message, which is what sign_message() actually signs, so callers that
+// already hold it need not rehash the message.
+struct SignatureCheck {
+    Hash message_hash;
+    Signature signature;
+    PublicKey public_key;
+};
+
+// Verifies every check, spread over the shared thread pool; entry i of
+// the result says whether checks[i] holds
+std::vector<bool> verify_batch(std::span<const SignatureCheck> checks);
+
+// Index of the first check that fails, or nothing if all hold. Checks
+// past a failure already found are skipped, so a bad block is rejected
+// without verifying the rest of it.
+std::optional<size_t> first_invalid_signature(std::span<const SignatureCheck> checks);
+
+} // namespace cryptography
+
+#endif // SIGNATURE_BATCH_HPP
@@ -0,0 +1,49 @@
+#include "signer.hpp"
+#include "cryptography.hpp"
+#include "schnorr_signature.hpp"
+#include <secp256k1.h>
+#include <secp256k1_schnorrsig.h>
+#include <cstring>
+#include <stdexcept>
+
+static_assert(sizeof(secp256k1_keypair) == 96, "Signer::KEYPAIR_SIZE must match secp256k1_keypair");
+
+Signer::Signer(const PrivateKey &private_key)
+{
+    secp256k1_context *context = SchnorrSignature::get_context();
+    secp256k1_keypair keypair;
+    if (!secp256k1_keypair_create(context, &keypair, private_key.data()))
+    {
+        throw std::runtime_error("Failed to create keypair for signing");
+    }
+    std::memcpy(keypair_.data(), keypair.data, keypair_.size());
+
+    secp256k1_xonly_pubkey xonly_pubkey;
+    if (!secp256k1_keypair_xonly_pub(context, &xonly_pubkey, nullptr, &keypair) ||
+        !secp256k1_xonly_pubkey_serialize(context, public_key_.data(), &xonly_pubkey))
+    {
+        throw std::runtime_error("Failed to extract x-only public key");
+    }
+}
+
+const PublicKey &Signer::get_public_key() const
+{
+    return public_key_;
+}
+
+Signature Signer::sign(std::span<const byte> message) const
+{
+    return sign_hash(cryptography::sha256(message));
+}
+
+Signature Signer::sign_hash(const Hash &message_hash) const
+{
+    secp256k1_keypair keypair;
+    std::memcpy(keypair.data, keypair_.data(), keypair_.size());
+    Signature signature;
+    if (!secp256k1_schnorrsig_sign(SchnorrSignature::get_context(), signature.data(), message_hash.data(), &keypair, nullptr))
+    {
+        throw std::runtime_error("Failed to sign message");
+    }
+    return signature;
+}
@@ -0,0 +1,34 @@
+#ifndef SIGNER_HPP
+#define SIGNER_HPP
+
+#include "types.hpp"
+#include <array>
+#include <span>
+
+// Signs with one private key. The key is expanded into a secp256k1
+// keypair once, when the signer is built, instead of on every signature,
+// so a node's block and transaction signing only pays for the signature
+// itself. Safe to use from several threads at once.
+class Signer
+{
+public:
+    // Throws if private_key is not a valid secret key
+    explicit Signer(const PrivateKey &private_key);
+
+    const PublicKey &get_public_key() const;
+
+    // Signs the SHA-256 of message, like SchnorrSignature::sign()
+    Signature sign(std::span<const byte> message) const;
+
+    Signature sign_hash(const Hash &message_hash) const;
+
+private:
+    // A secp256k1_keypair, held as bytes so that users of the signer need
+    // not see the secp256k1 headers
+    static constexpr size_t KEYPAIR_SIZE = 96;
+
+    std::array<unsigned char, KEYPAIR_SIZE> keypair_;
+    PublicKey public_key_;
+};
+
+#endif // SIGNER_HPP
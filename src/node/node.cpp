@@ -1,36 +1,81 @@
 #include "node.hpp"
+#include "../common/hex.hpp"
 #include "../common/utilities.hpp"
 #include "../storage/file_storage.hpp"
+#include "../storage/segment_storage.hpp"
+#include "../storage/caching_storage.hpp"
+#include "../storage/async_storage_writer.hpp"
 #include "../cryptography/cryptography.hpp"
+#include "../value_chain/value_block_view.hpp"
+#include <algorithm>
+#include <cstring>
 #include <iostream>
 #include <thread>
 #include <chrono>
 #include <csignal>
 
 Node::Node(const Config &config)
-    : node_role_(config.node_role),
+    : private_key_(cryptography::generate_private_key()), // A new key for every run
+      signer_(private_key_),
+      public_key_(signer_.get_public_key()),
+      node_role_(config.node_role),
       port_(config.port),
       config_(config),
+      block_format_(config.block_format == "v2" ? serialization::Format::v2 : serialization::Format::v1),
       running_(false)
 {
-    // Generate a new private key for the node
-    private_key_ = cryptography::generate_private_key();
-    public_key_ = cryptography::derive_public_key(private_key_);
-
     // Initialize NetworkManager
     network_manager_ = std::make_shared<NetworkManager>();
 
     // Initialize storage
     if (node_role_ == "time" || node_role_ == "dual")
     {
-        time_chain_storage_ = std::make_shared<FileStorage<TimeBlock>>();
+        time_chain_storage_ = create_storage<TimeBlock>(config.time_chain_cache_mb);
     }
     if (node_role_ == "value" || node_role_ == "dual")
     {
-        value_chain_storage_ = std::make_shared<FileStorage<ValueBlock>>();
+        value_chain_storage_ = create_storage<ValueBlock>(config.value_chain_cache_mb);
+        transaction_prover_ = std::make_unique<TransactionProver>(value_chain_storage_, PROOF_CACHE_BLOCKS);
     }
 }
 
+template <typename BlockType>
+std::shared_ptr<StorageInterface<BlockType>> Node::create_storage(size_t cache_mb) const
+{
+  std::shared_ptr<StorageInterface<BlockType>> storage;
+  if (config_.storage_backend == "segment" || config_.storage_backend == "uring")
+  {
+    SegmentStorageOptions options;
+    options.sync_writes = config_.sync_writes;
+    options.bloom_filter = config_.bloom_filter;
+    options.format = block_format_;
+    if (config_.storage_backend == "uring")
+    {
+      // Reads go through the ring too instead of the page cache mappings
+      options.io_engine = IoEngine::io_uring;
+      options.memory_map = false;
+    }
+    storage = std::make_shared<SegmentStorage<BlockType>>(options);
+  }
+  else
+  {
+    storage = std::make_shared<FileStorage<BlockType>>(block_format_);
+  }
+
+  // Keep the tip and hot blocks in memory unless caching is disabled
+  if (cache_mb > 0)
+  {
+    storage = std::make_shared<CachingStorage<BlockType>>(storage, cache_mb * 1024 * 1024);
+  }
+
+  // Persist blocks on a writer thread so consensus and networking never wait on disk
+  if (config_.write_queue_blocks > 0)
+  {
+    storage = std::make_shared<AsyncStorageWriter<BlockType>>(storage, config_.write_queue_blocks);
+  }
+  return storage;
+}
+
 
 void Node::add_known_peer(const IPAddress &ip, Port port)
 {
@@ -119,6 +164,17 @@ void Node::stop()
   // Stop network manager
   network_manager_->stop();
 
+  // Finish queued block writes while consensus is still around to run
+  // their continuations
+  if (time_chain_storage_)
+  {
+    time_chain_storage_->close();
+  }
+  if (value_chain_storage_)
+  {
+    value_chain_storage_->close();
+  }
+
   utilities::log_info("Node stopped.");
 }
 
@@ -194,7 +250,7 @@ bool Node::initialize_value_chain()
   return true;
 }
 
-void Node::handle_incoming_time_block(const IPAddress &sender, const bytes &data)
+void Node::handle_incoming_time_block(const IPAddress &sender, std::span<const byte> data)
 {
   // Deserialize TimeBlock
   TimeBlock block;
@@ -203,37 +259,68 @@ void Node::handle_incoming_time_block(const IPAddress &sender, const bytes &data
     utilities::log_error("Failed to deserialize TimeBlock from " + sender);
     return;
   }
-  utilities::log_info("Successfully deserialized TimeBlock from " + sender + " with Hash: " + utilities::bytes_to_hex(bytes(block.get_hash().begin(), block.get_hash().end())));
+  utilities::log_info("Successfully deserialized TimeBlock from " + sender + " with Hash: " + hex::encode(block.get_hash()));
 
   // Handle block
   time_chain_consensus_->handle_block(block);
 }
 
-void Node::handle_incoming_value_block(const IPAddress &sender, const bytes &data)
+void Node::handle_incoming_value_block(const IPAddress &sender, std::span<const byte> data)
 {
-  // Deserialize ValueBlock
-  ValueBlock block;
-  if (!block.deserialize(data))
+  // v2 blocks have no in-place view; decode them and check the hash on the copy
+  if (ValueBlock::Schema::detect(data) == serialization::Format::v2)
   {
-    utilities::log_error("Failed to deserialize ValueBlock from " + sender);
+    ValueBlock block;
+    if (!block.deserialize(data))
+    {
+      utilities::log_error("Failed to deserialize ValueBlock from " + sender);
+      return;
+    }
+    Hash claimed_hash = block.get_hash();
+    block.compute_hash();
+    if (block.get_hash() != claimed_hash)
+    {
+      utilities::log_error("ValueBlock from " + sender + " does not match its hash.");
+      return;
+    }
+    if (value_chain_storage_->block_exists(claimed_hash))
+    {
+      utilities::log_info("Ignoring already known ValueBlock from " + sender);
+      return;
+    }
+    value_chain_consensus_->handle_block(block);
     return;
   }
-  utilities::log_info("Successfully deserialized ValueBlock from " + sender);
-  // Handle block
-  value_chain_consensus_->handle_block(block);
-}
 
-void Node::handle_incoming_transaction(const IPAddress &sender, const bytes &data)
-{
-  // Check if data size meets the minimum expected size
-  const size_t MIN_TRANSACTION_SIZE = 32 + 32 + 8 + 8 + 0 + 64 + 32; // 176 bytes
-  if (data.size() < MIN_TRANSACTION_SIZE)
+  // Parse and hash-check the block in place; only a block we do not have
+  // yet is materialized for validation
+  auto view = ValueBlockView::parse(data);
+  if (!view)
+  {
+    utilities::log_error("Failed to parse ValueBlock from " + sender);
+    return;
+  }
+  if (!view->hash_matches())
+  {
+    utilities::log_error("ValueBlock from " + sender + " does not match its hash.");
+    return;
+  }
+  Hash block_hash;
+  std::ranges::copy(view->hash(), block_hash.begin());
+  if (value_chain_storage_->block_exists(block_hash))
   {
-    utilities::log_error("Received Transaction data size too small: " + std::to_string(data.size()) + " bytes from " + sender);
+    utilities::log_info("Ignoring already known ValueBlock from " + sender);
     return;
   }
+  utilities::log_info("Successfully parsed ValueBlock from " + sender);
+  // Handle block
+  value_chain_consensus_->handle_block(view->materialize());
+}
 
-  // Deserialize Transaction
+void Node::handle_incoming_transaction(const IPAddress &sender, std::span<const byte> data)
+{
+  // Deserialize Transaction; either format is accepted, and the schema
+  // rejects anything too short for the one it detects
   Transaction tx;
   if (!tx.deserialize(data))
   {
@@ -242,49 +329,50 @@ void Node::handle_incoming_transaction(const IPAddress &sender, const bytes &dat
   }
 
   // Add transaction to the pool
-  value_chain_consensus_->add_transaction(tx);
+  if (!value_chain_consensus_->add_transaction(tx))
+  {
+    utilities::log_error("Rejected Transaction from " + sender);
+    return;
+  }
   utilities::log_info("Transaction deserialized and added to the pool from " + sender);
 }
 
+bytes Node::build_message(byte message_type, size_t payload_size)
+{
+  bytes message(MESSAGE_HEADER_SIZE + payload_size);
+  uint32_t message_length_be = htonl(static_cast<uint32_t>(1 + payload_size));
+  std::memcpy(message.data(), &message_length_be, sizeof(uint32_t));
+  message[sizeof(uint32_t)] = message_type;
+  return message;
+}
+
+template <typename BlockType>
+bytes Node::build_block_message(byte message_type, const BlockType &block) const
+{
+  // Blocks travel behind the producer's public key
+  size_t block_size = block.serialized_size(block_format_);
+  bytes message = build_message(message_type, PUBLIC_KEY_SIZE + block_size);
+  byte *payload = message.data() + MESSAGE_HEADER_SIZE;
+  std::memcpy(payload, public_key_.data(), PUBLIC_KEY_SIZE);
+  block.serialize_into(std::span<byte>(payload + PUBLIC_KEY_SIZE, block_size), block_format_);
+  return message;
+}
+
 void Node::run_time_chain_loop()
 {
   utilities::log_info("TimeChain loop started.");
   while (running_)
   {
     // Produce block if eligible
-    auto block_opt = time_chain_consensus_->produce_block();
-    if (block_opt)
-    {
-      // Serialize the block
-      bytes serialized_block = block_opt->serialize();
-
-      // Prepend the message type and sender's public key
-      bytes payload;
-      bytes sender_pub_key(public_key_.begin(), public_key_.end());
-      payload.insert(payload.end(), sender_pub_key.begin(), sender_pub_key.end());
-      payload.insert(payload.end(), serialized_block.begin(), serialized_block.end());
-
-      // Construct the full message with length header
-      bytes message;
-
-      // Calculate total message size: Message Type + Payload
-      uint32_t message_length = 1 + payload.size(); // 1 byte for message type
-
-      // Convert to big-endian
-      uint32_t message_length_be = htonl(message_length);
-      bytes length_bytes(reinterpret_cast<const byte *>(&message_length_be), reinterpret_cast<const byte *>(&message_length_be) + sizeof(uint32_t));
-      message.insert(message.end(), length_bytes.begin(), length_bytes.end());
-
-      // Append message type
-      message.push_back(0x01); // Message type for TimeBlock
-
-      // Append payload
-      message.insert(message.end(), payload.begin(), payload.end());
+    // The block is broadcast once it is stored, from the storage's writer
+    // thread, while this loop carries on
+    time_chain_consensus_->produce_block([this](const TimeBlock &block)
+                                       {
+      bytes message = build_block_message(0x01, block); // Message type for TimeBlock
 
       // Broadcast the block
       network_manager_->broadcast_data(message);
-      utilities::log_info("TimeBlock broadcasted.");
-    }
+      utilities::log_info("TimeBlock broadcasted."); });
 
     // Sleep for a short duration
     std::this_thread::sleep_for(std::chrono::milliseconds(1000));
@@ -301,39 +389,15 @@ void Node::run_value_chain_loop()
     generate_and_broadcast_transaction();
 
     // Produce block if eligible
-    auto block_opt = value_chain_consensus_->produce_block();
-    if (block_opt)
-    {
-      // Serialize the block
-      bytes serialized_block = block_opt->serialize();
-
-      // Prepend the message type and sender's public key
-      bytes payload;
-      bytes sender_pub_key(public_key_.begin(), public_key_.end());
-      payload.insert(payload.end(), sender_pub_key.begin(), sender_pub_key.end());
-      payload.insert(payload.end(), serialized_block.begin(), serialized_block.end());
-
-      // Construct the full message with length header
-      bytes message;
-
-      // Calculate total message size: Message Type + Payload
-      uint32_t message_length = 1 + payload.size(); // 1 byte for message type
-
-      // Convert to big-endian
-      uint32_t message_length_be = htonl(message_length);
-      bytes length_bytes(reinterpret_cast<const byte *>(&message_length_be), reinterpret_cast<const byte *>(&message_length_be) + sizeof(uint32_t));
-      message.insert(message.end(), length_bytes.begin(), length_bytes.end());
-
-      // Append message type
-      message.push_back(0x02); // Message type for ValueBlock
-
-      // Append payload
-      message.insert(message.end(), payload.begin(), payload.end());
+    // The block is broadcast once it is stored, from the storage's writer
+    // thread, while this loop carries on
+    value_chain_consensus_->produce_block([this](const ValueBlock &block)
+                                       {
+      bytes message = build_block_message(0x02, block); // Message type for ValueBlock
 
       // Broadcast the block
       network_manager_->broadcast_data(message);
-      utilities::log_info("ValueBlock broadcasted.");
-    }
+      utilities::log_info("ValueBlock broadcasted."); });
 
     // Sleep for a short duration
     std::this_thread::sleep_for(std::chrono::seconds(5));
@@ -351,47 +415,101 @@ void Node::generate_and_broadcast_transaction()
   Transaction tx(public_key_, recipient_public_key, amount);
 
   // Sign the transaction
-  bytes tx_data_to_sign = tx.get_data_to_sign();
-  Signature signature = cryptography::sign_message(tx_data_to_sign, private_key_);
+  std::span<const byte> tx_data_to_sign = tx.get_data_to_sign();
+  Signature signature = signer_.sign(tx_data_to_sign);
   tx.set_signature(signature);
 
   // Add transaction to own pool
   value_chain_consensus_->add_transaction(tx);
 
-  // Serialize the transaction
-  bytes serialized_tx = tx.serialize();
-
-  // Ensure serialized_tx has the correct size
-  if (serialized_tx.size() != 176) // 32+32+8+8+0+64+32
-  {
-    utilities::log_error("Serialized Transaction size mismatch: " + std::to_string(serialized_tx.size()) + " bytes.");
-  }
-
-  // Construct the full message with length header
-  bytes message;
+  // Serialize the transaction straight into the message
+  bytes message = build_message(0x03, tx.serialized_size(block_format_)); // Message type for Transaction
+  tx.serialize_into(std::span<byte>(message).subspan(MESSAGE_HEADER_SIZE), block_format_);
 
-  // Calculate total message size: Message Type + Payload
-  uint32_t message_length = 1 + serialized_tx.size(); // 1 byte for message type
+  // Broadcast the transaction
+  network_manager_->broadcast_data(message);
+  utilities::log_info("Transaction broadcasted.");
+}
 
-  // Convert message_length to big-endian
-  uint32_t message_length_be = htonl(message_length);
-  bytes length_bytes(reinterpret_cast<const byte *>(&message_length_be), reinterpret_cast<const byte *>(&message_length_be) + sizeof(uint32_t));
-  message.insert(message.end(), length_bytes.begin(), length_bytes.end());
+bool Node::request_transaction_proof(const IPAddress &peer, const Hash &block_hash, const Hash &transaction_hash)
+{
+  bytes message = build_message(0x04, 2 * HASH_SIZE); // Message type for proof request
+  byte *payload = message.data() + MESSAGE_HEADER_SIZE;
+  std::memcpy(payload, block_hash.data(), HASH_SIZE);
+  std::memcpy(payload + HASH_SIZE, transaction_hash.data(), HASH_SIZE);
+  return network_manager_->send_data(peer, message);
+}
 
-  // Append message type
-  message.push_back(0x03); // Message type for Transaction
+void Node::handle_proof_request(const IPAddress &sender, std::span<const byte> data)
+{
+  if (data.size() != 2 * HASH_SIZE)
+  {
+    utilities::log_error("Malformed proof request of " + std::to_string(data.size()) + " bytes from " + sender);
+    return;
+  }
+  if (!transaction_prover_)
+  {
+    utilities::log_error("Ignoring proof request from " + sender + ": this node keeps no ValueChain.");
+    return;
+  }
+  ProofRequest request;
+  std::copy_n(data.begin(), HASH_SIZE, request.block_hash.begin());
+  std::copy_n(data.begin() + HASH_SIZE, HASH_SIZE, request.transaction_hash.begin());
+  pending_proof_requests_.push_back(request);
+}
 
-  // Append payload
-  message.insert(message.end(), serialized_tx.begin(), serialized_tx.end());
+void Node::answer_proof_request(const IPAddress &sender, const ProofRequest &request)
+{
+  auto proof = transaction_prover_->prove(request.block_hash, request.transaction_hash);
+  if (!proof)
+  {
+    utilities::log_info("No proof for the transaction requested by " + sender);
+    return;
+  }
+  bytes serialized = proof->serialize();
+  bytes message = build_message(0x05, serialized.size()); // Message type for proof
+  std::ranges::copy(serialized, message.begin() + MESSAGE_HEADER_SIZE);
+  network_manager_->send_data(sender, message);
+}
 
-  // Broadcast the transaction
-  network_manager_->broadcast_data(message);
-  utilities::log_info("Transaction broadcasted.");
+void Node::handle_incoming_proof(const IPAddress &sender, std::span<const byte> data)
+{
+  TransactionProof proof;
+  if (!proof.deserialize(data))
+  {
+    utilities::log_error("Failed to deserialize TransactionProof from " + sender);
+    return;
+  }
+  const Hash &transaction_hash = proof.get_transaction_hash();
+  std::string transaction = hex::encode(transaction_hash);
+  if (!proof.verify())
+  {
+    utilities::log_error("Invalid proof for transaction " + transaction + " from " + sender);
+    return;
+  }
+  Hash block_hash = proof.get_block_hash();
+  utilities::log_info("Transaction " + transaction + " is in ValueBlock " +
+                      hex::encode(block_hash));
 }
 
 void Node::handle_incoming_data(const IPAddress &sender, const bytes &data)
 {
-  std::lock_guard<std::mutex> lock(buffer_mutex_);
+  std::vector<ProofRequest> proof_requests;
+  {
+    std::lock_guard<std::mutex> lock(buffer_mutex_);
+    extract_messages(sender, data);
+    proof_requests.swap(pending_proof_requests_);
+  }
+  // Building a proof may load the block and hash its whole tree, so it
+  // runs without holding up data from other peers
+  for (const ProofRequest &request : proof_requests)
+  {
+    answer_proof_request(sender, request);
+  }
+}
+
+void Node::extract_messages(const IPAddress &sender, const bytes &data)
+{
   auto &buffer = incoming_buffers_[sender];
   buffer.insert(buffer.end(), data.begin(), data.end());
 
@@ -411,18 +529,13 @@ void Node::handle_incoming_data(const IPAddress &sender, const bytes &data)
     if (buffer.size() < 4 + message_length)
       break; // Wait for more data
 
-    // Extract the complete message
-    bytes complete_message(buffer.begin() + 4, buffer.begin() + 4 + message_length);
-
-    // Remove the processed message from the buffer
+    // Process the complete message in place, then drop it from the buffer
+    process_complete_message(sender, std::span<const byte>(buffer.data() + 4, message_length));
     buffer.erase(buffer.begin(), buffer.begin() + 4 + message_length);
-
-    // Process the complete message
-    process_complete_message(sender, complete_message);
   }
 }
 
-void Node::process_complete_message(const IPAddress &sender, const bytes &message)
+void Node::process_complete_message(const IPAddress &sender, std::span<const byte> message)
 {
   if (message.size() < 1)
   { // At least message type
@@ -431,7 +544,7 @@ void Node::process_complete_message(const IPAddress &sender, const bytes &messag
   }
 
   byte message_type = message[0];
-  bytes payload(message.begin() + 1, message.end());
+  std::span<const byte> payload = message.subspan(1);
 
   if (message_type == 0x01) // TimeBlock
   {
@@ -445,6 +558,14 @@ void Node::process_complete_message(const IPAddress &sender, const bytes &messag
   {
     handle_incoming_transaction(sender, payload);
   }
+  else if (message_type == 0x04) // Proof request
+  {
+    handle_proof_request(sender, payload);
+  }
+  else if (message_type == 0x05) // Transaction proof
+  {
+    handle_incoming_proof(sender, payload);
+  }
   else
   {
     utilities::log_error("Unknown message type received from " + sender + ": " + std::to_string(message_type));
@@ -5,19 +5,23 @@
 #include <vector>
 #include <string>
 #include <mutex>
+#include "../common/serialization.hpp"
 #include "../config/config.hpp"
 #include "../networking/network_manager.hpp"
 #include "../storage/storage_interface.hpp"
 #include "../cryptography/cryptography.hpp"
+#include "../cryptography/signer.hpp"
 #include "../consensus/time_chain_consensus.hpp"
 #include "../consensus/value_chain_consensus.hpp"
 #include "../time_chain/time_chain.hpp"
+#include "../value_chain/transaction_prover.hpp"
 #include "../value_chain/value_chain.hpp"
 #include <memory>
 #include <thread>
 #include <atomic>
 #include <vector>
 #include <utility>
+#include <span>
 
 class Node
 {
@@ -33,6 +37,10 @@ public:
   // Adds a known peer to connect to
   void add_known_peer(const IPAddress &ip, Port port);
 
+  // Asks a peer to prove that a transaction is in one of its value blocks;
+  // the proof is verified when it arrives
+  bool request_transaction_proof(const IPAddress &peer, const Hash &block_hash, const Hash &transaction_hash);
+
 private:
   // Node components
   std::shared_ptr<NetworkManager> network_manager_;
@@ -42,28 +50,53 @@ private:
   std::shared_ptr<ValueChain> value_chain_;
   std::unique_ptr<TimeChainConsensus> time_chain_consensus_;
   std::unique_ptr<ValueChainConsensus> value_chain_consensus_;
+  std::unique_ptr<TransactionProver> transaction_prover_;
   PrivateKey private_key_;
+  Signer signer_; // Signs our own transactions
   PublicKey public_key_;
 
   // Node configuration
   std::string node_role_;
   Port port_;
   Config config_;
+  serialization::Format block_format_; // Encoding for blocks we store and broadcast
 
   // Known peers
   std::vector<std::pair<IPAddress, Port>> known_peers_;
 
   // Initialization methods
+  template <typename BlockType>
+  std::shared_ptr<StorageInterface<BlockType>> create_storage(size_t cache_mb) const;
   bool initialize_components();
   bool initialize_time_chain();
   bool initialize_value_chain();
 
   // Event handlers
-  void handle_incoming_time_block(const IPAddress &sender, const bytes &data);
-  void handle_incoming_value_block(const IPAddress &sender, const bytes &data);
-  void handle_incoming_transaction(const IPAddress &sender, const bytes &data);
+  void handle_incoming_time_block(const IPAddress &sender, std::span<const byte> data);
+  void handle_incoming_value_block(const IPAddress &sender, std::span<const byte> data);
+  void handle_incoming_transaction(const IPAddress &sender, std::span<const byte> data);
+  void handle_proof_request(const IPAddress &sender, std::span<const byte> data);
+  void handle_incoming_proof(const IPAddress &sender, std::span<const byte> data);
   void handle_incoming_data(const IPAddress &sender, const bytes &data);
 
+  // Proof requests are parsed under buffer_mutex_ and answered after it is
+  // released
+  struct ProofRequest
+  {
+    Hash block_hash;
+    Hash transaction_hash;
+  };
+  void answer_proof_request(const IPAddress &sender, const ProofRequest &request);
+
+  // Message construction. Messages are [length][type][payload], with the
+  // big-endian length counting the type byte; each is built in one allocation
+  static constexpr size_t MESSAGE_HEADER_SIZE = sizeof(uint32_t) + 1;
+  // Value blocks whose Merkle trees are kept for answering proof requests
+  static constexpr size_t PROOF_CACHE_BLOCKS = 64;
+  static bytes build_message(byte message_type, size_t payload_size);
+  template <typename BlockType>
+  bytes build_block_message(byte message_type, const BlockType &block) const;
+
   // Main loops
   void run_time_chain_loop();
   void run_value_chain_loop();
@@ -76,9 +109,13 @@ private:
   std::thread value_chain_thread_;
   std::atomic<bool> running_;
   std::map<IPAddress, std::vector<byte>> incoming_buffers_;
+  std::vector<ProofRequest> pending_proof_requests_; // Guarded by buffer_mutex_
   std::mutex buffer_mutex_;
 
-  void process_complete_message(const IPAddress &sender, const bytes &message);
+  // Appends data to the sender's buffer and processes every complete
+  // message in it; called with buffer_mutex_ held
+  void extract_messages(const IPAddress &sender, const bytes &data);
+  void process_complete_message(const IPAddress &sender, std::span<const byte> message);
 };
 
 #endif // NODE_HPP
@@ -0,0 +1,82 @@
+#ifndef ASYNC_STORAGE_WRITER_HPP
+#define ASYNC_STORAGE_WRITER_HPP
+
+#include "storage_interface.hpp"
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+// Decorator that moves block writes off the caller's thread. Stored blocks
+// are queued and a dedicated writer thread hands everything queued so far
+// to the backend as one batch, completing each caller's future, and
+// running its continuation if it gave one, once the backend call returns. If the batch fails, each write in it is retried on
+// its own, so only the writes that cannot be stored report failure. Queued blocks are already visible to reads, so the
+// chain tip advances immediately. The queue is bounded: once max_pending
+// blocks are waiting, producers block until the writer catches up.
+template <typename BlockType>
+class AsyncStorageWriter : public StorageInterface<BlockType> {
+public:
+    AsyncStorageWriter(std::shared_ptr<StorageInterface<BlockType>> backend, size_t max_pending);
+    ~AsyncStorageWriter();
+
+    bool initialize(const std::string& data_directory) override;
+    bool store_block(const BlockType& block) override;
+    bool store_blocks(std::span<const BlockType> blocks) override;
+    std::future<bool> store_block_async(const BlockType& block) override;
+    // on_stored runs on the writer thread, in queue order. It must not store
+    // through this writer or wait for it, as the writer is busy running it.
+    void store_block_async(const BlockType& block, std::function<void(bool)> on_stored) override;
+    std::optional<BlockType> get_block(const Hash& block_hash) override;
+    std::optional<BlockView<BlockType>> get_block_view(const Hash& block_hash) override;
+    std::optional<BlockType> get_latest_block() override;
+    bool block_exists(const Hash& block_hash) override;
+    std::optional<BlockType> get_block_by_height(uint64_t height) override;
+    std::optional<uint64_t> get_latest_height() override;
+    size_t scan(uint64_t from_height, uint64_t to_height,
+                const std::function<bool(const BlockType&)>& visitor) override;
+    void close() override;
+    LockStats get_lock_stats() override;
+
+    // Blocks the caller until everything queued so far has been written
+    // and its continuations have run
+    void flush();
+
+private:
+    // One store call; completed as a whole
+    struct PendingWrite {
+        std::vector<BlockType> blocks;
+        std::promise<bool> stored;
+        std::function<void(bool)> on_stored; // Optional continuation
+    };
+
+    std::shared_ptr<StorageInterface<BlockType>> backend_;
+    size_t max_pending_;
+
+    std::mutex queue_mutex_;
+    std::condition_variable work_cv_;  // Signals the writer thread
+    std::condition_variable space_cv_; // Signals producers and flush()
+    std::deque<std::shared_ptr<PendingWrite>> pending_; // Queued and in-flight writes, oldest first
+    std::unordered_map<Hash, const BlockType*, HashHasher> pending_blocks_;
+    size_t pending_count_;
+    bool completing_; // The writer is running the continuations of its last batch
+    bool running_;
+    bool stopping_;
+    std::thread writer_thread_;
+
+    // Helper methods
+    std::future<bool> enqueue(std::vector<BlockType> blocks, std::function<void(bool)> on_stored = {});
+    static void complete(PendingWrite& write, bool stored);
+    void run_writer();
+    // Hands the batch to the backend; the result of each write in it
+    std::vector<bool> store_batch(const std::vector<std::shared_ptr<PendingWrite>>& batch);
+    void stop_writer();
+    std::optional<BlockType> find_pending(const Hash& block_hash);
+};
+
+#include "async_storage_writer.tpp"
+
+#endif // ASYNC_STORAGE_WRITER_HPP
@@ -0,0 +1,268 @@
+#ifndef ASYNC_STORAGE_WRITER_TPP
+#define ASYNC_STORAGE_WRITER_TPP
+
+#include "async_storage_writer.hpp"
+#include "../common/utilities.hpp"
+#include <algorithm>
+
+template <typename BlockType>
+AsyncStorageWriter<BlockType>::AsyncStorageWriter(std::shared_ptr<StorageInterface<BlockType>> backend,
+                                                  size_t max_pending)
+    : backend_(std::move(backend)), max_pending_(std::max<size_t>(max_pending, 1)), pending_count_(0),
+      completing_(false), running_(false), stopping_(false) {}
+
+template <typename BlockType>
+AsyncStorageWriter<BlockType>::~AsyncStorageWriter() {
+    close();
+}
+
+template <typename BlockType>
+bool AsyncStorageWriter<BlockType>::initialize(const std::string& data_directory) {
+    stop_writer();
+    if (!backend_->initialize(data_directory)) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    running_ = true;
+    writer_thread_ = std::thread(&AsyncStorageWriter::run_writer, this);
+    return true;
+}
+
+template <typename BlockType>
+bool AsyncStorageWriter<BlockType>::store_block(const BlockType& block) {
+    return enqueue({block}).get();
+}
+
+template <typename BlockType>
+bool AsyncStorageWriter<BlockType>::store_blocks(std::span<const BlockType> blocks) {
+    if (blocks.empty()) {
+        return true;
+    }
+    return enqueue(std::vector<BlockType>(blocks.begin(), blocks.end())).get();
+}
+
+template <typename BlockType>
+std::future<bool> AsyncStorageWriter<BlockType>::store_block_async(const BlockType& block) {
+    return enqueue({block});
+}
+
+template <typename BlockType>
+void AsyncStorageWriter<BlockType>::store_block_async(const BlockType& block, std::function<void(bool)> on_stored) {
+    enqueue({block}, std::move(on_stored));
+}
+
+template <typename BlockType>
+std::optional<BlockType> AsyncStorageWriter<BlockType>::get_block(const Hash& block_hash) {
+    if (auto block_opt = find_pending(block_hash)) {
+        return block_opt;
+    }
+    // The writer only drops a block from the queue once the backend has it
+    return backend_->get_block(block_hash);
+}
+
+template <typename BlockType>
+std::optional<BlockView<BlockType>> AsyncStorageWriter<BlockType>::get_block_view(const Hash& block_hash) {
+    if (auto block_opt = find_pending(block_hash)) {
+        return BlockView<BlockType>::from_bytes(block_opt->serialize());
+    }
+    return backend_->get_block_view(block_hash);
+}
+
+template <typename BlockType>
+std::optional<BlockType> AsyncStorageWriter<BlockType>::get_latest_block() {
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        if (!pending_.empty()) {
+            return pending_.back()->blocks.back();
+        }
+    }
+    return backend_->get_latest_block();
+}
+
+template <typename BlockType>
+bool AsyncStorageWriter<BlockType>::block_exists(const Hash& block_hash) {
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        if (pending_blocks_.contains(block_hash)) {
+            return true;
+        }
+    }
+    return backend_->block_exists(block_hash);
+}
+
+template <typename BlockType>
+std::optional<BlockType> AsyncStorageWriter<BlockType>::get_block_by_height(uint64_t height) {
+    // Heights are assigned by the backend, so only written blocks have one
+    return backend_->get_block_by_height(height);
+}
+
+template <typename BlockType>
+std::optional<uint64_t> AsyncStorageWriter<BlockType>::get_latest_height() {
+    return backend_->get_latest_height();
+}
+
+template <typename BlockType>
+size_t AsyncStorageWriter<BlockType>::scan(uint64_t from_height, uint64_t to_height,
+                                            const std::function<bool(const BlockType&)>& visitor) {
+    return backend_->scan(from_height, to_height, visitor);
+}
+
+template <typename BlockType>
+void AsyncStorageWriter<BlockType>::close() {
+    // Queued blocks are written out before the backend closes
+    stop_writer();
+    backend_->close();
+}
+
+template <typename BlockType>
+LockStats AsyncStorageWriter<BlockType>::get_lock_stats() {
+    return backend_->get_lock_stats();
+}
+
+template <typename BlockType>
+void AsyncStorageWriter<BlockType>::flush() {
+    std::unique_lock<std::mutex> lock(queue_mutex_);
+    space_cv_.wait(lock, [this]() { return pending_.empty() && !completing_; });
+}
+
+template <typename BlockType>
+std::future<bool> AsyncStorageWriter<BlockType>::enqueue(std::vector<BlockType> blocks,
+                                                         std::function<void(bool)> on_stored) {
+    auto write = std::make_shared<PendingWrite>();
+    write->blocks = std::move(blocks);
+    write->on_stored = std::move(on_stored);
+    std::future<bool> stored = write->stored.get_future();
+
+    // Backpressure: wait for room unless the queue is empty, so that a batch
+    // larger than the whole queue still gets through on its own
+    std::unique_lock<std::mutex> lock(queue_mutex_);
+    space_cv_.wait(lock, [&]() {
+        return !running_ || stopping_ || pending_count_ == 0 || pending_count_ + write->blocks.size() <= max_pending_;
+    });
+    if (!running_ || stopping_) {
+        // Not started or shutting down: fall back to a synchronous write
+        lock.unlock();
+        complete(*write, backend_->store_blocks(write->blocks));
+        return stored;
+    }
+
+    pending_count_ += write->blocks.size();
+    for (const BlockType& block : write->blocks) {
+        pending_blocks_[block.get_hash()] = &block;
+    }
+    pending_.push_back(std::move(write));
+    work_cv_.notify_one();
+    return stored;
+}
+
+template <typename BlockType>
+void AsyncStorageWriter<BlockType>::run_writer() {
+    std::unique_lock<std::mutex> lock(queue_mutex_);
+    while (true) {
+        work_cv_.wait(lock, [this]() { return stopping_ || !pending_.empty(); });
+        if (pending_.empty()) {
+            break; // Stopping and fully drained
+        }
+
+        // Everything queued so far goes to the backend as one batch; the
+        // writes stay in pending_ (and readable) until the backend has them
+        std::vector<std::shared_ptr<PendingWrite>> batch(pending_.begin(), pending_.end());
+        lock.unlock();
+
+        std::vector<bool> results = store_batch(batch);
+
+        lock.lock();
+        for (const auto& write : batch) {
+            for (const BlockType& block : write->blocks) {
+                auto it = pending_blocks_.find(block.get_hash());
+                if (it != pending_blocks_.end() && it->second == &block) {
+                    pending_blocks_.erase(it);
+                }
+            }
+            pending_count_ -= write->blocks.size();
+            pending_.pop_front();
+        }
+        completing_ = true;
+        space_cv_.notify_all();
+
+        // Continuations run without the queue lock, so producers are not
+        // held up while they relay or prune
+        lock.unlock();
+        for (size_t i = 0; i < batch.size(); ++i) {
+            complete(*batch[i], results[i]);
+        }
+        lock.lock();
+        completing_ = false;
+        space_cv_.notify_all();
+    }
+}
+
+template <typename BlockType>
+void AsyncStorageWriter<BlockType>::complete(PendingWrite& write, bool stored) {
+    write.stored.set_value(stored);
+    if (write.on_stored) {
+        write.on_stored(stored);
+    }
+}
+
+template <typename BlockType>
+std::vector<bool> AsyncStorageWriter<BlockType>::store_batch(const std::vector<std::shared_ptr<PendingWrite>>& batch) {
+    std::vector<BlockType> blocks;
+    for (const auto& write : batch) {
+        blocks.insert(blocks.end(), write->blocks.begin(), write->blocks.end());
+    }
+    if (backend_->store_blocks(blocks)) {
+        return std::vector<bool>(batch.size(), true);
+    }
+    if (batch.size() == 1) {
+        utilities::log_error("Failed to write " + std::to_string(blocks.size()) + " queued block(s).");
+        return {false};
+    }
+
+    // One bad block must not fail the unrelated writes queued with it, so
+    // each write is retried on its own. Blocks the backend kept from the
+    // failed batch are found rather than written again.
+    std::vector<bool> results;
+    size_t failed = 0;
+    for (const auto& write : batch) {
+        bool stored = std::ranges::all_of(write->blocks, [this](const BlockType& block) {
+            return backend_->block_exists(block.get_hash());
+        });
+        stored = stored || backend_->store_blocks(write->blocks);
+        failed += stored ? 0 : write->blocks.size();
+        results.push_back(stored);
+    }
+    utilities::log_error("Failed to write " + std::to_string(failed) + " of " + std::to_string(blocks.size()) +
+                         " queued block(s).");
+    return results;
+}
+
+template <typename BlockType>
+void AsyncStorageWriter<BlockType>::stop_writer() {
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        if (!running_) {
+            return;
+        }
+        stopping_ = true;
+    }
+    work_cv_.notify_one();
+    space_cv_.notify_all();
+    writer_thread_.join();
+
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    running_ = false;
+    stopping_ = false;
+}
+
+template <typename BlockType>
+std::optional<BlockType> AsyncStorageWriter<BlockType>::find_pending(const Hash& block_hash) {
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    auto it = pending_blocks_.find(block_hash);
+    if (it == pending_blocks_.end()) {
+        return std::nullopt;
+    }
+    return *it->second;
+}
+
+#endif // ASYNC_STORAGE_WRITER_TPP
@@ -0,0 +1,117 @@
+#ifndef BLOCK_INDEX_HPP
+#define BLOCK_INDEX_HPP
+
+#include "../common/types.hpp"
+#include <cstring>
+#include <vector>
+
+// Open-addressing hash table from block hash to a storage-specific
+// location. Keys are SHA-256 digests, so the first eight bytes already
+// are a uniformly distributed hash and a lookup is a single probe run
+// over one contiguous array. Blocks are never removed from storage,
+// so the index only supports insertion.
+template <typename Value>
+class BlockIndex {
+public:
+    explicit BlockIndex(size_t initial_capacity = 1024) {
+        slots_.resize(round_up_capacity(initial_capacity));
+    }
+
+    // Inserts a new entry or replaces the value of an existing one
+    void insert_or_assign(const Hash& key, const Value& value) {
+        if ((size_ + 1) * 10 > slots_.size() * 7) {
+            grow();
+        }
+        Slot& slot = slots_[probe(key)];
+        if (!slot.occupied) {
+            slot.occupied = true;
+            slot.key = key;
+            ++size_;
+        }
+        slot.value = value;
+    }
+
+    // Returns a pointer to the stored value, or nullptr if the key is absent
+    const Value* find(const Hash& key) const {
+        const Slot& slot = slots_[probe(key)];
+        return slot.occupied ? &slot.value : nullptr;
+    }
+
+    bool contains(const Hash& key) const {
+        return find(key) != nullptr;
+    }
+
+    size_t size() const {
+        return size_;
+    }
+
+    // Pre-sizes the table for the expected number of entries
+    void reserve(size_t count) {
+        while (count * 10 > slots_.size() * 7) {
+            grow();
+        }
+    }
+
+    void clear() {
+        slots_.assign(slots_.size(), Slot());
+        size_ = 0;
+    }
+
+    // Visits every entry in unspecified order
+    template <typename Visitor>
+    void for_each(Visitor&& visitor) const {
+        for (const Slot& slot : slots_) {
+            if (slot.occupied) {
+                visitor(slot.key, slot.value);
+            }
+        }
+    }
+
+private:
+    struct Slot {
+        Hash key{};
+        Value value{};
+        bool occupied = false;
+    };
+
+    std::vector<Slot> slots_;
+    size_t size_ = 0;
+
+    static size_t round_up_capacity(size_t capacity) {
+        size_t rounded = 16;
+        while (rounded < capacity) {
+            rounded <<= 1;
+        }
+        return rounded;
+    }
+
+    static uint64_t slot_hash(const Hash& key) {
+        uint64_t value;
+        std::memcpy(&value, key.data(), sizeof(value));
+        return value;
+    }
+
+    // Returns the position holding the key, or the empty slot where it belongs
+    size_t probe(const Hash& key) const {
+        size_t mask = slots_.size() - 1;
+        size_t position = static_cast<size_t>(slot_hash(key)) & mask;
+        while (slots_[position].occupied && slots_[position].key != key) {
+            position = (position + 1) & mask;
+        }
+        return position;
+    }
+
+    void grow() {
+        std::vector<Slot> old_slots(slots_.size() * 2);
+        old_slots.swap(slots_);
+        size_ = 0;
+        for (const Slot& slot : old_slots) {
+            if (slot.occupied) {
+                slots_[probe(slot.key)] = slot;
+                ++size_;
+            }
+        }
+    }
+};
+
+#endif // BLOCK_INDEX_HPP
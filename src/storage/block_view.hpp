@@ -0,0 +1,49 @@
+#ifndef BLOCK_VIEW_HPP
+#define BLOCK_VIEW_HPP
+
+#include "../common/types.hpp"
+#include <memory>
+#include <optional>
+#include <span>
+
+// Read-only view of a stored block's serialized bytes. The view keeps its
+// backing memory (a mapped segment or an owned buffer) alive, so it stays
+// valid after the storage has moved on or been closed. The block itself is
+// only decoded when the caller asks for ownership via materialize().
+template <typename BlockType>
+class BlockView {
+public:
+    BlockView(std::shared_ptr<const void> owner, std::span<const byte> data)
+        : owner_(std::move(owner)), data_(data) {}
+
+    // Creates a view that owns a copy of the serialized block
+    static BlockView from_bytes(bytes data) {
+        auto buffer = std::make_shared<const bytes>(std::move(data));
+        std::span<const byte> span(buffer->data(), buffer->size());
+        return BlockView(std::move(buffer), span);
+    }
+
+    // Serialized block bytes, suitable for relaying as-is
+    std::span<const byte> data() const {
+        return data_;
+    }
+
+    size_t size() const {
+        return data_.size();
+    }
+
+    // Decodes an owned block from the viewed bytes
+    std::optional<BlockType> materialize() const {
+        BlockType block;
+        if (!block.deserialize(data_)) {
+            return std::nullopt;
+        }
+        return block;
+    }
+
+private:
+    std::shared_ptr<const void> owner_;
+    std::span<const byte> data_;
+};
+
+#endif // BLOCK_VIEW_HPP
@@ -0,0 +1,142 @@
+#include "bloom_filter.hpp"
+#include "../common/crc32c.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+namespace {
+
+constexpr uint32_t BLOOM_MAGIC = 0x46425043; // "CPBF"
+constexpr uint32_t BLOOM_VERSION = 2;
+
+// Magic and version, capacity, size and watermark; the words follow, then a
+// CRC32C of everything before it
+constexpr size_t HEADER_WORDS = 4;
+constexpr size_t HEADER_SIZE = HEADER_WORDS * sizeof(uint64_t);
+constexpr size_t TRAILER_SIZE = sizeof(uint32_t);
+
+// 10 bits per key with 7 probes gives about a 1% false positive rate
+constexpr size_t BITS_PER_ITEM = 10;
+
+// Bit position within a block for the given probe, from two key bytes
+size_t probe_bit(const Hash& key, size_t probe) {
+    size_t offset = 8 + probe * 2;
+    return (static_cast<size_t>(key[offset]) | (static_cast<size_t>(key[offset + 1]) << 8)) & 511;
+}
+
+} // namespace
+
+BloomFilter::BloomFilter(size_t expected_items)
+    : block_count_(block_count_for(expected_items)), size_(0), capacity_(std::max<size_t>(expected_items, 1)) {
+    words_.assign(block_count_ * WORDS_PER_BLOCK, 0);
+}
+
+void BloomFilter::insert(const Hash& key) {
+    uint64_t* block = words_.data() + block_of(key) * WORDS_PER_BLOCK;
+    for (size_t probe = 0; probe < PROBES; ++probe) {
+        size_t bit = probe_bit(key, probe);
+        block[bit / 64] |= uint64_t(1) << (bit % 64);
+    }
+    ++size_;
+}
+
+bool BloomFilter::may_contain(const Hash& key) const {
+    const uint64_t* block = words_.data() + block_of(key) * WORDS_PER_BLOCK;
+    for (size_t probe = 0; probe < PROBES; ++probe) {
+        size_t bit = probe_bit(key, probe);
+        if ((block[bit / 64] & (uint64_t(1) << (bit % 64))) == 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+size_t BloomFilter::size() const {
+    return size_;
+}
+
+size_t BloomFilter::capacity() const {
+    return capacity_;
+}
+
+size_t BloomFilter::block_count_for(size_t expected_items) {
+    size_t bits = std::max<size_t>(expected_items * BITS_PER_ITEM, 512);
+    return (bits + 511) / 512;
+}
+
+size_t BloomFilter::block_of(const Hash& key) const {
+    uint64_t prefix;
+    std::memcpy(&prefix, key.data(), sizeof(prefix));
+    return static_cast<size_t>(prefix % block_count_);
+}
+
+bool BloomFilter::save(const std::string& filename, uint64_t watermark) const {
+    std::string temp_filename = filename + ".tmp";
+    {
+        std::ofstream file(temp_filename, std::ios::binary | std::ios::trunc);
+        if (!file) {
+            return false;
+        }
+        uint64_t header[HEADER_WORDS] = {
+            static_cast<uint64_t>(BLOOM_MAGIC) | (static_cast<uint64_t>(BLOOM_VERSION) << 32),
+            static_cast<uint64_t>(capacity_), static_cast<uint64_t>(size_), watermark};
+        std::span<const byte> header_bytes(reinterpret_cast<const byte*>(header), HEADER_SIZE);
+        std::span<const byte> word_bytes(reinterpret_cast<const byte*>(words_.data()),
+                                         words_.size() * sizeof(uint64_t));
+        uint32_t checksum = crc32c::extend(crc32c::compute(header_bytes), word_bytes);
+        file.write(reinterpret_cast<const char*>(header_bytes.data()), header_bytes.size());
+        file.write(reinterpret_cast<const char*>(word_bytes.data()), word_bytes.size());
+        file.write(reinterpret_cast<const char*>(&checksum), sizeof(checksum));
+        if (!file.good()) {
+            return false;
+        }
+    }
+    return std::rename(temp_filename.c_str(), filename.c_str()) == 0;
+}
+
+std::optional<BloomFilter> BloomFilter::load(const std::string& filename, uint64_t& watermark) {
+    std::ifstream file(filename, std::ios::binary | std::ios::ate);
+    if (!file) {
+        return std::nullopt;
+    }
+    std::streamoff file_size = file.tellg();
+    if (file_size < static_cast<std::streamoff>(HEADER_SIZE + TRAILER_SIZE)) {
+        return std::nullopt;
+    }
+    file.seekg(0);
+    uint64_t header[HEADER_WORDS];
+    file.read(reinterpret_cast<char*>(header), HEADER_SIZE);
+    if (!file.good() ||
+        header[0] != (static_cast<uint64_t>(BLOOM_MAGIC) | (static_cast<uint64_t>(BLOOM_VERSION) << 32))) {
+        return std::nullopt;
+    }
+
+    // Check the capacity against the file length before sizing anything by
+    // it; a filter takes more than a byte per key, so this also bounds the
+    // arithmetic below
+    uint64_t capacity = header[1];
+    if (capacity > static_cast<uint64_t>(file_size)) {
+        return std::nullopt;
+    }
+    size_t word_count = block_count_for(static_cast<size_t>(capacity)) * WORDS_PER_BLOCK;
+    if (static_cast<uint64_t>(file_size) != HEADER_SIZE + word_count * sizeof(uint64_t) + TRAILER_SIZE) {
+        return std::nullopt; // Truncated, or sized differently than its header says
+    }
+
+    BloomFilter filter(static_cast<size_t>(capacity));
+    std::span<byte> word_bytes(reinterpret_cast<byte*>(filter.words_.data()), word_count * sizeof(uint64_t));
+    uint32_t checksum;
+    file.read(reinterpret_cast<char*>(word_bytes.data()), word_bytes.size());
+    file.read(reinterpret_cast<char*>(&checksum), sizeof(checksum));
+    if (!file.good()) {
+        return std::nullopt;
+    }
+    std::span<const byte> header_bytes(reinterpret_cast<const byte*>(header), HEADER_SIZE);
+    if (crc32c::extend(crc32c::compute(header_bytes), word_bytes) != checksum) {
+        return std::nullopt; // A flipped bit could hide a stored block
+    }
+    filter.size_ = static_cast<size_t>(header[2]);
+    watermark = header[3];
+    return filter;
+}
@@ -0,0 +1,52 @@
+#ifndef BLOOM_FILTER_HPP
+#define BLOOM_FILTER_HPP
+
+#include "../common/types.hpp"
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+// Blocked Bloom filter over block hashes. Every key touches a single
+// 64-byte block, so a lookup costs at most one cache miss. Keys are
+// SHA-256 digests and already uniformly distributed, so the probe
+// positions are taken straight from the hash bytes instead of rehashing.
+// may_contain() never returns false for an inserted hash; a true answer
+// still has to be confirmed against the index.
+class BloomFilter {
+public:
+    // Sized for expected_items keys at roughly a 1% false positive rate
+    explicit BloomFilter(size_t expected_items = 0);
+
+    void insert(const Hash& key);
+    bool may_contain(const Hash& key) const;
+
+    // Number of inserted keys and the key count the filter was sized for;
+    // once size() reaches capacity() the false positive rate climbs and
+    // the owner should rebuild a larger filter
+    size_t size() const;
+    size_t capacity() const;
+
+    // Writes the filter together with a caller-defined watermark (how far
+    // into the data it covers); replaced atomically via a temporary file
+    bool save(const std::string& filename, uint64_t watermark) const;
+
+    // Reads a filter written by save(); nullopt if it is missing, its header
+    // disagrees with the file length or its checksum does not match
+    static std::optional<BloomFilter> load(const std::string& filename, uint64_t& watermark);
+
+private:
+    static constexpr size_t WORDS_PER_BLOCK = 8; // 512 bits, one cache line
+    static constexpr size_t PROBES = 7;
+
+    std::vector<uint64_t> words_;
+    size_t block_count_;
+    size_t size_;
+    size_t capacity_;
+
+    static size_t block_count_for(size_t expected_items);
+    size_t block_of(const Hash& key) const;
+};
+
+#endif // BLOOM_FILTER_HPP
@@ -0,0 +1,66 @@
+#ifndef CACHING_STORAGE_HPP
+#define CACHING_STORAGE_HPP
+
+#include "../common/cache_stats.hpp"
+#include "storage_interface.hpp"
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+// Decorator that keeps recently used blocks and the chain tip in memory in
+// front of any other StorageInterface. Blocks are evicted in least recently
+// used order once their combined serialized size exceeds the byte budget.
+template <typename BlockType>
+class CachingStorage : public StorageInterface<BlockType> {
+public:
+    CachingStorage(std::shared_ptr<StorageInterface<BlockType>> backend, size_t capacity_bytes);
+    ~CachingStorage();
+
+    bool initialize(const std::string& data_directory) override;
+    bool store_block(const BlockType& block) override;
+    bool store_blocks(std::span<const BlockType> blocks) override;
+    std::optional<BlockType> get_block(const Hash& block_hash) override;
+    std::optional<BlockView<BlockType>> get_block_view(const Hash& block_hash) override;
+    std::optional<BlockType> get_latest_block() override;
+    bool block_exists(const Hash& block_hash) override;
+    std::optional<BlockType> get_block_by_height(uint64_t height) override;
+    std::optional<uint64_t> get_latest_height() override;
+    size_t scan(uint64_t from_height, uint64_t to_height,
+                const std::function<bool(const BlockType&)>& visitor) override;
+    void close() override;
+    LockStats get_lock_stats() override;
+
+    // Snapshot of the hit/miss counters
+    CacheStats get_stats();
+
+private:
+    struct Entry {
+        Hash hash;
+        BlockType block;
+        size_t size;
+    };
+
+    std::shared_ptr<StorageInterface<BlockType>> backend_;
+    size_t capacity_bytes_;
+    // Held across a backend write and the tip update that follows it, so
+    // concurrent stores install their tips in the order they were written.
+    // Always taken before cache_mutex_.
+    std::mutex store_mutex_;
+    std::mutex cache_mutex_;
+
+    // Most recently used entries at the front
+    std::list<Entry> lru_;
+    std::unordered_map<Hash, typename std::list<Entry>::iterator, HashHasher> entries_;
+    std::optional<BlockType> latest_block_;
+    uint64_t store_generation_;
+    CacheStats stats_;
+
+    // Helper methods
+    void insert(const BlockType& block);
+    void clear();
+};
+
+#include "caching_storage.tpp"
+
+#endif // CACHING_STORAGE_HPP
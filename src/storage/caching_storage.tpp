@@ -0,0 +1,201 @@
+#ifndef CACHING_STORAGE_TPP
+#define CACHING_STORAGE_TPP
+
+#include "caching_storage.hpp"
+#include "../common/utilities.hpp"
+
+template <typename BlockType>
+CachingStorage<BlockType>::CachingStorage(std::shared_ptr<StorageInterface<BlockType>> backend, size_t capacity_bytes)
+    : backend_(std::move(backend)), capacity_bytes_(capacity_bytes), store_generation_(0) {}
+
+template <typename BlockType>
+CachingStorage<BlockType>::~CachingStorage() {
+    close();
+}
+
+template <typename BlockType>
+bool CachingStorage<BlockType>::initialize(const std::string& data_directory) {
+    {
+        std::lock_guard<std::mutex> lock(cache_mutex_);
+        clear();
+    }
+    return backend_->initialize(data_directory);
+}
+
+template <typename BlockType>
+bool CachingStorage<BlockType>::store_block(const BlockType& block) {
+    std::lock_guard<std::mutex> store_lock(store_mutex_);
+    if (!backend_->store_block(block)) {
+        return false;
+    }
+    // Write-through: the new tip is almost always the next block read
+    std::lock_guard<std::mutex> lock(cache_mutex_);
+    ++store_generation_;
+    latest_block_ = block;
+    insert(block);
+    return true;
+}
+
+template <typename BlockType>
+bool CachingStorage<BlockType>::store_blocks(std::span<const BlockType> blocks) {
+    std::lock_guard<std::mutex> store_lock(store_mutex_);
+    if (!backend_->store_blocks(blocks)) {
+        return false;
+    }
+    if (blocks.empty()) {
+        return true;
+    }
+    std::lock_guard<std::mutex> lock(cache_mutex_);
+    ++store_generation_;
+    latest_block_ = blocks.back();
+    for (const auto& block : blocks) {
+        insert(block);
+    }
+    return true;
+}
+
+template <typename BlockType>
+std::optional<BlockType> CachingStorage<BlockType>::get_block(const Hash& block_hash) {
+    {
+        std::lock_guard<std::mutex> lock(cache_mutex_);
+        auto it = entries_.find(block_hash);
+        if (it != entries_.end()) {
+            lru_.splice(lru_.begin(), lru_, it->second);
+            ++stats_.hits;
+            return it->second->block;
+        }
+        ++stats_.misses;
+    }
+
+    // Blocks are immutable per hash, so a concurrent fill is harmless
+    auto block_opt = backend_->get_block(block_hash);
+    if (block_opt) {
+        std::lock_guard<std::mutex> lock(cache_mutex_);
+        insert(*block_opt);
+    }
+    return block_opt;
+}
+
+template <typename BlockType>
+std::optional<BlockView<BlockType>> CachingStorage<BlockType>::get_block_view(const Hash& block_hash) {
+    // Views are about avoiding decoded copies, so they bypass the cache
+    return backend_->get_block_view(block_hash);
+}
+
+template <typename BlockType>
+std::optional<BlockType> CachingStorage<BlockType>::get_latest_block() {
+    uint64_t generation;
+    {
+        std::lock_guard<std::mutex> lock(cache_mutex_);
+        if (latest_block_) {
+            ++stats_.hits;
+            return latest_block_;
+        }
+        ++stats_.misses;
+        generation = store_generation_;
+    }
+
+    auto block_opt = backend_->get_latest_block();
+    if (block_opt) {
+        std::lock_guard<std::mutex> lock(cache_mutex_);
+        // A store that raced with this read has already installed a newer tip
+        if (generation == store_generation_) {
+            latest_block_ = block_opt;
+            insert(*block_opt);
+        }
+    }
+    return block_opt;
+}
+
+template <typename BlockType>
+bool CachingStorage<BlockType>::block_exists(const Hash& block_hash) {
+    {
+        std::lock_guard<std::mutex> lock(cache_mutex_);
+        if (entries_.contains(block_hash)) {
+            return true;
+        }
+    }
+    return backend_->block_exists(block_hash);
+}
+
+template <typename BlockType>
+std::optional<BlockType> CachingStorage<BlockType>::get_block_by_height(uint64_t height) {
+    return backend_->get_block_by_height(height);
+}
+
+template <typename BlockType>
+std::optional<uint64_t> CachingStorage<BlockType>::get_latest_height() {
+    return backend_->get_latest_height();
+}
+
+template <typename BlockType>
+size_t CachingStorage<BlockType>::scan(uint64_t from_height, uint64_t to_height,
+                                        const std::function<bool(const BlockType&)>& visitor) {
+    // Range scans would only churn the cache, so they go straight to the backend
+    return backend_->scan(from_height, to_height, visitor);
+}
+
+template <typename BlockType>
+void CachingStorage<BlockType>::close() {
+    {
+        std::lock_guard<std::mutex> lock(cache_mutex_);
+        if (stats_.hits + stats_.misses > 0) {
+            utilities::log_info("Block cache closed: " + std::to_string(stats_.hits) + " hit(s), " +
+                                std::to_string(stats_.misses) + " miss(es), " +
+                                std::to_string(stats_.evictions) + " eviction(s).");
+        }
+        clear();
+    }
+    backend_->close();
+}
+
+template <typename BlockType>
+LockStats CachingStorage<BlockType>::get_lock_stats() {
+    return backend_->get_lock_stats();
+}
+
+template <typename BlockType>
+CacheStats CachingStorage<BlockType>::get_stats() {
+    std::lock_guard<std::mutex> lock(cache_mutex_);
+    return stats_;
+}
+
+template <typename BlockType>
+void CachingStorage<BlockType>::insert(const BlockType& block) {
+    const Hash& block_hash = block.get_hash();
+    auto existing = entries_.find(block_hash);
+    if (existing != entries_.end()) {
+        lru_.splice(lru_.begin(), lru_, existing->second);
+        return;
+    }
+
+    size_t size = block.serialized_size();
+    if (size > capacity_bytes_) {
+        return; // Would evict everything else and still not fit
+    }
+
+    while (!lru_.empty() && stats_.bytes + size > capacity_bytes_) {
+        const Entry& victim = lru_.back();
+        stats_.bytes -= victim.size;
+        entries_.erase(victim.hash);
+        lru_.pop_back();
+        ++stats_.evictions;
+    }
+
+    lru_.push_front(Entry{block_hash, block, size});
+    entries_[block_hash] = lru_.begin();
+    stats_.bytes += size;
+    stats_.entries = entries_.size();
+}
+
+template <typename BlockType>
+void CachingStorage<BlockType>::clear() {
+    lru_.clear();
+    entries_.clear();
+    latest_block_.reset();
+    ++store_generation_;
+    stats_.entries = 0;
+    stats_.bytes = 0;
+}
+
+#endif // CACHING_STORAGE_TPP
@@ -2,8 +2,12 @@
 #define FILE_STORAGE_HPP
 
 #include "storage_interface.hpp"
+#include "block_index.hpp"
+#include "instrumented_mutex.hpp"
+#include "../common/serialization.hpp"
 #include <string>
 #include <mutex>
+#include <shared_mutex>
 #include <fstream>
 #include <filesystem>
 
@@ -12,24 +16,42 @@ namespace fs = std::filesystem;
 template <typename BlockType>
 class FileStorage : public StorageInterface<BlockType> {
 public:
-    FileStorage();
+    // Blocks are written in format and read back in either format
+    explicit FileStorage(serialization::Format format = serialization::Format::v1);
     ~FileStorage();
 
     bool initialize(const std::string& data_directory) override;
     bool store_block(const BlockType& block) override;
+    bool store_blocks(std::span<const BlockType> blocks) override;
     std::optional<BlockType> get_block(const Hash& block_hash) override;
+    std::optional<BlockView<BlockType>> get_block_view(const Hash& block_hash) override;
     std::optional<BlockType> get_latest_block() override;
     bool block_exists(const Hash& block_hash) override;
     void close() override;
+    LockStats get_lock_stats() override;
 
 private:
     std::string data_directory_;
-    std::mutex storage_mutex_;
+    serialization::Format format_;
+
+    // Writers serialize on write_mutex_ while they do their file I/O and
+    // only take index_mutex_ exclusively to publish finished blocks, so
+    // readers see committed blocks without waiting for a write to finish
+    std::mutex write_mutex_;
+    InstrumentedSharedMutex index_mutex_;
+
+    // Blocks present on disk, mapped to their file size; rebuilt at startup
+    BlockIndex<uint64_t> index_;
 
     // Helper methods
     std::string get_block_filename(const Hash& block_hash) const;
-    bool write_block_to_file(const BlockType& block, const std::string& filename);
-    std::optional<BlockType> read_block_from_file(const std::string& filename);
+    bool build_index();
+    bool write_block_to_file(const bytes& serialized_block, const std::string& filename);
+    bool stage_latest_block(const std::string& filename);
+    bool publish_latest_block();
+    std::optional<bytes> read_file(const std::string& filename, std::optional<uint64_t> file_size);
+    std::optional<BlockType> read_block_from_file(const std::string& filename,
+                                                  std::optional<uint64_t> file_size = std::nullopt);
 };
 
 #include "file_storage.tpp"
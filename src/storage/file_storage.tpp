@@ -2,13 +2,13 @@
 #define FILE_STORAGE_TPP
 
 #include "file_storage.hpp"
+#include "../common/hex.hpp"
 #include "../common/utilities.hpp"
 #include <fstream>
-#include <iomanip>
-#include <sstream>
+#include <string_view>
 
 template <typename BlockType>
-FileStorage<BlockType>::FileStorage() : data_directory_("") {}
+FileStorage<BlockType>::FileStorage(serialization::Format format) : data_directory_(""), format_(format) {}
 
 template <typename BlockType>
 FileStorage<BlockType>::~FileStorage() {
@@ -17,7 +17,8 @@ FileStorage<BlockType>::~FileStorage() {
 
 template <typename BlockType>
 bool FileStorage<BlockType>::initialize(const std::string& data_directory) {
-    std::lock_guard<std::mutex> lock(storage_mutex_);
+    std::lock_guard<std::mutex> write_lock(write_mutex_);
+    std::unique_lock<InstrumentedSharedMutex> lock(index_mutex_);
     data_directory_ = data_directory;
     try {
         if (!fs::exists(data_directory_)) {
@@ -26,7 +27,7 @@ bool FileStorage<BlockType>::initialize(const std::string& data_directory) {
         } else {
             utilities::log_info("Storage directory already exists: " + data_directory_);
         }
-        return true;
+        return build_index();
     } catch (const fs::filesystem_error& e) {
         utilities::log_error("Failed to initialize storage: " + std::string(e.what()));
         return false;
@@ -35,24 +36,54 @@ bool FileStorage<BlockType>::initialize(const std::string& data_directory) {
 
 template <typename BlockType>
 bool FileStorage<BlockType>::store_block(const BlockType& block) {
-    std::lock_guard<std::mutex> lock(storage_mutex_);
-    std::string filename = get_block_filename(block.get_hash());
-    bool write_success = write_block_to_file(block, filename);
-    if (write_success) {
-        utilities::log_info("Stored block: " + filename);
-    } else {
-        utilities::log_error("Failed to store block: " + filename);
+    return store_blocks(std::span<const BlockType>(&block, 1));
+}
+
+template <typename BlockType>
+bool FileStorage<BlockType>::store_blocks(std::span<const BlockType> blocks) {
+    std::lock_guard<std::mutex> write_lock(write_mutex_);
+    std::vector<std::pair<Hash, uint64_t>> written;
+    std::string filename; // Last block of the batch that is on disk
+
+    // Indexes the blocks written so far and makes the last of them the
+    // latest block. A batch that fails part way through still publishes
+    // the blocks before the failure, as they are on disk.
+    auto publish = [&]() {
+        bool staged = filename.empty() || stage_latest_block(filename);
+        std::unique_lock<InstrumentedSharedMutex> lock(index_mutex_);
+        for (const auto& [block_hash, file_size] : written) {
+            index_.insert_or_assign(block_hash, file_size);
+        }
+        return staged && (filename.empty() || publish_latest_block());
+    };
+
+    for (const auto& block : blocks) {
+        std::string block_filename = get_block_filename(block.get_hash());
+        // Only writers modify the index, so it can be read without index_mutex_
+        if (!index_.contains(block.get_hash())) {
+            bytes serialized_block = block.serialize(format_);
+            if (!write_block_to_file(serialized_block, block_filename)) {
+                utilities::log_error("Failed to store block: " + block_filename);
+                publish();
+                return false;
+            }
+            written.emplace_back(block.get_hash(), serialized_block.size());
+            utilities::log_info("Stored block: " + block_filename);
+        }
+        // Rewriting an existing file could tear a concurrent read, so it
+        // is kept, but it still counts as the batch's latest block
+        filename = std::move(block_filename);
     }
-    return write_success;
+    return publish();
 }
 
 template <typename BlockType>
 std::optional<BlockType> FileStorage<BlockType>::get_block(const Hash& block_hash) {
-    std::lock_guard<std::mutex> lock(storage_mutex_);
+    std::shared_lock<InstrumentedSharedMutex> lock(index_mutex_);
     std::string filename = get_block_filename(block_hash);
-    if (fs::exists(filename)) {
+    if (const uint64_t* file_size = index_.find(block_hash)) {
         utilities::log_info("Retrieving block: " + filename);
-        auto block_opt = read_block_from_file(filename);
+        auto block_opt = read_block_from_file(filename, *file_size);
         if (block_opt) {
             utilities::log_info("Successfully retrieved block: " + filename);
         } else {
@@ -64,9 +95,26 @@ std::optional<BlockType> FileStorage<BlockType>::get_block(const Hash& block_has
     return std::nullopt;
 }
 
+template <typename BlockType>
+std::optional<BlockView<BlockType>> FileStorage<BlockType>::get_block_view(const Hash& block_hash) {
+    std::shared_lock<InstrumentedSharedMutex> lock(index_mutex_);
+    std::string filename = get_block_filename(block_hash);
+    const uint64_t* file_size = index_.find(block_hash);
+    if (!file_size) {
+        utilities::log_error("Block does not exist: " + filename);
+        return std::nullopt;
+    }
+    // Hand out the file contents without decoding them
+    auto serialized_block = read_file(filename, *file_size);
+    if (!serialized_block) {
+        return std::nullopt;
+    }
+    return BlockView<BlockType>::from_bytes(std::move(*serialized_block));
+}
+
 template <typename BlockType>
 std::optional<BlockType> FileStorage<BlockType>::get_latest_block() {
-    std::lock_guard<std::mutex> lock(storage_mutex_);
+    std::shared_lock<InstrumentedSharedMutex> lock(index_mutex_);
     std::string latest_block_file = data_directory_ + "/latest.block";
     if (fs::exists(latest_block_file)) {
         utilities::log_info("Retrieving latest block: " + latest_block_file);
@@ -84,82 +132,134 @@ std::optional<BlockType> FileStorage<BlockType>::get_latest_block() {
 
 template <typename BlockType>
 bool FileStorage<BlockType>::block_exists(const Hash& block_hash) {
-    std::lock_guard<std::mutex> lock(storage_mutex_);
-    std::string filename = get_block_filename(block_hash);
-    bool exists = fs::exists(filename);
-    if (exists) {
-        utilities::log_info("Block exists: " + filename);
-    } else {
-        utilities::log_info("Block does not exist: " + filename);
-    }
-    return exists;
+    std::shared_lock<InstrumentedSharedMutex> lock(index_mutex_);
+    return index_.contains(block_hash);
 }
 
 template <typename BlockType>
 void FileStorage<BlockType>::close() {
-    std::lock_guard<std::mutex> lock(storage_mutex_);
+    std::lock_guard<std::mutex> write_lock(write_mutex_);
+    std::unique_lock<InstrumentedSharedMutex> lock(index_mutex_);
     // Any necessary cleanup can be done here
     utilities::log_info("Storage system closed.");
 }
 
+template <typename BlockType>
+LockStats FileStorage<BlockType>::get_lock_stats() {
+    return index_mutex_.get_stats();
+}
+
 template <typename BlockType>
 std::string FileStorage<BlockType>::get_block_filename(const Hash& block_hash) const {
-    // Convert hash to hex string for filename
-    std::ostringstream oss;
-    for (const auto& byte : block_hash) {
-        oss << std::hex << std::setw(2) << std::setfill('0') << static_cast<int>(byte);
+    // <data directory>/<hex hash>.block, with the hash encoded in place
+    static constexpr std::string_view EXTENSION = ".block";
+    std::string filename;
+    filename.reserve(data_directory_.size() + 1 + hex::encoded_size(HASH_SIZE) + EXTENSION.size());
+    filename += data_directory_;
+    filename += '/';
+    size_t hash_offset = filename.size();
+    filename.resize(hash_offset + hex::encoded_size(HASH_SIZE));
+    hex::encode(block_hash, filename.data() + hash_offset);
+    filename += EXTENSION;
+    return filename;
+}
+
+template <typename BlockType>
+bool FileStorage<BlockType>::build_index() {
+    // Block files are named by their hex hash, so the directory listing is the index
+    index_.clear();
+    for (const auto& entry : fs::directory_iterator(data_directory_)) {
+        if (entry.path().extension() == ".tmp") {
+            // Left behind by a crash before its rename; the block was never stored
+            std::error_code ec;
+            fs::remove(entry.path(), ec);
+            continue;
+        }
+        std::string stem = entry.path().stem().string();
+        Hash block_hash;
+        if (entry.path().extension() != ".block" || stem.size() != hex::encoded_size(HASH_SIZE) ||
+            !hex::decode(stem, block_hash.data())) {
+            continue; // Skips latest.block and unrelated files
+        }
+        index_.insert_or_assign(block_hash, entry.file_size());
     }
-    std::string hash_hex = oss.str();
-    return data_directory_ + "/" + hash_hex + ".block";
+    utilities::log_info("Indexed " + std::to_string(index_.size()) + " block(s) in " + data_directory_);
+    return true;
 }
 
 template <typename BlockType>
-bool FileStorage<BlockType>::write_block_to_file(const BlockType& block, const std::string& filename) {
-    std::ofstream file(filename, std::ios::binary);
+bool FileStorage<BlockType>::write_block_to_file(const bytes& serialized_block, const std::string& filename) {
+    // Written under a temporary name and renamed into place, so a crash
+    // mid-write never leaves a truncated block file behind
+    std::string temp_file = filename + ".tmp";
+    std::ofstream file(temp_file, std::ios::binary);
     if (!file) {
-        utilities::log_error("Failed to open file for writing: " + filename);
+        utilities::log_error("Failed to open file for writing: " + temp_file);
         return false;
     }
 
-    bytes serialized_block = block.serialize();
     file.write(reinterpret_cast<const char*>(serialized_block.data()), serialized_block.size());
+    file.close();
     if (!file.good()) {
-        utilities::log_error("Failed to write data to file: " + filename);
-        file.close();
+        utilities::log_error("Failed to write data to file: " + temp_file);
+        std::error_code ec;
+        fs::remove(temp_file, ec);
+        return false;
+    }
+    try {
+        fs::rename(temp_file, filename);
+    } catch (const fs::filesystem_error& e) {
+        utilities::log_error("Failed to rename block file: " + std::string(e.what()));
         return false;
     }
-    file.close();
     utilities::log_info("Block written to file: " + filename);
+    return true;
+}
+
+template <typename BlockType>
+bool FileStorage<BlockType>::stage_latest_block(const std::string& filename) {
+    std::string staged_file = data_directory_ + "/latest.block.tmp";
+    try {
+        fs::copy_file(filename, staged_file, fs::copy_options::overwrite_existing);
+    } catch (const fs::filesystem_error& e) {
+        utilities::log_error("Failed to stage latest block: " + std::string(e.what()));
+        return false;
+    }
+    return true;
+}
 
-    // Update latest block
+template <typename BlockType>
+bool FileStorage<BlockType>::publish_latest_block() {
+    // rename() swaps the file atomically, so readers never see a partial tip
     std::string latest_block_file = data_directory_ + "/latest.block";
     try {
-        fs::copy_file(filename, latest_block_file, fs::copy_options::overwrite_existing);
+        fs::rename(data_directory_ + "/latest.block.tmp", latest_block_file);
         utilities::log_info("Updated latest block: " + latest_block_file);
     } catch (const fs::filesystem_error& e) {
         utilities::log_error("Failed to update latest block: " + std::string(e.what()));
         return false;
     }
-
     return true;
 }
 
 template <typename BlockType>
-std::optional<BlockType> FileStorage<BlockType>::read_block_from_file(const std::string& filename) {
+std::optional<bytes> FileStorage<BlockType>::read_file(const std::string& filename, std::optional<uint64_t> file_size) {
     std::ifstream file(filename, std::ios::binary);
     if (!file) {
         utilities::log_error("Failed to open file for reading: " + filename);
         return std::nullopt;
     }
 
-    // Determine file size
-    file.seekg(0, std::ios::end);
-    size_t file_size = file.tellg();
-    file.seekg(0, std::ios::beg);
+    // Determine file size unless the index already knows it
+    if (!file_size) {
+        file.seekg(0, std::ios::end);
+        file_size = static_cast<uint64_t>(file.tellg());
+        file.seekg(0, std::ios::beg);
+    }
 
     // Read file content
-    bytes serialized_block(file_size);
-    file.read(reinterpret_cast<char*>(serialized_block.data()), file_size);
+    bytes serialized_block(*file_size);
+    file.read(reinterpret_cast<char*>(serialized_block.data()), serialized_block.size());
     if (!file.good()) {
         utilities::log_error("Failed to read data from file: " + filename);
         file.close();
@@ -167,10 +267,20 @@ std::optional<BlockType> FileStorage<BlockType>::read_block_from_file(const std:
     }
     file.close();
     utilities::log_info("Read data from file: " + filename);
+    return serialized_block;
+}
+
+template <typename BlockType>
+std::optional<BlockType> FileStorage<BlockType>::read_block_from_file(const std::string& filename,
+                                                                     std::optional<uint64_t> file_size) {
+    auto serialized_block = read_file(filename, file_size);
+    if (!serialized_block) {
+        return std::nullopt;
+    }
 
     // Deserialize the block
     BlockType block;
-    if (block.deserialize(serialized_block)) {
+    if (block.deserialize(*serialized_block)) {
         utilities::log_info("Deserialized block from file: " + filename);
         return block;
     } else {
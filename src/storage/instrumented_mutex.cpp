@@ -0,0 +1,83 @@
+#include "instrumented_mutex.hpp"
+#include <chrono>
+
+namespace {
+
+uint64_t elapsed_ns(std::chrono::steady_clock::time_point start) {
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+}
+
+} // namespace
+
+InstrumentedSharedMutex::InstrumentedSharedMutex() {
+    pthread_rwlockattr_t attributes;
+    pthread_rwlockattr_init(&attributes);
+#if defined(__GLIBC__)
+    // glibc defaults to preferring readers; other platforms already prefer writers
+    pthread_rwlockattr_setkind_np(&attributes, PTHREAD_RWLOCK_PREFER_WRITER_NONRECURSIVE_NP);
+#endif
+    pthread_rwlock_init(&rwlock_, &attributes);
+    pthread_rwlockattr_destroy(&attributes);
+}
+
+InstrumentedSharedMutex::~InstrumentedSharedMutex() {
+    pthread_rwlock_destroy(&rwlock_);
+}
+
+void InstrumentedSharedMutex::lock() {
+    exclusive_acquisitions_.fetch_add(1, std::memory_order_relaxed);
+    if (pthread_rwlock_trywrlock(&rwlock_) == 0) {
+        return;
+    }
+    auto start = std::chrono::steady_clock::now();
+    pthread_rwlock_wrlock(&rwlock_);
+    exclusive_contended_.fetch_add(1, std::memory_order_relaxed);
+    exclusive_wait_ns_.fetch_add(elapsed_ns(start), std::memory_order_relaxed);
+}
+
+bool InstrumentedSharedMutex::try_lock() {
+    if (pthread_rwlock_trywrlock(&rwlock_) != 0) {
+        return false;
+    }
+    exclusive_acquisitions_.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+void InstrumentedSharedMutex::unlock() {
+    pthread_rwlock_unlock(&rwlock_);
+}
+
+void InstrumentedSharedMutex::lock_shared() {
+    shared_acquisitions_.fetch_add(1, std::memory_order_relaxed);
+    if (pthread_rwlock_tryrdlock(&rwlock_) == 0) {
+        return;
+    }
+    auto start = std::chrono::steady_clock::now();
+    pthread_rwlock_rdlock(&rwlock_);
+    shared_contended_.fetch_add(1, std::memory_order_relaxed);
+    shared_wait_ns_.fetch_add(elapsed_ns(start), std::memory_order_relaxed);
+}
+
+bool InstrumentedSharedMutex::try_lock_shared() {
+    if (pthread_rwlock_tryrdlock(&rwlock_) != 0) {
+        return false;
+    }
+    shared_acquisitions_.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+void InstrumentedSharedMutex::unlock_shared() {
+    pthread_rwlock_unlock(&rwlock_);
+}
+
+LockStats InstrumentedSharedMutex::get_stats() const {
+    LockStats stats;
+    stats.shared_acquisitions = shared_acquisitions_.load(std::memory_order_relaxed);
+    stats.exclusive_acquisitions = exclusive_acquisitions_.load(std::memory_order_relaxed);
+    stats.shared_contended = shared_contended_.load(std::memory_order_relaxed);
+    stats.exclusive_contended = exclusive_contended_.load(std::memory_order_relaxed);
+    stats.shared_wait_ns = shared_wait_ns_.load(std::memory_order_relaxed);
+    stats.exclusive_wait_ns = exclusive_wait_ns_.load(std::memory_order_relaxed);
+    return stats;
+}
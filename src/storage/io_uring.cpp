@@ -0,0 +1,262 @@
+#include "io_uring.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <iterator>
+#include <vector>
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#define COIN_PLATFORM_HAS_IO_URING 1
+#endif
+
+#if defined(COIN_PLATFORM_HAS_IO_URING)
+
+namespace {
+
+// The rings are shared with the kernel; head and tail updates are the
+// synchronization points between the two sides
+unsigned load_acquire(unsigned* value) {
+    return std::atomic_ref<unsigned>(*value).load(std::memory_order_acquire);
+}
+
+void store_release(unsigned* value, unsigned new_value) {
+    std::atomic_ref<unsigned>(*value).store(new_value, std::memory_order_release);
+}
+
+template <typename T>
+T* at_offset(void* base, uint32_t offset) {
+    return reinterpret_cast<T*>(static_cast<char*>(base) + offset);
+}
+
+// Largest transfer submitted at once; the rest is resumed like a short transfer
+constexpr size_t MAX_TRANSFER = 1u << 30;
+
+} // namespace
+
+std::unique_ptr<IoUring> IoUring::create(unsigned entries) {
+    io_uring_params params;
+    std::memset(&params, 0, sizeof(params));
+    int fd = static_cast<int>(::syscall(__NR_io_uring_setup, entries, &params));
+    if (fd < 0) {
+        return nullptr;
+    }
+
+    std::unique_ptr<IoUring> ring(new IoUring());
+    ring->ring_fd_ = fd;
+    // IORING_OP_READ and IORING_OP_WRITE arrived in Linux 5.6 together with this feature bit
+    if (!(params.features & IORING_FEAT_RW_CUR_POS)) {
+        return nullptr;
+    }
+    ring->entries_ = params.sq_entries;
+
+    ring->sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    ring->cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    bool single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+    if (single_mmap) {
+        ring->sq_ring_size_ = std::max(ring->sq_ring_size_, ring->cq_ring_size_);
+        ring->cq_ring_size_ = 0;
+    }
+
+    void* sq_ring = ::mmap(nullptr, ring->sq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd,
+                           IORING_OFF_SQ_RING);
+    if (sq_ring == MAP_FAILED) {
+        return nullptr;
+    }
+    ring->sq_ring_ = sq_ring;
+
+    void* cq_ring = sq_ring;
+    if (!single_mmap) {
+        cq_ring = ::mmap(nullptr, ring->cq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd,
+                         IORING_OFF_CQ_RING);
+        if (cq_ring == MAP_FAILED) {
+            return nullptr;
+        }
+        ring->cq_ring_ = cq_ring;
+    }
+
+    ring->sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+    void* sqes = ::mmap(nullptr, ring->sqes_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd,
+                        IORING_OFF_SQES);
+    if (sqes == MAP_FAILED) {
+        return nullptr;
+    }
+    ring->sqes_ = sqes;
+
+    ring->sq_head_ = at_offset<unsigned>(sq_ring, params.sq_off.head);
+    ring->sq_tail_ = at_offset<unsigned>(sq_ring, params.sq_off.tail);
+    ring->sq_mask_ = at_offset<unsigned>(sq_ring, params.sq_off.ring_mask);
+    ring->sq_array_ = at_offset<unsigned>(sq_ring, params.sq_off.array);
+    ring->cq_head_ = at_offset<unsigned>(cq_ring, params.cq_off.head);
+    ring->cq_tail_ = at_offset<unsigned>(cq_ring, params.cq_off.tail);
+    ring->cq_mask_ = at_offset<unsigned>(cq_ring, params.cq_off.ring_mask);
+    ring->cqes_ = at_offset<void>(cq_ring, params.cq_off.cqes);
+    return ring;
+}
+
+IoUring::~IoUring() {
+    if (sqes_) {
+        ::munmap(sqes_, sqes_size_);
+    }
+    if (cq_ring_) {
+        ::munmap(cq_ring_, cq_ring_size_);
+    }
+    if (sq_ring_) {
+        ::munmap(sq_ring_, sq_ring_size_);
+    }
+    if (ring_fd_ >= 0) {
+        ::close(ring_fd_);
+    }
+}
+
+void IoUring::queue(const Slot& slot, uint64_t user_data, bool drain) {
+    // Only this side writes the submission tail
+    unsigned tail = *sq_tail_;
+    unsigned index = tail & *sq_mask_;
+    io_uring_sqe* sqe = static_cast<io_uring_sqe*>(sqes_) + index;
+    std::memset(sqe, 0, sizeof(*sqe));
+
+    const Operation& operation = *slot.operation;
+    sqe->fd = operation.fd;
+    sqe->user_data = user_data;
+    if (operation.opcode == Opcode::sync) {
+        sqe->opcode = IORING_OP_FSYNC;
+        sqe->fsync_flags = IORING_FSYNC_DATASYNC;
+    } else {
+        sqe->opcode = operation.opcode == Opcode::read ? IORING_OP_READ : IORING_OP_WRITE;
+        sqe->addr = reinterpret_cast<uint64_t>(operation.data + slot.done);
+        sqe->len = static_cast<uint32_t>(std::min(operation.size - slot.done, MAX_TRANSFER));
+        sqe->off = operation.offset + slot.done;
+    }
+    if (drain) {
+        // Starts only once everything submitted before it has completed
+        sqe->flags |= IOSQE_IO_DRAIN;
+    }
+    sq_array_[index] = index;
+    store_release(sq_tail_, tail + 1);
+}
+
+bool IoUring::enter(unsigned to_submit, unsigned min_complete, unsigned& submitted) {
+    submitted = 0;
+    while (true) {
+        int count = static_cast<int>(::syscall(__NR_io_uring_enter, ring_fd_, to_submit - submitted, min_complete,
+                                               IORING_ENTER_GETEVENTS, nullptr, 0));
+        if (count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            // A failed call consumed none of the remaining entries
+            return false;
+        }
+        // An interrupted wait still reports what it submitted; the caller waits again
+        submitted += static_cast<unsigned>(count);
+        if (submitted == to_submit) {
+            return true;
+        }
+    }
+}
+
+bool IoUring::execute(std::span<const Operation> operations) {
+    if (broken_) {
+        return false;
+    }
+    std::vector<Slot> slots;
+    slots.reserve(operations.size());
+    for (const Operation& operation : operations) {
+        slots.push_back(Slot{&operation, 0});
+    }
+
+    std::vector<size_t> retry;
+    size_t next = 0;
+    unsigned in_flight = 0;
+    bool failed = false;
+    bool resumed = false;
+    // After a failure nothing new is submitted, but the loop keeps reaping
+    // until the kernel is done with every buffer it was handed; returning
+    // earlier would leave completions for the next call and let the kernel
+    // write into buffers the caller may already have freed
+    while (in_flight > 0 || (!failed && (next < slots.size() || !retry.empty()))) {
+        unsigned to_submit = 0;
+        while (!failed && in_flight + to_submit < entries_ && (!retry.empty() || next < slots.size())) {
+            size_t index;
+            if (!retry.empty()) {
+                index = retry.back();
+                retry.pop_back();
+            } else {
+                index = next++;
+            }
+            queue(slots[index], index, slots[index].operation->opcode == Opcode::sync);
+            ++to_submit;
+        }
+        unsigned submitted = 0;
+        bool entered = enter(to_submit, 1, submitted);
+        in_flight += submitted;
+        if (!entered) {
+            // Withdraw the entries the kernel never took; only this side
+            // writes the tail, and the kernel reads no further than it
+            store_release(sq_tail_, *sq_tail_ - (to_submit - submitted));
+            if (to_submit == 0 && in_flight > 0) {
+                // Cannot even wait for what is in flight: retire the ring
+                broken_ = true;
+                return false;
+            }
+            failed = true;
+            continue;
+        }
+
+        unsigned head = *cq_head_;
+        unsigned tail = load_acquire(cq_tail_);
+        for (; head != tail; ++head) {
+            const io_uring_cqe& cqe = static_cast<const io_uring_cqe*>(cqes_)[head & *cq_mask_];
+            Slot& slot = slots[cqe.user_data];
+            const Operation& operation = *slot.operation;
+            --in_flight;
+            if (cqe.res == -EINTR || cqe.res == -EAGAIN) {
+                retry.push_back(cqe.user_data);
+                resumed = true;
+            } else if (cqe.res < 0 || (cqe.res == 0 && slot.done < operation.size)) {
+                failed = true; // An error, or a read past the end of the file
+            } else if (operation.opcode != Opcode::sync) {
+                slot.done += static_cast<size_t>(cqe.res);
+                if (slot.done < operation.size) {
+                    retry.push_back(cqe.user_data);
+                    resumed = true;
+                }
+            }
+        }
+        store_release(cq_head_, head);
+    }
+
+    if (!failed && resumed) {
+        // A resumed write may have landed after a sync that followed it; syncs are idempotent
+        std::vector<Operation> syncs;
+        std::copy_if(operations.begin(), operations.end(), std::back_inserter(syncs),
+                     [](const Operation& operation) { return operation.opcode == Opcode::sync; });
+        return syncs.empty() || execute(syncs);
+    }
+    return !failed;
+}
+
+#else
+
+std::unique_ptr<IoUring> IoUring::create(unsigned) {
+    return nullptr;
+}
+
+IoUring::~IoUring() = default;
+
+void IoUring::queue(const Slot&, uint64_t, bool) {}
+
+bool IoUring::enter(unsigned, unsigned, unsigned&) {
+    return false;
+}
+
+bool IoUring::execute(std::span<const Operation>) {
+    return false;
+}
+
+#endif
@@ -0,0 +1,76 @@
+#ifndef IO_URING_HPP
+#define IO_URING_HPP
+
+#include "../common/types.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+
+// Minimal io_uring submission/completion ring driven through the raw
+// system calls, so no liburing dependency is needed. A batch of reads and
+// writes is submitted with a single system call and runs concurrently in
+// the kernel; a sync waits for everything queued before it. A ring is not
+// thread-safe: each thread needs its own, or access must be serialized.
+class IoUring {
+public:
+    enum class Opcode { read, write, sync };
+
+    struct Operation {
+        Opcode opcode = Opcode::read;
+        int fd = -1;
+        byte* data = nullptr; // Source or destination; unused for sync
+        size_t size = 0;
+        uint64_t offset = 0;
+    };
+
+    // Sets up a ring with room for entries in-flight operations; nullptr
+    // when the kernel lacks io_uring or it is blocked (e.g. by seccomp)
+    static std::unique_ptr<IoUring> create(unsigned entries = 64);
+    ~IoUring();
+
+    IoUring(const IoUring&) = delete;
+    IoUring& operator=(const IoUring&) = delete;
+
+    // Submits the operations and waits until all of them completed.
+    // Short transfers are resumed; reads past the end of a file fail.
+    // Returns false if any operation failed. Even then nothing is left in
+    // flight on return, unless the ring itself broke; it then fails every
+    // later call and should be destroyed.
+    bool execute(std::span<const Operation> operations);
+
+private:
+    IoUring() = default;
+
+    int ring_fd_ = -1;
+    unsigned entries_ = 0;
+    bool broken_ = false;
+
+    void* sq_ring_ = nullptr;
+    size_t sq_ring_size_ = 0;
+    void* cq_ring_ = nullptr;
+    size_t cq_ring_size_ = 0;
+    void* sqes_ = nullptr;
+    size_t sqes_size_ = 0;
+
+    // Pointers into the shared rings
+    unsigned* sq_head_ = nullptr;
+    unsigned* sq_tail_ = nullptr;
+    unsigned* sq_mask_ = nullptr;
+    unsigned* sq_array_ = nullptr;
+    unsigned* cq_head_ = nullptr;
+    unsigned* cq_tail_ = nullptr;
+    unsigned* cq_mask_ = nullptr;
+    void* cqes_ = nullptr;
+
+    // Progress of one operation across resubmissions
+    struct Slot {
+        const Operation* operation;
+        size_t done;
+    };
+
+    void queue(const Slot& slot, uint64_t user_data, bool drain);
+    bool enter(unsigned to_submit, unsigned min_complete, unsigned& submitted);
+};
+
+#endif // IO_URING_HPP
@@ -0,0 +1,237 @@
+#ifndef SEGMENT_STORAGE_HPP
+#define SEGMENT_STORAGE_HPP
+
+#include "storage_interface.hpp"
+#include "block_index.hpp"
+#include "bloom_filter.hpp"
+#include "instrumented_mutex.hpp"
+#include "io_uring.hpp"
+#include "../common/serialization.hpp"
+#include <string>
+#include <mutex>
+#include <shared_mutex>
+#include <condition_variable>
+#include <span>
+#include <vector>
+#include <memory>
+#include <filesystem>
+
+namespace fs = std::filesystem;
+
+// How SegmentStorage issues its reads, appends and syncs
+enum class IoEngine {
+    psync,    // One pread/pwrite/fdatasync system call per operation
+    io_uring, // Batched submissions through io_uring; falls back to psync where unavailable
+};
+
+// Tuning knobs for SegmentStorage
+struct SegmentStorageOptions {
+    // Size every new segment file is preallocated to
+    uint64_t segment_size = 64ULL * 1024 * 1024;
+
+    // Serve reads from read-only memory mappings of the segments instead
+    // of pread; views handed out by get_block_view then point straight
+    // into the page cache
+    bool memory_map = true;
+
+    // Make every commit durable (fdatasync) before the store call returns
+    bool sync_writes = false;
+
+    // Coalesce concurrent store calls into one write and one durability barrier
+    bool group_commit = true;
+
+    // Answer lookups for absent blocks from a Bloom filter in front of the
+    // index; the filter is saved on close and reloaded on the next start
+    bool bloom_filter = true;
+
+    // Blocks the filter is initially sized for; it doubles when full
+    size_t bloom_filter_capacity = 1 << 16;
+
+    // Check every record's CRC32C when it is read; replay always checks them
+    bool verify_checksums = true;
+
+    // With io_uring an append and its sync go out in one submission, and a
+    // range scan submits the reads for all its runs at once
+    IoEngine io_engine = IoEngine::psync;
+
+    // Encoding new records are written in; records in either format are read
+    serialization::Format format = serialization::Format::v1;
+};
+
+// Append-only block log. Blocks are appended as records to large
+// preallocated segment files and located through an in-memory offset
+// index, so storing a block is a single sequential write. Appends do their
+// I/O under a writer lock only; readers share a lock over the index that a
+// commit holds exclusively just long enough to publish finished records,
+// so reads always see committed blocks and never wait on disk writes.
+//
+// Segment layout:  [segment header][record]...[commit marker][record]...[commit marker]...[zero fill]
+// Record layout:   [magic][payload size][height][CRC32C][reserved][block hash][previous hash][serialized block]
+// Commit marker:   [magic][CRC32C][batch start][record count][tip location]
+//
+// A record's CRC32C covers everything in it but the magic and the checksum
+// itself, so corruption is caught at memory bandwidth on every read without
+// recomputing the block's SHA-256. Every commit ends with a marker that
+// checksums the commit's record checksums and journals the new tip; records not followed by a valid marker were never
+// acknowledged and are discarded on recovery. A checksummed MANIFEST holds
+// a checkpoint of the index, heights and tip at a commit boundary, so a
+// restart loads it and only replays the log written after it. Each segment
+// rollover appends a chunk with just the changes since the previous
+// checkpoint; the manifest is compacted into one chunk on close.
+//
+// A block's height is its parent's height plus one. The chain of the latest
+// block is kept as a dense height -> record vector, so fetching by height is
+// a vector lookup and range scans walk the log mostly sequentially.
+template <typename BlockType>
+class SegmentStorage : public StorageInterface<BlockType> {
+public:
+    explicit SegmentStorage(const SegmentStorageOptions& options = SegmentStorageOptions());
+    ~SegmentStorage();
+
+    bool initialize(const std::string& data_directory) override;
+    bool store_block(const BlockType& block) override;
+    bool store_blocks(std::span<const BlockType> blocks) override;
+    std::optional<BlockType> get_block(const Hash& block_hash) override;
+    std::optional<BlockView<BlockType>> get_block_view(const Hash& block_hash) override;
+    std::optional<BlockType> get_latest_block() override;
+    bool block_exists(const Hash& block_hash) override;
+    std::optional<BlockType> get_block_by_height(uint64_t height) override;
+    std::optional<uint64_t> get_latest_height() override;
+    size_t scan(uint64_t from_height, uint64_t to_height,
+                const std::function<bool(const BlockType&)>& visitor) override;
+    void close() override;
+    LockStats get_lock_stats() override;
+
+private:
+    static constexpr uint32_t SEGMENT_MAGIC = 0x47535043; // "CPSG"
+    static constexpr uint32_t SEGMENT_VERSION = 4;
+    static constexpr uint32_t RECORD_MAGIC = 0x43525043;  // "CPRC"
+    static constexpr uint32_t COMMIT_MAGIC = 0x4D435043;  // "CPCM"
+    static constexpr uint32_t MANIFEST_MAGIC = 0x464D5043; // "CPMF"
+    static constexpr uint32_t MANIFEST_VERSION = 2;
+    static constexpr size_t MANIFEST_CHUNK_HEADER_SIZE = 24; // magic, version, checksum, reserved, body size
+    static constexpr size_t SEGMENT_HEADER_SIZE = 16;     // magic, version, segment id
+    static constexpr size_t RECORD_HEADER_SIZE = 24 + 2 * HASH_SIZE; // magic, payload size, height, checksum, hashes
+    static constexpr size_t RECORD_CHECKSUM_OFFSET = 16;
+    static constexpr size_t RECORD_HASH_OFFSET = 24;
+    static constexpr size_t RECORD_PREVIOUS_HASH_OFFSET = 24 + HASH_SIZE;
+    static constexpr size_t COMMIT_MARKER_SIZE = 48; // magic, checksum, batch start, record count, tip
+
+    // Height of a block whose parent is not in the log
+    static constexpr uint64_t NO_HEIGHT = UINT64_MAX;
+
+    // Position of a record's payload inside the log
+    struct RecordLocation {
+        uint32_t segment = 0;
+        uint64_t offset = 0;
+        uint32_t size = 0;
+        uint64_t height = NO_HEIGHT;
+    };
+
+    // Read-only mapping of a whole segment; unmapped when the last view goes away
+    struct Mapping {
+        const byte* data = nullptr;
+        size_t size = 0;
+        ~Mapping();
+    };
+
+    struct Segment {
+        uint32_t id = 0;
+        int fd = -1;
+        uint64_t capacity = 0;
+        std::shared_ptr<const Mapping> mapping;
+    };
+
+    SegmentStorageOptions options_;
+    std::string data_directory_;
+
+    // Lock order: write_mutex_ before index_mutex_. write_mutex_ serializes
+    // appends and owns write_offset_; index_mutex_ guards segments_, index_
+    // and tip_, which only change while write_mutex_ is held as well, so a
+    // writer may read them without taking index_mutex_.
+    std::mutex write_mutex_;
+    InstrumentedSharedMutex index_mutex_;
+
+    std::vector<Segment> segments_;
+    uint64_t write_offset_;
+    BlockIndex<RecordLocation> index_;
+    std::optional<RecordLocation> tip_;
+    std::vector<RecordLocation> heights_;
+
+    // Guarded like index_. record_count_ counts records in log order and
+    // serves as the filter's watermark: a loaded filter already holds every
+    // record before bloom_watermark_, so startup only inserts the tail.
+    std::optional<BloomFilter> bloom_;
+    uint64_t record_count_;
+    uint64_t bloom_watermark_;
+
+    // First segment written since the last checkpoint; synced before the next one
+    uint32_t checkpoint_segment_;
+
+    // Set under write_mutex_ when an append fails partway. The bytes past
+    // write_offset_ are unknown from then on, so commits are refused until
+    // initialize() replays the log.
+    bool write_failed_;
+
+    // Manifest bookkeeping, under write_mutex_. A checkpoint appends the
+    // blocks indexed and the heights changed since the previous one; the
+    // file is rewritten in full on close or once the appended chunks
+    // outgrow the last full write.
+    std::vector<Hash> unsaved_hashes_;
+    size_t heights_dirty_from_;
+    bool manifest_appendable_;
+    uint64_t manifest_full_size_;
+    uint64_t manifest_delta_size_;
+
+    // io_uring engine only: the ring appends go through, used under
+    // write_mutex_, and idle rings lent out to concurrent readers
+    static constexpr size_t MAX_IDLE_READ_RINGS = 8;
+    std::unique_ptr<IoUring> write_ring_;
+    std::mutex read_rings_mutex_;
+    std::vector<std::unique_ptr<IoUring>> read_rings_;
+
+    // A store call waiting for the group commit leader to write its blocks
+    struct CommitRequest {
+        std::span<const BlockType> blocks;
+        bool done = false;
+        bool success = false;
+    };
+
+    std::mutex commit_mutex_;
+    std::condition_variable commit_cv_;
+    std::vector<CommitRequest*> commit_queue_;
+    bool commit_leader_active_ = false;
+
+    // Helper methods
+    std::string get_segment_filename(uint32_t segment_id) const;
+    std::string get_manifest_filename() const;
+    bool open_segments();
+    bool open_segment(uint32_t segment_id, bool last);
+    bool replay_segment(const Segment& segment, uint64_t start_offset, bool& torn);
+    bool discard_tail(const Segment& segment, uint64_t offset);
+    bool write_manifest(bool full);
+    bool load_manifest(size_t& replay_segment, uint64_t& replay_offset);
+    void frame_commit_marker(bytes& buffer, uint64_t batch_start, uint64_t record_count, const RecordLocation& tip,
+                             uint32_t record_checksums);
+    std::optional<Segment> create_segment(uint32_t segment_id, uint64_t capacity);
+    bool map_segment(Segment& segment);
+    const Segment* find_segment(uint32_t segment_id) const;
+    const RecordLocation* find_location(const Hash& block_hash) const;
+    void load_bloom_filter();
+    void rebuild_bloom_filter(size_t capacity);
+    std::string get_bloom_filename() const;
+    bool commit(const std::vector<CommitRequest*>& requests);
+    uint32_t frame_record(bytes& buffer, const BlockType& block, uint64_t height, size_t payload_size);
+    static uint32_t record_checksum(const byte* record, size_t payload_size);
+    bool verify_record(const byte* record, const RecordLocation& location) const;
+    void extend_heights(const RecordLocation& location, Hash previous_hash);
+    std::optional<Hash> read_previous_hash(const RecordLocation& location) const;
+    bool read_runs(const std::vector<std::span<const RecordLocation>>& runs, std::vector<BlockType>& blocks);
+    bool read_segments(std::span<const IoUring::Operation> reads);
+    std::optional<BlockType> read_record(const RecordLocation& location);
+    void close_segments();
+};
+
+#include "segment_storage.tpp"
+
+#endif // SEGMENT_STORAGE_HPP
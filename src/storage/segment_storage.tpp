@@ -0,0 +1,1459 @@
+#ifndef SEGMENT_STORAGE_TPP
+#define SEGMENT_STORAGE_TPP
+
+#include "segment_storage.hpp"
+#include "../common/utilities.hpp"
+#include "../common/crc32c.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <unordered_map>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace segment_io {
+
+// Writes the whole buffer at the given offset, retrying short writes
+inline bool write_fully(int fd, const byte* data, size_t size, uint64_t offset) {
+    while (size > 0) {
+        ssize_t written = ::pwrite(fd, data, size, static_cast<off_t>(offset));
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        data += written;
+        size -= static_cast<size_t>(written);
+        offset += static_cast<uint64_t>(written);
+    }
+    return true;
+}
+
+// Reads exactly size bytes at the given offset
+inline bool read_fully(int fd, byte* data, size_t size, uint64_t offset) {
+    while (size > 0) {
+        ssize_t read_count = ::pread(fd, data, size, static_cast<off_t>(offset));
+        if (read_count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        if (read_count == 0) {
+            return false; // Unexpected end of file
+        }
+        data += read_count;
+        size -= static_cast<size_t>(read_count);
+        offset += static_cast<uint64_t>(read_count);
+    }
+    return true;
+}
+
+// Durability barrier: returns once written data has reached the disk
+inline bool sync(int fd) {
+#if defined(__linux__)
+    return ::fdatasync(fd) == 0;
+#else
+    return ::fsync(fd) == 0;
+#endif
+}
+
+// Makes a newly created file's directory entry durable
+inline bool sync_directory(const std::string& directory) {
+    int fd = ::open(directory.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    bool synced = ::fsync(fd) == 0;
+    ::close(fd);
+    return synced;
+}
+
+// Reserves disk space for a new segment so appends never extend the file
+inline bool preallocate(int fd, uint64_t size) {
+#if defined(__linux__)
+    if (::posix_fallocate(fd, 0, static_cast<off_t>(size)) == 0) {
+        return true;
+    }
+#endif
+    // Filesystems without fallocate support still get a correctly sized file
+    return ::ftruncate(fd, static_cast<off_t>(size)) == 0;
+}
+
+// Runs the operations through the ring when there is one, otherwise one
+// system call at a time in order
+inline bool execute(IoUring* ring, std::span<const IoUring::Operation> operations) {
+    if (ring) {
+        return ring->execute(operations);
+    }
+    for (const IoUring::Operation& operation : operations) {
+        bool done = false;
+        switch (operation.opcode) {
+        case IoUring::Opcode::read:
+            done = read_fully(operation.fd, operation.data, operation.size, operation.offset);
+            break;
+        case IoUring::Opcode::write:
+            done = write_fully(operation.fd, operation.data, operation.size, operation.offset);
+            break;
+        case IoUring::Opcode::sync:
+            done = sync(operation.fd);
+            break;
+        }
+        if (!done) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace segment_io
+
+template <typename BlockType>
+SegmentStorage<BlockType>::SegmentStorage(const SegmentStorageOptions& options)
+    : options_(options), data_directory_(""), write_offset_(0), record_count_(0), bloom_watermark_(0),
+      checkpoint_segment_(0), write_failed_(false), heights_dirty_from_(0), manifest_appendable_(false),
+      manifest_full_size_(0), manifest_delta_size_(0) {}
+
+template <typename BlockType>
+SegmentStorage<BlockType>::~SegmentStorage() {
+    close();
+}
+
+template <typename BlockType>
+bool SegmentStorage<BlockType>::initialize(const std::string& data_directory) {
+    std::lock_guard<std::mutex> write_lock(write_mutex_);
+    std::unique_lock<InstrumentedSharedMutex> lock(index_mutex_);
+    data_directory_ = data_directory;
+    write_failed_ = false;
+    try {
+        if (!fs::exists(data_directory_)) {
+            fs::create_directories(data_directory_);
+            utilities::log_info("Created storage directory: " + data_directory_);
+        } else {
+            utilities::log_info("Storage directory already exists: " + data_directory_);
+        }
+    } catch (const fs::filesystem_error& e) {
+        utilities::log_error("Failed to initialize storage: " + std::string(e.what()));
+        return false;
+    }
+
+    if (options_.io_engine == IoEngine::io_uring) {
+        write_ring_ = IoUring::create();
+        if (!write_ring_) {
+            utilities::log_info("io_uring is unavailable; the block log falls back to pread/pwrite.");
+        }
+    }
+    if (!open_segments()) {
+        close_segments();
+        return false;
+    }
+    utilities::log_info("Opened block log with " + std::to_string(segments_.size()) + " segment(s) and " +
+                        std::to_string(index_.size()) + " block(s).");
+    return true;
+}
+
+template <typename BlockType>
+bool SegmentStorage<BlockType>::store_block(const BlockType& block) {
+    return store_blocks(std::span<const BlockType>(&block, 1));
+}
+
+template <typename BlockType>
+bool SegmentStorage<BlockType>::store_blocks(std::span<const BlockType> blocks) {
+    if (blocks.empty()) {
+        return true;
+    }
+
+    CommitRequest request{blocks};
+    if (!options_.group_commit) {
+        std::lock_guard<std::mutex> lock(write_mutex_);
+        return commit({&request});
+    }
+
+    // Group commit: whoever finds no commit in progress becomes the leader
+    // and writes out every request queued so far with a single write and a
+    // single durability barrier; the others wait for the leader to finish.
+    std::unique_lock<std::mutex> queue_lock(commit_mutex_);
+    commit_queue_.push_back(&request);
+    while (!request.done) {
+        if (commit_leader_active_) {
+            commit_cv_.wait(queue_lock);
+            continue;
+        }
+
+        commit_leader_active_ = true;
+        std::vector<CommitRequest*> batch;
+        batch.swap(commit_queue_);
+        queue_lock.unlock();
+
+        bool success;
+        {
+            std::lock_guard<std::mutex> lock(write_mutex_);
+            success = commit(batch);
+        }
+
+        queue_lock.lock();
+        for (CommitRequest* queued : batch) {
+            queued->success = success;
+            queued->done = true;
+        }
+        commit_leader_active_ = false;
+        commit_cv_.notify_all();
+    }
+    return request.success;
+}
+
+template <typename BlockType>
+std::optional<BlockType> SegmentStorage<BlockType>::get_block(const Hash& block_hash) {
+    std::shared_lock<InstrumentedSharedMutex> lock(index_mutex_);
+    const RecordLocation* location = find_location(block_hash);
+    if (!location) {
+        utilities::log_error("Block does not exist in block log.");
+        return std::nullopt;
+    }
+    return read_record(*location);
+}
+
+template <typename BlockType>
+std::optional<BlockView<BlockType>> SegmentStorage<BlockType>::get_block_view(const Hash& block_hash) {
+    std::shared_lock<InstrumentedSharedMutex> lock(index_mutex_);
+    const RecordLocation* location = find_location(block_hash);
+    if (!location) {
+        utilities::log_error("Block does not exist in block log.");
+        return std::nullopt;
+    }
+    const Segment* segment = find_segment(location->segment);
+    if (!segment) {
+        utilities::log_error("Segment " + std::to_string(location->segment) + " is not open.");
+        return std::nullopt;
+    }
+
+    if (segment->mapping) {
+        // Zero-copy: the view shares ownership of the mapping
+        const byte* record = segment->mapping->data + location->offset - RECORD_HEADER_SIZE;
+        if (!verify_record(record, *location)) {
+            return std::nullopt;
+        }
+        return BlockView<BlockType>(segment->mapping, std::span<const byte>(record + RECORD_HEADER_SIZE, location->size));
+    }
+
+    // The header comes along in the same read for its checksum
+    bytes record(RECORD_HEADER_SIZE + location->size);
+    IoUring::Operation read{IoUring::Opcode::read, segment->fd, record.data(), record.size(),
+                            location->offset - RECORD_HEADER_SIZE};
+    if (!read_segments(std::span(&read, 1))) {
+        utilities::log_error("Failed to read record from segment " + std::to_string(location->segment));
+        return std::nullopt;
+    }
+    if (!verify_record(record.data(), *location)) {
+        return std::nullopt;
+    }
+    record.erase(record.begin(), record.begin() + RECORD_HEADER_SIZE);
+    return BlockView<BlockType>::from_bytes(std::move(record));
+}
+
+template <typename BlockType>
+std::optional<BlockType> SegmentStorage<BlockType>::get_latest_block() {
+    std::shared_lock<InstrumentedSharedMutex> lock(index_mutex_);
+    if (!tip_) {
+        utilities::log_error("Block log is empty.");
+        return std::nullopt;
+    }
+    return read_record(*tip_);
+}
+
+template <typename BlockType>
+bool SegmentStorage<BlockType>::block_exists(const Hash& block_hash) {
+    std::shared_lock<InstrumentedSharedMutex> lock(index_mutex_);
+    return find_location(block_hash) != nullptr;
+}
+
+template <typename BlockType>
+std::optional<BlockType> SegmentStorage<BlockType>::get_block_by_height(uint64_t height) {
+    std::shared_lock<InstrumentedSharedMutex> lock(index_mutex_);
+    if (height >= heights_.size() || heights_[height].height == NO_HEIGHT) {
+        return std::nullopt;
+    }
+    return read_record(heights_[height]);
+}
+
+template <typename BlockType>
+std::optional<uint64_t> SegmentStorage<BlockType>::get_latest_height() {
+    std::shared_lock<InstrumentedSharedMutex> lock(index_mutex_);
+    if (!tip_ || tip_->height == NO_HEIGHT) {
+        return std::nullopt;
+    }
+    return tip_->height;
+}
+
+template <typename BlockType>
+size_t SegmentStorage<BlockType>::scan(uint64_t from_height, uint64_t to_height,
+                                       const std::function<bool(const BlockType&)>& visitor) {
+    // Blocks are decoded a batch at a time under the shared lock and handed
+    // to the visitor without it, so the visitor may call back into storage
+    constexpr size_t SCAN_BATCH_SIZE = 64;
+    size_t visited = 0;
+    uint64_t height = from_height;
+    std::vector<BlockType> blocks;
+    bool readable = true;
+    while (readable && height <= to_height) {
+        blocks.clear();
+        {
+            std::shared_lock<InstrumentedSharedMutex> lock(index_mutex_);
+            uint64_t end = std::min<uint64_t>(heights_.size(), height + SCAN_BATCH_SIZE);
+            if (to_height < end) {
+                end = to_height + 1; // Cannot overflow: to_height is below a vector size
+            }
+            if (height >= end) {
+                break;
+            }
+
+            // Records written back to back are read as one run, across the
+            // commit marker between them if they were stored separately
+            std::vector<std::span<const RecordLocation>> runs;
+            size_t run_start = height;
+            for (uint64_t next = height + 1; next <= end; ++next) {
+                const RecordLocation& previous = heights_[next - 1];
+                uint64_t record_end = previous.offset + previous.size + RECORD_HEADER_SIZE;
+                if (next < end && heights_[next].segment == previous.segment &&
+                    (heights_[next].offset == record_end ||
+                     heights_[next].offset == record_end + COMMIT_MARKER_SIZE)) {
+                    continue;
+                }
+                runs.emplace_back(heights_.data() + run_start, next - run_start);
+                run_start = next;
+            }
+            // A damaged record ends the scan after the blocks decoded before it
+            readable = read_runs(runs, blocks);
+            height = end;
+        }
+
+        for (const BlockType& block : blocks) {
+            ++visited;
+            if (!visitor(block)) {
+                return visited;
+            }
+        }
+    }
+    return visited;
+}
+
+template <typename BlockType>
+void SegmentStorage<BlockType>::close() {
+    std::lock_guard<std::mutex> write_lock(write_mutex_);
+    std::unique_lock<InstrumentedSharedMutex> lock(index_mutex_);
+    if (segments_.empty()) {
+        return;
+    }
+    // Compacts the appended chunks into a single checkpoint
+    if (!write_manifest(true)) {
+        utilities::log_error("Failed to write block log manifest.");
+    }
+    if (bloom_ && !bloom_->save(get_bloom_filename(), record_count_)) {
+        utilities::log_error("Failed to save Bloom filter: " + get_bloom_filename());
+    }
+    close_segments();
+    write_ring_.reset();
+    {
+        std::lock_guard<std::mutex> rings_lock(read_rings_mutex_);
+        read_rings_.clear();
+    }
+    utilities::log_info("Storage system closed.");
+}
+
+template <typename BlockType>
+LockStats SegmentStorage<BlockType>::get_lock_stats() {
+    return index_mutex_.get_stats();
+}
+
+template <typename BlockType>
+std::string SegmentStorage<BlockType>::get_segment_filename(uint32_t segment_id) const {
+    char name[32];
+    std::snprintf(name, sizeof(name), "segment_%08u.log", segment_id);
+    return data_directory_ + "/" + name;
+}
+
+template <typename BlockType>
+bool SegmentStorage<BlockType>::open_segments() {
+    // Collect existing segment ids in log order
+    std::vector<uint32_t> segment_ids;
+    try {
+        for (const auto& entry : fs::directory_iterator(data_directory_)) {
+            std::string name = entry.path().filename().string();
+            if (name.size() == 20 && name.starts_with("segment_") && name.ends_with(".log")) {
+                segment_ids.push_back(static_cast<uint32_t>(std::stoul(name.substr(8, 8))));
+            }
+        }
+    } catch (const std::exception& e) {
+        utilities::log_error("Failed to list segments: " + std::string(e.what()));
+        return false;
+    }
+    std::sort(segment_ids.begin(), segment_ids.end());
+    record_count_ = 0;
+    bloom_watermark_ = 0;
+    unsaved_hashes_.clear();
+    heights_dirty_from_ = 0;
+    manifest_appendable_ = false;
+
+    if (segment_ids.empty()) {
+        // A filter or manifest left behind without its log describes other data
+        std::error_code error;
+        fs::remove(get_bloom_filename(), error);
+        fs::remove(get_manifest_filename(), error);
+        if (options_.bloom_filter) {
+            bloom_.emplace(options_.bloom_filter_capacity);
+        }
+        auto segment = create_segment(0, options_.segment_size);
+        if (!segment) {
+            return false;
+        }
+        segments_.push_back(std::move(*segment));
+        write_offset_ = SEGMENT_HEADER_SIZE;
+        checkpoint_segment_ = 0;
+        return true;
+    }
+
+    for (size_t i = 0; i < segment_ids.size(); ++i) {
+        if (i > 0 && segment_ids[i] != segment_ids[i - 1] + 1) {
+            utilities::log_error("Block log is missing segment " + std::to_string(segment_ids[i - 1] + 1));
+            return false;
+        }
+        if (!open_segment(segment_ids[i], i + 1 == segment_ids.size())) {
+            return false;
+        }
+    }
+    if (segments_.empty()) {
+        // Only an unfinished first segment was found; start the log over
+        return open_segments();
+    }
+
+    // Start from the checkpoint if there is a usable one, else from the beginning
+    size_t replay_from = 0;
+    uint64_t replay_offset = SEGMENT_HEADER_SIZE;
+    if (load_manifest(replay_from, replay_offset)) {
+        utilities::log_info("Loaded checkpoint with " + std::to_string(index_.size()) + " block(s).");
+    } else {
+        index_.clear();
+        heights_.clear();
+        tip_.reset();
+        record_count_ = 0;
+    }
+    if (options_.bloom_filter) {
+        load_bloom_filter();
+    }
+
+    uint64_t checkpoint_count = record_count_;
+    for (size_t i = replay_from; i < segments_.size(); ++i) {
+        bool torn = false;
+        uint64_t start_offset = i == replay_from ? replay_offset : SEGMENT_HEADER_SIZE;
+        if (!replay_segment(segments_[i], start_offset, torn)) {
+            utilities::log_error("Failed to replay segment " + std::to_string(segments_[i].id));
+            return false;
+        }
+        if (!torn) {
+            continue;
+        }
+        if (i + 1 < segments_.size()) {
+            // A crash only ever tears the newest segment; anything else is corruption
+            utilities::log_error("Segment " + std::to_string(segments_[i].id) +
+                                 " is corrupt before the end of the block log.");
+            return false;
+        }
+        utilities::log_info("Discarding uncommitted tail of segment " + std::to_string(segments_[i].id) +
+                            " at offset " + std::to_string(write_offset_));
+        if (!discard_tail(segments_[i], write_offset_)) {
+            return false;
+        }
+    }
+    checkpoint_segment_ = replay_from < segments_.size() ? segments_[replay_from].id : segments_.back().id;
+
+    if (bloom_ && (bloom_watermark_ < checkpoint_count || bloom_watermark_ > record_count_ ||
+                   bloom_->size() >= bloom_->capacity())) {
+        // The saved filter misses checkpointed blocks, is ahead of the log, or is full
+        rebuild_bloom_filter(std::max(options_.bloom_filter_capacity, index_.size() * 2));
+    }
+    if (record_count_ > checkpoint_count) {
+        utilities::log_info("Replayed " + std::to_string(record_count_ - checkpoint_count) +
+                            " record(s) written after the checkpoint.");
+        // Checkpoint right away so the next start does not replay them again
+        if (!write_manifest(false)) {
+            utilities::log_error("Failed to write block log manifest.");
+        }
+    }
+    return true;
+}
+
+template <typename BlockType>
+bool SegmentStorage<BlockType>::open_segment(uint32_t segment_id, bool last) {
+    std::string filename = get_segment_filename(segment_id);
+    int fd = ::open(filename.c_str(), O_RDWR);
+    if (fd < 0) {
+        utilities::log_error("Failed to open segment: " + filename);
+        return false;
+    }
+
+    struct stat file_stat;
+    byte header[SEGMENT_HEADER_SIZE];
+    uint32_t magic = 0;
+    uint32_t version = 0;
+    if (::fstat(fd, &file_stat) != 0 || !segment_io::read_fully(fd, header, sizeof(header), 0)) {
+        std::memset(header, 0, sizeof(header)); // Handled as an unfinished segment below
+    }
+    std::memcpy(&magic, header, sizeof(uint32_t));
+    std::memcpy(&version, header + 4, sizeof(uint32_t));
+    if (magic == 0 && last) {
+        // Crashed while rolling over: the segment never got its header, so
+        // it cannot hold a committed record
+        ::close(fd);
+        utilities::log_info("Removing unfinished segment: " + filename);
+        std::error_code error;
+        fs::remove(filename, error);
+        return !error;
+    }
+    if (magic != SEGMENT_MAGIC || version != SEGMENT_VERSION) {
+        utilities::log_error("Unrecognized segment format: " + filename);
+        ::close(fd);
+        return false;
+    }
+
+    segments_.push_back(Segment{segment_id, fd, static_cast<uint64_t>(file_stat.st_size), nullptr});
+    return map_segment(segments_.back());
+}
+
+template <typename BlockType>
+std::optional<typename SegmentStorage<BlockType>::Segment> SegmentStorage<BlockType>::create_segment(uint32_t segment_id,
+                                                                                                  uint64_t capacity) {
+    // The caller publishes the segment into segments_ under the right lock
+    std::string filename = get_segment_filename(segment_id);
+    int fd = ::open(filename.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        utilities::log_error("Failed to create segment: " + filename);
+        return std::nullopt;
+    }
+    if (!segment_io::preallocate(fd, capacity)) {
+        utilities::log_error("Failed to preallocate segment: " + filename);
+        ::close(fd);
+        return std::nullopt;
+    }
+
+    byte header[SEGMENT_HEADER_SIZE];
+    uint64_t id = segment_id;
+    std::memcpy(header, &SEGMENT_MAGIC, sizeof(uint32_t));
+    std::memcpy(header + 4, &SEGMENT_VERSION, sizeof(uint32_t));
+    std::memcpy(header + 8, &id, sizeof(uint64_t));
+    if (!segment_io::write_fully(fd, header, sizeof(header), 0)) {
+        utilities::log_error("Failed to write segment header: " + filename);
+        ::close(fd);
+        return std::nullopt;
+    }
+
+    Segment segment{segment_id, fd, capacity, nullptr};
+    if (!map_segment(segment)) {
+        ::close(fd);
+        return std::nullopt;
+    }
+    if (options_.sync_writes && !segment_io::sync_directory(data_directory_)) {
+        utilities::log_error("Failed to sync storage directory: " + data_directory_);
+        ::close(fd);
+        return std::nullopt;
+    }
+    utilities::log_info("Created segment: " + filename);
+    return segment;
+}
+
+template <typename BlockType>
+SegmentStorage<BlockType>::Mapping::~Mapping() {
+    if (data) {
+        ::munmap(const_cast<byte*>(data), size);
+    }
+}
+
+template <typename BlockType>
+bool SegmentStorage<BlockType>::map_segment(Segment& segment) {
+    if (!options_.memory_map) {
+        return true;
+    }
+    // MAP_SHARED keeps the mapping coherent with later pwrite appends
+    void* address = ::mmap(nullptr, segment.capacity, PROT_READ, MAP_SHARED, segment.fd, 0);
+    if (address == MAP_FAILED) {
+        utilities::log_error("Failed to map segment " + std::to_string(segment.id));
+        return false;
+    }
+    auto mapping = std::make_shared<Mapping>();
+    mapping->data = static_cast<const byte*>(address);
+    mapping->size = segment.capacity;
+    segment.mapping = std::move(mapping);
+    return true;
+}
+
+template <typename BlockType>
+const typename SegmentStorage<BlockType>::Segment* SegmentStorage<BlockType>::find_segment(uint32_t segment_id) const {
+    // Segment ids are consecutive, so the id doubles as a position
+    if (segments_.empty() || segment_id < segments_.front().id) {
+        return nullptr;
+    }
+    size_t position = segment_id - segments_.front().id;
+    return position < segments_.size() ? &segments_[position] : nullptr;
+}
+
+template <typename BlockType>
+bool SegmentStorage<BlockType>::replay_segment(const Segment& segment, uint64_t start_offset, bool& torn) {
+    // Hands out pointers into the mapping, or into a chunk read with pread
+    constexpr size_t SCAN_CHUNK_SIZE = 1 << 20;
+    bytes chunk;
+    uint64_t chunk_start = 0;
+    auto view = [&](uint64_t offset, size_t size) -> const byte* {
+        if (segment.mapping) {
+            return segment.mapping->data + offset;
+        }
+        if (offset < chunk_start || offset + size > chunk_start + chunk.size()) {
+            chunk.resize(static_cast<size_t>(std::min<uint64_t>(std::max(SCAN_CHUNK_SIZE, size), segment.capacity - offset)));
+            if (!segment_io::read_fully(segment.fd, chunk.data(), chunk.size(), offset)) {
+                chunk.clear();
+                return nullptr;
+            }
+            chunk_start = offset;
+        }
+        return chunk.data() + (offset - chunk_start);
+    };
+
+    // Records only count once the marker closing their commit checks out
+    struct PendingRecord {
+        Hash hash;
+        Hash previous_hash;
+        RecordLocation location;
+    };
+    std::vector<PendingRecord> pending;
+    uint64_t offset = start_offset;
+    uint64_t batch_start = start_offset;
+    uint32_t record_checksums = 0;
+    uint32_t magic = 0;
+    torn = false;
+
+    while (offset + sizeof(uint32_t) <= segment.capacity) {
+        const byte* header = view(offset, sizeof(uint32_t));
+        if (!header) {
+            return false;
+        }
+        std::memcpy(&magic, header, sizeof(uint32_t));
+
+        if (magic == RECORD_MAGIC) {
+            if (offset + RECORD_HEADER_SIZE > segment.capacity || !(header = view(offset, RECORD_HEADER_SIZE))) {
+                break;
+            }
+            PendingRecord record;
+            uint32_t payload_size = 0;
+            uint64_t height = NO_HEIGHT;
+            std::memcpy(&payload_size, header + 4, sizeof(uint32_t));
+            std::memcpy(&height, header + 8, sizeof(uint64_t));
+            std::memcpy(record.hash.data(), header + RECORD_HASH_OFFSET, HASH_SIZE);
+            std::memcpy(record.previous_hash.data(), header + RECORD_PREVIOUS_HASH_OFFSET, HASH_SIZE);
+            uint64_t payload_offset = offset + RECORD_HEADER_SIZE;
+            if (payload_offset + payload_size > segment.capacity) {
+                break;
+            }
+            const byte* record_bytes = view(offset, RECORD_HEADER_SIZE + payload_size);
+            uint32_t stored_checksum = 0;
+            if (!record_bytes) {
+                break;
+            }
+            std::memcpy(&stored_checksum, record_bytes + RECORD_CHECKSUM_OFFSET, sizeof(uint32_t));
+            if (stored_checksum != record_checksum(record_bytes, payload_size)) {
+                break;
+            }
+            record_checksums = crc32c::extend(
+                record_checksums, std::span<const byte>(record_bytes + RECORD_CHECKSUM_OFFSET, sizeof(uint32_t)));
+            record.location = RecordLocation{segment.id, payload_offset, payload_size, height};
+            pending.push_back(record);
+            offset = payload_offset + payload_size;
+            continue;
+        }
+
+        if (magic != COMMIT_MAGIC || offset + COMMIT_MARKER_SIZE > segment.capacity ||
+            !(header = view(offset, COMMIT_MARKER_SIZE))) {
+            break;
+        }
+        uint32_t stored_checksum = 0;
+        uint64_t marker_batch_start = 0;
+        uint64_t record_count = 0;
+        RecordLocation tip;
+        std::memcpy(&stored_checksum, header + 4, sizeof(uint32_t));
+        std::memcpy(&marker_batch_start, header + 8, sizeof(uint64_t));
+        std::memcpy(&record_count, header + 16, sizeof(uint64_t));
+        std::memcpy(&tip.segment, header + 24, sizeof(uint32_t));
+        std::memcpy(&tip.size, header + 28, sizeof(uint32_t));
+        std::memcpy(&tip.offset, header + 32, sizeof(uint64_t));
+        std::memcpy(&tip.height, header + 40, sizeof(uint64_t));
+        if (marker_batch_start != batch_start || record_count != record_count_ + pending.size()) {
+            break;
+        }
+
+        // The checksum covers the commit's record checksums followed by the rest of the marker
+        uint32_t checksum = crc32c::extend(record_checksums, std::span<const byte>(header + 8, COMMIT_MARKER_SIZE - 8));
+        if (checksum != stored_checksum) {
+            break;
+        }
+
+        for (const PendingRecord& record : pending) {
+            index_.insert_or_assign(record.hash, record.location);
+            unsaved_hashes_.push_back(record.hash);
+            if (bloom_ && record_count_ >= bloom_watermark_) {
+                bloom_->insert(record.hash);
+            }
+            ++record_count_;
+            extend_heights(record.location, record.previous_hash);
+        }
+        pending.clear();
+        // The journaled tip may be an older block that was stored again
+        if (!tip_ || tip.segment != tip_->segment || tip.offset != tip_->offset) {
+            if (auto previous_hash = read_previous_hash(tip)) {
+                extend_heights(tip, *previous_hash);
+            }
+        }
+        tip_ = tip;
+        offset += COMMIT_MARKER_SIZE;
+        batch_start = offset;
+        record_checksums = 0;
+    }
+
+    // Anything after the last commit marker other than zero fill never committed
+    write_offset_ = batch_start;
+    torn = !pending.empty() || (offset + sizeof(uint32_t) <= segment.capacity && magic != 0);
+    return true;
+}
+
+template <typename BlockType>
+bool SegmentStorage<BlockType>::discard_tail(const Segment& segment, uint64_t offset) {
+    // Zero the uncommitted bytes so a later, shorter commit can never line
+    // up with a stale record and resurrect it
+#if defined(__linux__) && defined(FALLOC_FL_PUNCH_HOLE)
+    if (::fallocate(segment.fd, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE, static_cast<off_t>(offset),
+                    static_cast<off_t>(segment.capacity - offset)) == 0) {
+        return segment_io::sync(segment.fd);
+    }
+#endif
+    bytes zeros(std::min<uint64_t>(1 << 20, segment.capacity - offset));
+    for (uint64_t position = offset; position < segment.capacity;) {
+        size_t length = static_cast<size_t>(std::min<uint64_t>(zeros.size(), segment.capacity - position));
+        if (!segment_io::write_fully(segment.fd, zeros.data(), length, position)) {
+            utilities::log_error("Failed to discard tail of segment " + std::to_string(segment.id));
+            return false;
+        }
+        position += length;
+    }
+    return segment_io::sync(segment.fd);
+}
+
+template <typename BlockType>
+bool SegmentStorage<BlockType>::write_manifest(bool full) {
+    // The checkpoint may only describe data that is on disk
+    for (const Segment& segment : segments_) {
+        if (segment.id >= checkpoint_segment_ && !segment_io::sync(segment.fd)) {
+            utilities::log_error("Failed to sync segment " + std::to_string(segment.id));
+            return false;
+        }
+    }
+
+    // A rollover only appends what changed since the previous checkpoint,
+    // so its cost follows the segment rather than the chain. The file is
+    // rewritten once the appended chunks outgrow the last full write.
+    full = full || !manifest_appendable_ || manifest_delta_size_ >= manifest_full_size_;
+
+    bytes chunk(MANIFEST_CHUNK_HEADER_SIZE);
+    auto put = [&chunk](const auto& value) {
+        const byte* data = reinterpret_cast<const byte*>(&value);
+        chunk.insert(chunk.end(), data, data + sizeof(value));
+    };
+    auto put_location = [&put](const RecordLocation& location) {
+        put(location.segment);
+        put(location.size);
+        put(location.offset);
+        put(location.height);
+    };
+    auto put_entry = [&](const Hash& block_hash, const RecordLocation& location) {
+        chunk.insert(chunk.end(), block_hash.begin(), block_hash.end());
+        put_location(location);
+    };
+
+    put(segments_.back().id);
+    put(uint32_t(0));
+    put(write_offset_);
+    put(record_count_);
+    put(uint64_t(tip_ ? 1 : 0));
+    put_location(tip_.value_or(RecordLocation{}));
+    if (full) {
+        put(static_cast<uint64_t>(index_.size()));
+        index_.for_each(put_entry);
+    } else {
+        put(static_cast<uint64_t>(unsaved_hashes_.size()));
+        for (const Hash& block_hash : unsaved_hashes_) {
+            put_entry(block_hash, *index_.find(block_hash));
+        }
+    }
+    // The heights vector is sent from the lowest entry that changed
+    size_t heights_from = full ? 0 : std::min(heights_dirty_from_, heights_.size());
+    put(static_cast<uint64_t>(heights_.size()));
+    put(static_cast<uint64_t>(heights_from));
+    for (size_t height = heights_from; height < heights_.size(); ++height) {
+        put_location(heights_[height]);
+    }
+
+    uint64_t body_size = chunk.size() - MANIFEST_CHUNK_HEADER_SIZE;
+    std::memcpy(chunk.data(), &MANIFEST_MAGIC, sizeof(uint32_t));
+    std::memcpy(chunk.data() + 4, &MANIFEST_VERSION, sizeof(uint32_t));
+    std::memset(chunk.data() + 12, 0, sizeof(uint32_t));
+    std::memcpy(chunk.data() + 16, &body_size, sizeof(uint64_t));
+    uint32_t checksum = crc32c::compute(std::span<const byte>(chunk).subspan(16));
+    std::memcpy(chunk.data() + 8, &checksum, sizeof(uint32_t));
+
+    std::string filename = get_manifest_filename();
+    if (full) {
+        // Replace the previous manifest atomically
+        std::string temp_filename = filename + ".tmp";
+        int fd = ::open(temp_filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) {
+            manifest_appendable_ = false;
+            return false;
+        }
+        bool written = segment_io::write_fully(fd, chunk.data(), chunk.size(), 0) && segment_io::sync(fd);
+        ::close(fd);
+        if (!written || std::rename(temp_filename.c_str(), filename.c_str()) != 0 ||
+            !segment_io::sync_directory(data_directory_)) {
+            manifest_appendable_ = false;
+            return false;
+        }
+        manifest_full_size_ = chunk.size();
+        manifest_delta_size_ = 0;
+    } else {
+        // A torn append fails its checksum and is ignored on load, leaving
+        // the previous checkpoint in effect
+        int fd = ::open(filename.c_str(), O_WRONLY);
+        struct stat file_stat;
+        bool written = fd >= 0 && ::fstat(fd, &file_stat) == 0 &&
+                       segment_io::write_fully(fd, chunk.data(), chunk.size(), static_cast<uint64_t>(file_stat.st_size)) &&
+                       segment_io::sync(fd);
+        if (fd >= 0) {
+            ::close(fd);
+        }
+        if (!written) {
+            manifest_appendable_ = false;
+            return false;
+        }
+        manifest_delta_size_ += chunk.size();
+    }
+    manifest_appendable_ = true;
+    unsaved_hashes_.clear();
+    heights_dirty_from_ = heights_.size();
+    checkpoint_segment_ = segments_.back().id;
+    return true;
+}
+
+template <typename BlockType>
+bool SegmentStorage<BlockType>::load_manifest(size_t& replay_segment, uint64_t& replay_offset) {
+    std::ifstream file(get_manifest_filename(), std::ios::binary);
+    if (!file) {
+        return false;
+    }
+    bytes manifest((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    size_t position = 0;
+    auto get = [&](auto& value) {
+        if (position + sizeof(value) > manifest.size()) {
+            return false;
+        }
+        std::memcpy(&value, manifest.data() + position, sizeof(value));
+        position += sizeof(value);
+        return true;
+    };
+    auto get_location = [&](RecordLocation& location) {
+        return get(location.segment) && get(location.size) && get(location.offset) && get(location.height);
+    };
+
+    // The first chunk is a full checkpoint and each later one applies the
+    // changes up to the next; a damaged chunk ends the manifest, as only the
+    // last append can be torn by a crash
+    uint32_t segment_id = 0;
+    uint64_t has_tip = 0;
+    RecordLocation tip;
+    size_t chunk_count = 0;
+    index_.clear();
+    heights_.clear();
+    while (position < manifest.size()) {
+        uint32_t magic = 0;
+        uint32_t version = 0;
+        uint32_t checksum = 0;
+        uint32_t reserved = 0;
+        uint64_t body_size = 0;
+        size_t chunk_start = position;
+        if (!get(magic) || !get(version) || !get(checksum) || !get(reserved) || !get(body_size) ||
+            magic != MANIFEST_MAGIC || version != MANIFEST_VERSION || body_size > manifest.size() - position ||
+            checksum != crc32c::compute(std::span<const byte>(manifest).subspan(chunk_start + 16, 8 + body_size))) {
+            utilities::log_error(chunk_count == 0 ? "Ignoring damaged block log manifest."
+                                                  : "Ignoring damaged tail of block log manifest.");
+            break;
+        }
+        size_t chunk_end = position + static_cast<size_t>(body_size);
+
+        uint64_t entry_count = 0;
+        if (!get(segment_id) || !get(reserved) || !get(replay_offset) || !get(record_count_) || !get(has_tip) ||
+            !get_location(tip) || !get(entry_count) || entry_count > body_size / (HASH_SIZE + 24)) {
+            return false;
+        }
+        index_.reserve(index_.size() + static_cast<size_t>(entry_count));
+        for (uint64_t i = 0; i < entry_count; ++i) {
+            Hash block_hash;
+            RecordLocation location;
+            if (position + HASH_SIZE > chunk_end) {
+                return false;
+            }
+            std::memcpy(block_hash.data(), manifest.data() + position, HASH_SIZE);
+            position += HASH_SIZE;
+            if (!get_location(location)) {
+                return false;
+            }
+            index_.insert_or_assign(block_hash, location);
+        }
+
+        uint64_t height_count = 0;
+        uint64_t heights_from = 0;
+        if (!get(height_count) || !get(heights_from) || heights_from > height_count ||
+            heights_from > heights_.size() || height_count - heights_from > body_size / 24) {
+            return false;
+        }
+        heights_.resize(static_cast<size_t>(height_count));
+        for (uint64_t height = heights_from; height < height_count; ++height) {
+            if (!get_location(heights_[height])) {
+                return false;
+            }
+        }
+        if (position != chunk_end) {
+            return false;
+        }
+        ++chunk_count;
+    }
+    if (chunk_count == 0) {
+        return false;
+    }
+
+    // The checkpoint must sit at a commit boundary of this very log
+    const Segment* segment = find_segment(segment_id);
+    if (!segment || replay_offset < SEGMENT_HEADER_SIZE || replay_offset > segment->capacity) {
+        return false;
+    }
+    if (replay_offset > SEGMENT_HEADER_SIZE) {
+        byte marker[COMMIT_MARKER_SIZE];
+        uint32_t marker_magic = 0;
+        uint64_t marker_count = 0;
+        if (replay_offset < SEGMENT_HEADER_SIZE + COMMIT_MARKER_SIZE ||
+            !segment_io::read_fully(segment->fd, marker, sizeof(marker), replay_offset - COMMIT_MARKER_SIZE)) {
+            return false;
+        }
+        std::memcpy(&marker_magic, marker, sizeof(uint32_t));
+        std::memcpy(&marker_count, marker + 16, sizeof(uint64_t));
+        if (marker_magic != COMMIT_MAGIC || marker_count != record_count_) {
+            utilities::log_error("Block log manifest does not match the log; replaying the whole log.");
+            return false;
+        }
+    }
+
+    tip_ = has_tip ? std::optional<RecordLocation>(tip) : std::nullopt;
+    replay_segment = static_cast<size_t>(segment - segments_.data());
+    // Appending after a damaged chunk would hide the new chunks behind it
+    manifest_appendable_ = position == manifest.size();
+    manifest_full_size_ = manifest.size();
+    manifest_delta_size_ = 0;
+    heights_dirty_from_ = heights_.size();
+    return true;
+}
+
+template <typename BlockType>
+std::string SegmentStorage<BlockType>::get_manifest_filename() const {
+    return data_directory_ + "/MANIFEST";
+}
+
+template <typename BlockType>
+const typename SegmentStorage<BlockType>::RecordLocation* SegmentStorage<BlockType>::find_location(
+    const Hash& block_hash) const {
+    // Most lookups for absent blocks stop at the filter
+    if (bloom_ && !bloom_->may_contain(block_hash)) {
+        return nullptr;
+    }
+    return index_.find(block_hash);
+}
+
+template <typename BlockType>
+void SegmentStorage<BlockType>::load_bloom_filter() {
+    auto filter = BloomFilter::load(get_bloom_filename(), bloom_watermark_);
+    if (filter) {
+        bloom_ = std::move(*filter);
+        utilities::log_info("Loaded Bloom filter covering " + std::to_string(bloom_watermark_) + " record(s).");
+    } else {
+        std::error_code error;
+        if (fs::exists(get_bloom_filename(), error)) {
+            utilities::log_error("Bloom filter " + get_bloom_filename() + " is corrupt; rebuilding it from the index.");
+        }
+        // With a zero watermark every indexed block goes back in, through
+        // replay or the rebuild in initialize()
+        bloom_.emplace(options_.bloom_filter_capacity);
+        bloom_watermark_ = 0;
+    }
+}
+
+template <typename BlockType>
+void SegmentStorage<BlockType>::rebuild_bloom_filter(size_t capacity) {
+    BloomFilter filter(capacity);
+    index_.for_each([&filter](const Hash& block_hash, const RecordLocation&) { filter.insert(block_hash); });
+    bloom_ = std::move(filter);
+    utilities::log_info("Rebuilt Bloom filter for " + std::to_string(capacity) + " block(s).");
+}
+
+template <typename BlockType>
+std::string SegmentStorage<BlockType>::get_bloom_filename() const {
+    return data_directory_ + "/blocks.bloom";
+}
+
+template <typename BlockType>
+bool SegmentStorage<BlockType>::commit(const std::vector<CommitRequest*>& requests) {
+    if (segments_.empty()) {
+        utilities::log_error("Block log is not initialized.");
+        return false;
+    }
+    if (write_failed_) {
+        utilities::log_error("Block log stopped accepting writes after a failed append; reopen it to recover.");
+        return false;
+    }
+
+    // Reject the whole batch before anything is framed, so a block that can
+    // never be stored does not leave part of the batch on disk
+    std::vector<size_t> payload_sizes;
+    for (CommitRequest* request : requests) {
+        for (const BlockType& block : request->blocks) {
+            size_t payload_size = block.serialized_size(options_.format);
+            if (payload_size > UINT32_MAX) {
+                utilities::log_error("Block too large for block log: " + std::to_string(payload_size) + " bytes.");
+                return false;
+            }
+            payload_sizes.push_back(payload_size);
+        }
+    }
+
+    // Records bound for the same segment are framed into one buffer and
+    // written together, closed by a commit marker; a roll over flushes what
+    // has been framed so far as a commit of its own
+    bytes buffer;
+    uint64_t buffer_offset = write_offset_;
+    std::unordered_map<Hash, RecordLocation, HashHasher> committed;
+    std::optional<RecordLocation> new_tip;
+    size_t block_count = 0;
+    size_t stored_count = 0;
+    uint32_t record_checksums = 0;
+    bool tip_moved = false;
+    bool rolled_over = false;
+
+    // Every stored block becomes the tip in turn; replayed onto heights_ in order
+    std::vector<std::pair<RecordLocation, Hash>> tip_changes;
+
+    // Each flushed commit is published as soon as it is on disk. A later
+    // failure in the same call then cannot leave the index, heights and
+    // record count behind the markers already in the log.
+    auto publish = [&]() {
+        std::unique_lock<InstrumentedSharedMutex> lock(index_mutex_);
+        for (const auto& [block_hash, location] : committed) {
+            index_.insert_or_assign(block_hash, location);
+            unsaved_hashes_.push_back(block_hash);
+            if (bloom_) {
+                bloom_->insert(block_hash);
+            }
+        }
+        record_count_ += block_count;
+        for (const auto& [location, previous_hash] : tip_changes) {
+            extend_heights(location, previous_hash);
+        }
+        tip_ = new_tip;
+        if (bloom_ && bloom_->size() >= bloom_->capacity()) {
+            rebuild_bloom_filter(bloom_->capacity() * 2);
+        }
+        committed.clear();
+        tip_changes.clear();
+        stored_count += block_count;
+        block_count = 0;
+    };
+
+    auto flush = [&]() {
+        if (!tip_moved) {
+            return true;
+        }
+        frame_commit_marker(buffer, buffer_offset, record_count_ + block_count, *new_tip, record_checksums);
+        write_offset_ += COMMIT_MARKER_SIZE;
+        // The append and its durability barrier are submitted together
+        int fd = segments_.back().fd;
+        IoUring::Operation io[] = {{IoUring::Opcode::write, fd, buffer.data(), buffer.size(), buffer_offset},
+                                   {IoUring::Opcode::sync, fd}};
+        if (!segment_io::execute(write_ring_.get(), std::span(io, options_.sync_writes ? 2 : 1))) {
+            // Part of the commit, its marker included, may have reached the
+            // disk. Stop writing rather than guess; reopening replays the log
+            // and keeps the commit only if its marker checks out.
+            write_offset_ = buffer_offset;
+            write_failed_ = true;
+            utilities::log_error("Failed to append to segment " + std::to_string(segments_.back().id));
+            return false;
+        }
+        publish();
+        buffer.clear();
+        buffer_offset = write_offset_;
+        record_checksums = 0;
+        tip_moved = false;
+        return true;
+    };
+
+    // Makes room for size more bytes plus the commit marker that must follow them
+    auto reserve = [&](uint64_t size) {
+        if (write_offset_ + size + COMMIT_MARKER_SIZE <= segments_.back().capacity) {
+            return true;
+        }
+        if (!flush()) {
+            return false;
+        }
+        // Oversized blocks get a segment of their own
+        uint64_t capacity =
+            std::max<uint64_t>(options_.segment_size, SEGMENT_HEADER_SIZE + size + COMMIT_MARKER_SIZE);
+        auto segment = create_segment(segments_.back().id + 1, capacity);
+        if (!segment) {
+            return false;
+        }
+        {
+            // Growing segments_ may move it under concurrent readers
+            std::unique_lock<InstrumentedSharedMutex> lock(index_mutex_);
+            segments_.push_back(std::move(*segment));
+        }
+        write_offset_ = SEGMENT_HEADER_SIZE;
+        buffer_offset = write_offset_;
+        rolled_over = true;
+        return true;
+    };
+
+    // Flushed commits are published, but the callers still see a failure
+    auto fail = [&]() {
+        if (stored_count > 0) {
+            utilities::log_error("Only the first " + std::to_string(stored_count) +
+                                 " block(s) of a failed commit were stored.");
+        }
+        return false;
+    };
+
+    size_t block_position = 0;
+    for (CommitRequest* request : requests) {
+        for (const BlockType& block : request->blocks) {
+            size_t payload_size = payload_sizes[block_position++];
+            const Hash& block_hash = block.get_hash();
+            const RecordLocation* existing = index_.find(block_hash);
+            auto pending = committed.find(block_hash);
+            if (existing || pending != committed.end()) {
+                // Already in the log; storing it again only moves the tip,
+                // which the commit marker journals
+                if (!reserve(0)) {
+                    return fail();
+                }
+                new_tip = existing ? *existing : pending->second;
+                tip_changes.emplace_back(*new_tip, block.get_previous_hash());
+                tip_moved = true;
+                continue;
+            }
+
+            // Only writers modify the index, so it can be read here without the index lock
+            const Hash& previous_hash = block.get_previous_hash();
+            auto pending_parent = committed.find(previous_hash);
+            const RecordLocation* parent =
+                pending_parent != committed.end() ? &pending_parent->second : index_.find(previous_hash);
+            uint64_t height = NO_HEIGHT;
+            if (parent) {
+                height = parent->height == NO_HEIGHT ? NO_HEIGHT : parent->height + 1;
+            } else if (previous_hash == Hash{} || (!tip_ && !new_tip)) {
+                height = 0; // Genesis, or the first block of a log that starts mid-chain
+            }
+
+            uint64_t record_size = RECORD_HEADER_SIZE + payload_size;
+            if (!reserve(record_size)) {
+                return fail();
+            }
+
+            uint32_t checksum = frame_record(buffer, block, height, payload_size);
+            record_checksums = crc32c::extend(
+                record_checksums, std::span<const byte>(reinterpret_cast<const byte*>(&checksum), sizeof(checksum)));
+            RecordLocation location{segments_.back().id, write_offset_ + RECORD_HEADER_SIZE,
+                                    static_cast<uint32_t>(payload_size), height};
+            write_offset_ += record_size;
+            committed[block_hash] = location;
+            new_tip = location;
+            tip_changes.emplace_back(location, previous_hash);
+            tip_moved = true;
+            ++block_count;
+        }
+    }
+
+    if (!flush()) {
+        return fail();
+    }
+    if (stored_count > 0) {
+        utilities::log_info("Committed " + std::to_string(stored_count) + " block(s) to segment " +
+                            std::to_string(segments_.back().id));
+    }
+    // A filled segment is a natural checkpoint: recovery then replays at most one segment
+    if (rolled_over && !write_manifest(false)) {
+        utilities::log_error("Failed to write block log manifest.");
+    }
+    return true;
+}
+
+template <typename BlockType>
+void SegmentStorage<BlockType>::frame_commit_marker(bytes& buffer, uint64_t batch_start, uint64_t record_count,
+                                                    const RecordLocation& tip, uint32_t record_checksums) {
+    // Chains the checksums of the records framed since the previous marker
+    // with the marker itself; each record checksum already covers its record
+    uint32_t checksum = record_checksums;
+    size_t start = buffer.size();
+    buffer.resize(start + COMMIT_MARKER_SIZE);
+    byte* marker = buffer.data() + start;
+    std::memcpy(marker, &COMMIT_MAGIC, sizeof(uint32_t));
+    std::memcpy(marker + 8, &batch_start, sizeof(uint64_t));
+    std::memcpy(marker + 16, &record_count, sizeof(uint64_t));
+    std::memcpy(marker + 24, &tip.segment, sizeof(uint32_t));
+    std::memcpy(marker + 28, &tip.size, sizeof(uint32_t));
+    std::memcpy(marker + 32, &tip.offset, sizeof(uint64_t));
+    std::memcpy(marker + 40, &tip.height, sizeof(uint64_t));
+    checksum = crc32c::extend(checksum, std::span<const byte>(marker + 8, COMMIT_MARKER_SIZE - 8));
+    std::memcpy(marker + 4, &checksum, sizeof(uint32_t));
+}
+
+template <typename BlockType>
+uint32_t SegmentStorage<BlockType>::frame_record(bytes& buffer, const BlockType& block, uint64_t height,
+                                                 size_t payload_size) {
+    // The block is serialized straight into the batch buffer behind its header
+    size_t start = buffer.size();
+    uint32_t record_payload_size = static_cast<uint32_t>(payload_size);
+    buffer.resize(start + RECORD_HEADER_SIZE + payload_size);
+    byte* record = buffer.data() + start;
+    std::memset(record, 0, RECORD_HEADER_SIZE);
+    std::memcpy(record, &RECORD_MAGIC, sizeof(uint32_t));
+    std::memcpy(record + 4, &record_payload_size, sizeof(uint32_t));
+    std::memcpy(record + 8, &height, sizeof(uint64_t));
+    std::memcpy(record + RECORD_HASH_OFFSET, block.get_hash().data(), HASH_SIZE);
+    std::memcpy(record + RECORD_PREVIOUS_HASH_OFFSET, block.get_previous_hash().data(), HASH_SIZE);
+    block.serialize_into(std::span<byte>(record + RECORD_HEADER_SIZE, payload_size), options_.format);
+    uint32_t checksum = record_checksum(record, payload_size);
+    std::memcpy(record + RECORD_CHECKSUM_OFFSET, &checksum, sizeof(uint32_t));
+    return checksum;
+}
+
+template <typename BlockType>
+uint32_t SegmentStorage<BlockType>::record_checksum(const byte* record, size_t payload_size) {
+    // Everything after the magic except the checksum field itself
+    uint32_t checksum = crc32c::compute(std::span<const byte>(record + 4, RECORD_CHECKSUM_OFFSET - 4));
+    size_t tail = RECORD_CHECKSUM_OFFSET + sizeof(uint32_t);
+    return crc32c::extend(checksum, std::span<const byte>(record + tail, RECORD_HEADER_SIZE - tail + payload_size));
+}
+
+template <typename BlockType>
+bool SegmentStorage<BlockType>::verify_record(const byte* record, const RecordLocation& location) const {
+    if (!options_.verify_checksums) {
+        return true;
+    }
+    uint32_t stored_checksum = 0;
+    std::memcpy(&stored_checksum, record + RECORD_CHECKSUM_OFFSET, sizeof(uint32_t));
+    if (stored_checksum != record_checksum(record, location.size)) {
+        utilities::log_error("Checksum mismatch for record at offset " + std::to_string(location.offset) +
+                             " of segment " + std::to_string(location.segment));
+        return false;
+    }
+    return true;
+}
+
+template <typename BlockType>
+void SegmentStorage<BlockType>::extend_heights(const RecordLocation& location, Hash previous_hash) {
+    if (location.height == NO_HEIGHT) {
+        return; // Orphan: not part of any chain the log can reach
+    }
+
+    // The new tip replaces whatever was at its height and above
+    uint64_t height = location.height;
+    heights_dirty_from_ = std::min({heights_dirty_from_, heights_.size(), static_cast<size_t>(height)});
+    heights_.resize(height + 1);
+    heights_[height] = location;
+
+    // Then the entries below must follow the tip's ancestry. On a linear
+    // chain the parent is already in place and this stops immediately; after
+    // a switch to another branch it rewrites heights back to the fork point.
+    while (height > 0) {
+        const RecordLocation* parent = index_.find(previous_hash);
+        if (!parent || parent->height != height - 1) {
+            break;
+        }
+        --height;
+        RecordLocation& entry = heights_[height];
+        if (entry.segment == parent->segment && entry.offset == parent->offset) {
+            break;
+        }
+        entry = *parent;
+        heights_dirty_from_ = std::min(heights_dirty_from_, static_cast<size_t>(height));
+        auto grandparent_hash = read_previous_hash(*parent);
+        if (!grandparent_hash) {
+            break;
+        }
+        previous_hash = *grandparent_hash;
+    }
+}
+
+template <typename BlockType>
+std::optional<Hash> SegmentStorage<BlockType>::read_previous_hash(const RecordLocation& location) const {
+    const Segment* segment = find_segment(location.segment);
+    if (!segment) {
+        return std::nullopt;
+    }
+    Hash previous_hash;
+    uint64_t offset = location.offset - RECORD_HEADER_SIZE + RECORD_PREVIOUS_HASH_OFFSET;
+    if (segment->mapping) {
+        std::memcpy(previous_hash.data(), segment->mapping->data + offset, HASH_SIZE);
+    } else if (!segment_io::read_fully(segment->fd, previous_hash.data(), HASH_SIZE, offset)) {
+        return std::nullopt;
+    }
+    return previous_hash;
+}
+
+template <typename BlockType>
+std::optional<BlockType> SegmentStorage<BlockType>::read_record(const RecordLocation& location) {
+    const Segment* segment = find_segment(location.segment);
+    if (!segment) {
+        utilities::log_error("Segment " + std::to_string(location.segment) + " is not open.");
+        return std::nullopt;
+    }
+
+    // Mapped records are checked and decoded straight from the page cache;
+    // otherwise the record is read together with its header
+    const byte* record;
+    bytes buffer;
+    if (segment->mapping) {
+        record = segment->mapping->data + location.offset - RECORD_HEADER_SIZE;
+    } else {
+        buffer.resize(RECORD_HEADER_SIZE + location.size);
+        IoUring::Operation read{IoUring::Opcode::read, segment->fd, buffer.data(), buffer.size(),
+                                location.offset - RECORD_HEADER_SIZE};
+        if (!read_segments(std::span(&read, 1))) {
+            utilities::log_error("Failed to read record from segment " + std::to_string(location.segment));
+            return std::nullopt;
+        }
+        record = buffer.data();
+    }
+    if (!verify_record(record, location)) {
+        return std::nullopt;
+    }
+
+    BlockType block;
+    if (!block.deserialize(std::span<const byte>(record + RECORD_HEADER_SIZE, location.size))) {
+        utilities::log_error("Failed to deserialize block from segment " + std::to_string(location.segment));
+        return std::nullopt;
+    }
+    return block;
+}
+
+template <typename BlockType>
+bool SegmentStorage<BlockType>::read_runs(const std::vector<std::span<const RecordLocation>>& runs,
+                                          std::vector<BlockType>& blocks) {
+    // Mapped segments are decoded in place; every other run is one read,
+    // and those reads are submitted together. A run starts at the header
+    // of its first record so every record's checksum can be verified.
+    std::vector<const byte*> run_data(runs.size());
+    std::vector<bytes> buffers(runs.size());
+    std::vector<IoUring::Operation> reads;
+    for (size_t i = 0; i < runs.size(); ++i) {
+        const RecordLocation& first = runs[i].front();
+        const Segment* segment = find_segment(first.segment);
+        if (!segment || first.height == NO_HEIGHT) {
+            utilities::log_error("Height index points outside the block log.");
+            return false;
+        }
+        uint64_t run_offset = first.offset - RECORD_HEADER_SIZE;
+        if (segment->mapping) {
+            run_data[i] = segment->mapping->data + run_offset;
+            continue;
+        }
+        const RecordLocation& last = runs[i].back();
+        buffers[i].resize(last.offset + last.size - run_offset);
+        reads.push_back({IoUring::Opcode::read, segment->fd, buffers[i].data(), buffers[i].size(), run_offset});
+        run_data[i] = buffers[i].data();
+    }
+    if (!reads.empty() && !read_segments(reads)) {
+        utilities::log_error("Failed to read records from the block log.");
+        return false;
+    }
+
+    for (size_t i = 0; i < runs.size(); ++i) {
+        uint64_t run_offset = runs[i].front().offset - RECORD_HEADER_SIZE;
+        for (const RecordLocation& location : runs[i]) {
+            const byte* record = run_data[i] + (location.offset - RECORD_HEADER_SIZE - run_offset);
+            if (!verify_record(record, location)) {
+                return false;
+            }
+            BlockType block;
+            if (!block.deserialize(std::span<const byte>(record + RECORD_HEADER_SIZE, location.size))) {
+                utilities::log_error("Failed to deserialize block from segment " + std::to_string(location.segment));
+                return false;
+            }
+            blocks.push_back(std::move(block));
+        }
+    }
+    return true;
+}
+
+template <typename BlockType>
+bool SegmentStorage<BlockType>::read_segments(std::span<const IoUring::Operation> reads) {
+    if (!write_ring_) {
+        return segment_io::execute(nullptr, reads);
+    }
+    // Rings are not thread-safe, so concurrent readers each borrow one
+    std::unique_ptr<IoUring> ring;
+    {
+        std::lock_guard<std::mutex> rings_lock(read_rings_mutex_);
+        if (!read_rings_.empty()) {
+            ring = std::move(read_rings_.back());
+            read_rings_.pop_back();
+        }
+    }
+    if (!ring) {
+        ring = IoUring::create();
+    }
+    bool read = segment_io::execute(ring.get(), reads);
+    // A ring that saw a failure is not lent out again, and a burst of
+    // readers does not leave more idle rings behind than the pool holds
+    if (ring && read) {
+        std::lock_guard<std::mutex> rings_lock(read_rings_mutex_);
+        if (read_rings_.size() < MAX_IDLE_READ_RINGS) {
+            read_rings_.push_back(std::move(ring));
+        }
+    }
+    return read;
+}
+
+template <typename BlockType>
+void SegmentStorage<BlockType>::close_segments() {
+    for (Segment& segment : segments_) {
+        if (segment.fd >= 0) {
+            ::close(segment.fd);
+            segment.fd = -1;
+        }
+    }
+    segments_.clear();
+    index_.clear();
+    tip_.reset();
+    heights_.clear();
+    bloom_.reset();
+    record_count_ = 0;
+    bloom_watermark_ = 0;
+    write_offset_ = 0;
+}
+
+#endif // SEGMENT_STORAGE_TPP
@@ -4,7 +4,12 @@
 #include <string>
 #include <vector>
 #include <optional>
+#include <span>
+#include <future>
+#include <functional>
 #include "../common/types.hpp"
+#include "block_view.hpp"
+#include "instrumented_mutex.hpp"
 
 template <typename BlockType>
 class StorageInterface
@@ -18,17 +23,95 @@ public:
   // Stores a block
   virtual bool store_block(const BlockType &block) = 0;
 
+  // Stores several blocks in order, the last one becoming the latest block.
+  // Backends that can commit a batch with fewer writes override this.
+  virtual bool store_blocks(std::span<const BlockType> blocks)
+  {
+    for (const auto &block : blocks)
+    {
+      if (!store_block(block))
+      {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // Hands a block to the storage and returns a future that becomes true once
+  // it has been stored (durably, if the backend syncs its writes) or false if
+  // storing failed. The default implementation stores synchronously; the
+  // asynchronous writer overrides it so callers can move on immediately.
+  virtual std::future<bool> store_block_async(const BlockType &block)
+  {
+    std::promise<bool> stored;
+    stored.set_value(store_block(block));
+    return stored.get_future();
+  }
+
+  // Hands a block to the storage and calls on_stored with the result once
+  // the write completes, so callers act on a stored block without waiting
+  // for it. The default implementation stores synchronously and calls
+  // on_stored before returning; the asynchronous writer calls it from its
+  // writer thread.
+  virtual void store_block_async(const BlockType &block, std::function<void(bool)> on_stored)
+  {
+    on_stored(store_block(block));
+  }
+
   // Retrieves a block by its hash
   virtual std::optional<BlockType> get_block(const Hash &block_hash) = 0;
 
+  // Retrieves a read-only view of a stored block's serialized bytes.
+  // The default implementation decodes the block and re-serializes it;
+  // backends that can hand out their stored bytes directly override it.
+  virtual std::optional<BlockView<BlockType>> get_block_view(const Hash &block_hash)
+  {
+    auto block_opt = get_block(block_hash);
+    if (!block_opt)
+    {
+      return std::nullopt;
+    }
+    return BlockView<BlockType>::from_bytes(block_opt->serialize());
+  }
+
   // Retrieves the latest block
   virtual std::optional<BlockType> get_latest_block() = 0;
 
   // Checks if a block exists
   virtual bool block_exists(const Hash &block_hash) = 0;
 
+  // Retrieves the block at the given height of the stored chain, the first
+  // block being height 0. Backends without a height index return nullopt.
+  virtual std::optional<BlockType> get_block_by_height(uint64_t height)
+  {
+    return std::nullopt;
+  }
+
+  // Height of the latest block, or nullopt if the chain is empty or the
+  // backend keeps no height index
+  virtual std::optional<uint64_t> get_latest_height()
+  {
+    return std::nullopt;
+  }
+
+  // Streams the blocks from from_height to to_height (inclusive) in height
+  // order, reading the log sequentially where the backend can. The visitor
+  // returns false to stop early. Returns the number of blocks visited.
+  virtual size_t scan(uint64_t from_height, uint64_t to_height,
+                      const std::function<bool(const BlockType &)> &visitor)
+  {
+    return 0;
+  }
+
   // Closes the storage system
   virtual void close() = 0;
+
+  // Time spent waiting on the backend's internal locks; backends without
+  // instrumented locking report zeros
+  virtual LockStats get_lock_stats()
+  {
+    return LockStats();
+  }
 };
 
 #endif // STORAGE_INTERFACE_HPP
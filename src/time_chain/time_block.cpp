@@ -7,7 +7,6 @@ TimeBlock::TimeBlock(const Hash &previous_hash, TimePoint time, const PublicKey
     : previous_hash_(previous_hash), time_(time), public_key_(public_key)
 {
   signature_.fill(0);
-  compute_hash();
 }
 
 TimeBlock::TimeBlock() : time_(0)
@@ -40,73 +39,72 @@ const Signature &TimeBlock::get_signature() const
 
 const Hash &TimeBlock::get_hash() const
 {
+  if (!hash_valid_)
+  {
+    std::array<byte, Schema::offset<Schema::HASHED_COUNT>()> preimage;
+    Schema::write<Schema::HASHED_COUNT>(preimage.data(), *this);
+    hash_ = cryptography::sha256(preimage);
+    hash_valid_ = true;
+  }
   return hash_;
 }
 
 void TimeBlock::set_signature(const Signature &signature)
 {
   signature_ = signature;
-  compute_hash();
+  hash_valid_ = false;
 }
 
 // time_block.cpp
 
-bytes TimeBlock::serialize() const
+bytes TimeBlock::serialize(serialization::Format format) const
 {
-  bytes data;
-  data.insert(data.end(), previous_hash_.begin(), previous_hash_.end());
+  bytes data(serialized_size(format));
+  serialize_into(data, format);
+  return data;
+}
 
-  bytes time_bytes(reinterpret_cast<const byte *>(&time_), reinterpret_cast<const byte *>(&time_) + sizeof(TimePoint));
-  data.insert(data.end(), time_bytes.begin(), time_bytes.end());
+size_t TimeBlock::serialized_size(serialization::Format format) const
+{
+  return format == serialization::Format::v1 ? SERIALIZED_SIZE : Schema::encoded_size(*this, format);
+}
 
-  data.insert(data.end(), public_key_.begin(), public_key_.end());
-  data.insert(data.end(), signature_.begin(), signature_.end());
-  data.insert(data.end(), hash_.begin(), hash_.end());
-  return data;
+bool TimeBlock::serialize_into(std::span<byte> out, serialization::Format format) const
+{
+  if (out.size() < serialized_size(format))
+  {
+    utilities::log_error("Buffer of " + std::to_string(out.size()) + " bytes too small for TimeBlock.");
+    return false;
+  }
+  get_hash();
+  Schema::encode(out.data(), *this, format);
+  return true;
 }
 
-bool TimeBlock::deserialize(const bytes &data)
+bool TimeBlock::deserialize(std::span<const byte> data)
 {
-  size_t expected_size = previous_hash_.size() + sizeof(TimePoint) + public_key_.size() + signature_.size() + hash_.size();
-  if (data.size() != expected_size)
+  TimeBlock block;
+  if (!Schema::decode(data, block))
   {
     utilities::log_error("Data size mismatch during deserialization.");
     return false;
   }
-  auto it = data.begin();
-
-  std::copy(it, it + previous_hash_.size(), previous_hash_.begin());
-  it += previous_hash_.size();
-
-  std::memcpy(&time_, &(*it), sizeof(TimePoint));
-  it += sizeof(TimePoint);
-
-  std::copy(it, it + public_key_.size(), public_key_.begin());
-  it += public_key_.size();
-
-  std::copy(it, it + signature_.size(), signature_.begin());
-  it += signature_.size();
-
-  std::copy(it, it + hash_.size(), hash_.begin());
+  // Keep the hash the block was stored with
+  block.hash_valid_ = true;
+  *this = block;
   utilities::log_info("TimeBlock deserialized successfully.");
   return true;
 }
 
 bytes TimeBlock::get_data_to_sign() const
 {
-  bytes data;
-  data.insert(data.end(), previous_hash_.begin(), previous_hash_.end());
-
-  bytes time_bytes(reinterpret_cast<const byte *>(&time_), reinterpret_cast<const byte *>(&time_) + sizeof(TimePoint));
-  data.insert(data.end(), time_bytes.begin(), time_bytes.end());
-
-  data.insert(data.end(), public_key_.begin(), public_key_.end());
+  bytes data(Schema::offset<Schema::SIGNED_COUNT>());
+  Schema::write<Schema::SIGNED_COUNT>(data.data(), *this);
   return data;
 }
 
 void TimeBlock::compute_hash()
 {
-  bytes data = get_data_to_sign();
-  data.insert(data.end(), signature_.begin(), signature_.end());
-  hash_ = cryptography::sha256(data);
+  hash_valid_ = false;
+  get_hash();
 }
@@ -1,9 +1,13 @@
 #ifndef TIME_BLOCK_HPP
 #define TIME_BLOCK_HPP
 
+#include "../common/schema.hpp"
 #include "../common/types.hpp"
 #include "../cryptography/cryptography.hpp"
+#include <span>
 
+// The hash is computed on first use rather than every time the signature
+// changes; call get_hash() before sharing a block between threads.
 class TimeBlock {
 public:
     // Constructor for creating a new block
@@ -23,13 +27,17 @@ public:
     void set_signature(const Signature& signature);
 
     // Serialization and deserialization
-    bytes serialize() const;
-    bool deserialize(const bytes& data);
+    bytes serialize(serialization::Format format = serialization::Format::v1) const;
+    size_t serialized_size(serialization::Format format = serialization::Format::v1) const;
+    // Writes serialized_size(format) bytes to the front of out
+    bool serialize_into(std::span<byte> out, serialization::Format format = serialization::Format::v1) const;
+    // Accepts either format
+    bool deserialize(std::span<const byte> data);
 
     // Gets the data to be signed
     bytes get_data_to_sign() const;
 
-    // Computes the block's hash
+    // Recomputes the block's hash from its fields
     void compute_hash();
 
 private:
@@ -37,7 +45,21 @@ private:
     TimePoint time_;
     PublicKey public_key_;
     Signature signature_;
-    Hash hash_;
+    mutable Hash hash_;
+    mutable bool hash_valid_ = false;
+
+public:
+    // Serialized layout; everything before the signature is signed
+    using Schema = schema::Record<3,
+                                  schema::Fixed<&TimeBlock::previous_hash_>,
+                                  schema::Fixed<&TimeBlock::time_>,
+                                  schema::Fixed<&TimeBlock::public_key_>,
+                                  schema::Fixed<&TimeBlock::signature_>,
+                                  schema::Digest<&TimeBlock::hash_>>;
+
+    // Every time block has the same v1 size
+    static constexpr size_t SERIALIZED_SIZE = Schema::MIN_SIZE;
+    static_assert(Schema::FIXED);
 };
 
 #endif // TIME_BLOCK_HPP
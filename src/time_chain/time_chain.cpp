@@ -34,3 +34,15 @@ Hash TimeChain::get_latest_block_hash() const {
 bool TimeChain::block_exists(const Hash& block_hash) const {
     return storage_->block_exists(block_hash);
 }
+
+std::optional<TimeBlock> TimeChain::get_block_by_height(uint64_t height) const {
+    return storage_->get_block_by_height(height);
+}
+
+std::optional<uint64_t> TimeChain::get_latest_height() const {
+    return storage_->get_latest_height();
+}
+
+size_t TimeChain::scan(uint64_t from_height, uint64_t to_height, const std::function<bool(const TimeBlock&)>& visitor) const {
+    return storage_->scan(from_height, to_height, visitor);
+}
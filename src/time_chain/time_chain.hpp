@@ -5,6 +5,7 @@
 #include "../storage/storage_interface.hpp"
 #include <memory>
 #include <optional>
+#include <functional>
 
 class TimeChain {
 public:
@@ -22,6 +23,15 @@ public:
     // Checks if a block exists in the chain
     bool block_exists(const Hash& block_hash) const;
 
+    // Retrieves the block at the given height, the genesis block being height 0
+    std::optional<TimeBlock> get_block_by_height(uint64_t height) const;
+
+    // Height of the latest block, if the storage keeps a height index
+    std::optional<uint64_t> get_latest_height() const;
+
+    // Visits the blocks from from_height to to_height in order until the visitor returns false
+    size_t scan(uint64_t from_height, uint64_t to_height, const std::function<bool(const TimeBlock&)>& visitor) const;
+
 private:
     std::shared_ptr<StorageInterface<TimeBlock>> storage_;
 };
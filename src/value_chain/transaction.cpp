@@ -1,9 +1,10 @@
 #include "transaction.hpp"
 #include "../cryptography/cryptography.hpp"
+#include "../cryptography/sha256_batch.hpp"
+#include "../common/serialization.hpp"
 #include "../common/utilities.hpp"
 #include <cstring>
 #include <algorithm>
-#include <cassert>
 
 Transaction::Transaction(const PublicKey &recipient_public_key, uint64_t amount)
     : sender_public_key_(), // Zero-initialized or special value
@@ -11,7 +12,7 @@ Transaction::Transaction(const PublicKey &recipient_public_key, uint64_t amount)
       amount_(amount)
 {
   signature_.fill(0);
-  compute_hash();
+  encode();
 }
 
 Transaction::Transaction(const PublicKey &sender_public_key,
@@ -24,7 +25,7 @@ Transaction::Transaction(const PublicKey &sender_public_key,
       data_(data)
 {
   signature_.fill(0);
-  compute_hash();
+  encode();
 }
 
 Transaction::Transaction()
@@ -34,6 +35,17 @@ Transaction::Transaction()
   recipient_public_key_.fill(0);
   signature_.fill(0);
   hash_.fill(0);
+  encode();
+}
+
+Transaction::Transaction(const TransactionView &view)
+    : amount_(view.amount())
+{
+  std::ranges::copy(view.sender_public_key(), sender_public_key_.begin());
+  std::ranges::copy(view.recipient_public_key(), recipient_public_key_.begin());
+  data_.assign(view.data().begin(), view.data().end());
+  std::ranges::copy(view.signature(), signature_.begin());
+  restore_cached(view.serialized(), serialization::Format::v1);
 }
 
 const PublicKey &Transaction::get_sender_public_key() const
@@ -63,176 +75,157 @@ const Signature &Transaction::get_signature() const
 
 const Hash &Transaction::get_hash() const
 {
+  if (!hash_valid_)
+  {
+    hash_ = cryptography::sha256(encoding_);
+    hash_valid_ = true;
+  }
   return hash_;
 }
 
 void Transaction::set_signature(const Signature &signature)
 {
+  // The signature is the last field in the cached encoding
   signature_ = signature;
-  compute_hash();
+  std::ranges::copy(signature_, encoding_.end() - SIGNATURE_SIZE);
+  hash_valid_ = false;
 }
 
-bytes Transaction::serialize() const
+bytes Transaction::serialize(serialization::Format format) const
 {
-  bytes data;
-  size_t expected_size = 32 + 32 + 8 + 8 + data_.size() + 64 + 32;
-  data.reserve(expected_size);
-
-  // Serialize sender public key (32 bytes)
-  data.insert(data.end(), sender_public_key_.begin(), sender_public_key_.end());
-  assert(data.size() == 32);
-
-  // Serialize recipient public key (32 bytes)
-  data.insert(data.end(), recipient_public_key_.begin(), recipient_public_key_.end());
-  assert(data.size() == 64);
-
-  // Serialize amount (8 bytes)
-  bytes amount_bytes(reinterpret_cast<const byte *>(&amount_), reinterpret_cast<const byte *>(&amount_) + sizeof(uint64_t));
-  data.insert(data.end(), amount_bytes.begin(), amount_bytes.end());
-  assert(data.size() == 72);
-
-  // Serialize data size (8 bytes)
-  uint64_t data_size = data_.size();
-  bytes data_size_bytes(reinterpret_cast<const byte *>(&data_size), reinterpret_cast<const byte *>(&data_size) + sizeof(uint64_t));
-  data.insert(data.end(), data_size_bytes.begin(), data_size_bytes.end());
-  assert(data.size() == 80);
-
-  // Serialize data (variable length)
-  data.insert(data.end(), data_.begin(), data_.end());
-  assert(data.size() == 80 + data_.size());
-
-  // Serialize signature (64 bytes)
-  data.insert(data.end(), signature_.begin(), signature_.end());
-  assert(data.size() == 80 + data_.size() + 64);
-
-  // Serialize hash (32 bytes)
-  data.insert(data.end(), hash_.begin(), hash_.end());
-  assert(data.size() == expected_size);
-
-  // Log detailed information
-  utilities::log_info("Serialized Transaction fields:");
-  utilities::log_info("Sender Public Key: " + utilities::bytes_to_hex(std::vector<byte>(sender_public_key_.begin(), sender_public_key_.end())));
-  utilities::log_info("Recipient Public Key: " + utilities::bytes_to_hex(std::vector<byte>(recipient_public_key_.begin(), recipient_public_key_.end())));
-  utilities::log_info("Amount: " + std::to_string(amount_));
-  utilities::log_info("Data Size: " + std::to_string(data_size));
-  utilities::log_info("Data: " + utilities::bytes_to_hex(data_));
-  utilities::log_info("Signature: " + utilities::bytes_to_hex(std::vector<byte>(signature_.begin(), signature_.end())));
-  utilities::log_info("Hash: " + utilities::bytes_to_hex(std::vector<byte>(hash_.begin(), hash_.end())));
-  utilities::log_info("Total Serialized Transaction Size: " + std::to_string(data.size()) + " bytes.");
-
+  bytes data(serialized_size(format));
+  serialize_into(data, format);
   return data;
 }
 
-bool Transaction::deserialize(const bytes &data)
+size_t Transaction::serialized_size(serialization::Format format) const
 {
-  size_t offset = 0;
-
-  // Deserialize sender public key (32 bytes)
-  if (offset + sender_public_key_.size() > data.size())
+  if (format == serialization::Format::v1)
   {
-    utilities::log_error("Insufficient data for sender_public_key_. Expected " + std::to_string(sender_public_key_.size()) + ", got " + std::to_string(data.size() - offset));
-    return false;
+    return encoding_.size() + HASH_SIZE;
   }
-  std::copy(data.begin() + offset, data.begin() + offset + sender_public_key_.size(), sender_public_key_.begin());
-  offset += sender_public_key_.size();
+  return Schema::encoded_size(*this, format);
+}
 
-  // Deserialize recipient public key (32 bytes)
-  if (offset + recipient_public_key_.size() > data.size())
+bool Transaction::serialize_into(std::span<byte> out, serialization::Format format) const
+{
+  if (out.size() < serialized_size(format))
   {
-    utilities::log_error("Insufficient data for recipient_public_key_. Expected " + std::to_string(recipient_public_key_.size()) + ", got " + std::to_string(data.size() - offset));
+    utilities::log_error("Buffer of " + std::to_string(out.size()) + " bytes too small for Transaction.");
     return false;
   }
-  std::copy(data.begin() + offset, data.begin() + offset + recipient_public_key_.size(), recipient_public_key_.begin());
-  offset += recipient_public_key_.size();
+  get_hash();
+  Schema::encode(out.data(), *this, format);
+  return true;
+}
 
-  // Deserialize amount (8 bytes)
-  if (offset + sizeof(uint64_t) > data.size())
+bool Transaction::deserialize(std::span<const byte> data)
+{
+  Transaction transaction;
+  if (!Schema::decode(data, transaction))
   {
-    utilities::log_error("Insufficient data for amount_. Expected " + std::to_string(sizeof(uint64_t)) + ", got " + std::to_string(data.size() - offset));
+    utilities::log_error("Malformed Transaction of " + std::to_string(data.size()) + " bytes.");
     return false;
   }
-  std::memcpy(&amount_, &data[offset], sizeof(uint64_t));
-  offset += sizeof(uint64_t);
+  *this = std::move(transaction);
 
-  // Deserialize data size (8 bytes)
-  uint64_t data_size = 0;
-  if (offset + sizeof(uint64_t) > data.size())
-  {
-    utilities::log_error("Insufficient data for data_size. Expected " + std::to_string(sizeof(uint64_t)) + ", got " + std::to_string(data.size() - offset));
-    return false;
-  }
-  std::memcpy(&data_size, &data[offset], sizeof(uint64_t));
-  offset += sizeof(uint64_t);
+  utilities::log_info("Transaction deserialized successfully.");
+  return true;
+}
+
+std::span<const byte> Transaction::get_data_to_sign() const
+{
+  // Sender and recipient keys, amount, then the data payload and its size
+  // (0 bytes for coinbase)
+  return std::span<const byte>(encoding_).first(encoding_.size() - SIGNATURE_SIZE);
+}
+
+void Transaction::compute_hash()
+{
+  hash_valid_ = false;
+  get_hash();
+}
+
+bool Transaction::hash_matches() const
+{
+  return cryptography::sha256(encoding_) == get_hash();
+}
 
-  // Deserialize data (variable)
-  if (offset + data_size > data.size())
+void Transaction::hash_all(std::span<const Transaction> transactions)
+{
+  std::vector<const Transaction *> unhashed;
+  std::vector<std::span<const byte>> encodings;
+  for (const Transaction &transaction : transactions)
   {
-    utilities::log_error("Insufficient data for data_. Expected " + std::to_string(data_size) + ", got " + std::to_string(data.size() - offset));
-    return false;
+    if (!transaction.hash_valid_)
+    {
+      unhashed.push_back(&transaction);
+      encodings.push_back(transaction.encoding_);
+    }
   }
-  data_.resize(data_size);
-  std::copy(data.begin() + offset, data.begin() + offset + data_size, data_.begin());
-  offset += data_size;
-
-  // Deserialize signature (64 bytes)
-  if (offset + signature_.size() > data.size())
+  std::vector<Hash> hashes(unhashed.size());
+  cryptography::sha256_many(encodings, hashes);
+  for (size_t i = 0; i < unhashed.size(); ++i)
   {
-    utilities::log_error("Insufficient data for signature_. Expected " + std::to_string(signature_.size()) + ", got " + std::to_string(data.size() - offset));
-    return false;
+    unhashed[i]->hash_ = hashes[i];
+    unhashed[i]->hash_valid_ = true;
   }
-  std::copy(data.begin() + offset, data.begin() + offset + signature_.size(), signature_.begin());
-  offset += signature_.size();
+}
 
-  // Deserialize hash (32 bytes)
-  if (offset + hash_.size() > data.size())
+bool Transaction::hashes_match(std::span<const Transaction> transactions)
+{
+  std::vector<std::span<const byte>> encodings;
+  encodings.reserve(transactions.size());
+  for (const Transaction &transaction : transactions)
   {
-    utilities::log_error("Insufficient data for hash_. Expected " + std::to_string(hash_.size()) + ", got " + std::to_string(data.size() - offset));
-    return false;
+    encodings.push_back(transaction.encoding_);
   }
-  std::copy(data.begin() + offset, data.begin() + offset + hash_.size(), hash_.begin());
-  offset += hash_.size();
-
-  // Verify that all data has been consumed
-  if (offset != data.size())
+  std::vector<Hash> hashes(transactions.size());
+  cryptography::sha256_many(encodings, hashes);
+  bool all_match = true;
+  for (size_t i = 0; i < transactions.size(); ++i)
   {
-    utilities::log_error("Extra data found after deserializing Transaction. Expected offset " + std::to_string(data.size()) + ", got " + std::to_string(offset));
-    return false;
+    const Transaction &transaction = transactions[i];
+    if (!transaction.hash_valid_)
+    {
+      transaction.hash_ = hashes[i];
+      transaction.hash_valid_ = true;
+    }
+    else if (transaction.hash_ != hashes[i])
+    {
+      all_match = false;
+    }
   }
-
-  utilities::log_info("Transaction deserialized successfully.");
-  return true;
+  return all_match;
 }
 
-bytes Transaction::get_data_to_sign() const
+void Transaction::encode()
 {
-  bytes data;
-
-  // Include sender public key (32 bytes)
-  data.insert(data.end(), sender_public_key_.begin(), sender_public_key_.end());
-
-  // Include recipient public key (32 bytes)
-  data.insert(data.end(), recipient_public_key_.begin(), recipient_public_key_.end());
-
-  // Include amount (8 bytes)
-  bytes amount_bytes(reinterpret_cast<const byte *>(&amount_), reinterpret_cast<const byte *>(&amount_) + sizeof(uint64_t));
-  data.insert(data.end(), amount_bytes.begin(), amount_bytes.end());
-
-  // Include data size (8 bytes)
-  uint64_t data_size = data_.size(); // Should be 0 for coinbase
-  bytes data_size_bytes(reinterpret_cast<const byte *>(&data_size), reinterpret_cast<const byte *>(&data_size) + sizeof(uint64_t));
-  data.insert(data.end(), data_size_bytes.begin(), data_size_bytes.end());
-
-  // Include data (variable, 0 bytes for coinbase)
-  data.insert(data.end(), data_.begin(), data_.end());
+  encoding_.resize(Schema::size<Schema::HASHED_COUNT>(*this));
+  Schema::write<Schema::HASHED_COUNT>(encoding_.data(), *this);
+  hash_valid_ = false;
+}
 
-  return data;
+byte *Transaction::write_cached(byte *out) const
+{
+  out = serialization::write_bytes(out, encoding_);
+  return serialization::write_bytes(out, get_hash());
 }
 
-void Transaction::compute_hash()
+void Transaction::restore_cached(std::span<const byte> record, serialization::Format format)
 {
-  bytes data = get_data_to_sign();
-  data.insert(data.end(), signature_.begin(), signature_.end());
-  hash_ = cryptography::sha256(data);
+  // A v1 record is the encoding plus the hash; anything else is re-encoded
+  // once from the decoded fields. Either way the hash comes with the record.
+  if (format == serialization::Format::v1)
+  {
+    encoding_.assign(record.begin(), record.end() - HASH_SIZE);
+    std::copy(record.end() - HASH_SIZE, record.end(), hash_.begin());
+  }
+  else
+  {
+    encode();
+  }
+  hash_valid_ = true;
 }
 
 bool Transaction::verify() const
@@ -243,8 +236,32 @@ bool Transaction::verify() const
     return true;
   }
 
-  bytes data_to_verify = get_data_to_sign();
-  return cryptography::verify_signature(data_to_verify, signature_, sender_public_key_);
+  return cryptography::verify_signature(get_data_to_sign(), signature_, sender_public_key_);
+}
+
+std::vector<cryptography::SignatureCheck> Transaction::signature_checks(
+    std::span<const Transaction> transactions,
+    const std::function<bool(const Transaction &)> &skip)
+{
+  std::vector<const Transaction *> signed_transactions;
+  std::vector<std::span<const byte>> messages;
+  for (const Transaction &transaction : transactions)
+  {
+    if (!transaction.is_coinbase_transaction() && !(skip && skip(transaction)))
+    {
+      signed_transactions.push_back(&transaction);
+      messages.push_back(transaction.get_data_to_sign());
+    }
+  }
+  std::vector<Hash> message_hashes(messages.size());
+  cryptography::sha256_many(messages, message_hashes);
+
+  std::vector<cryptography::SignatureCheck> checks(signed_transactions.size());
+  for (size_t i = 0; i < checks.size(); ++i)
+  {
+    checks[i] = {message_hashes[i], signed_transactions[i]->signature_, signed_transactions[i]->sender_public_key_};
+  }
+  return checks;
 }
 
 bool Transaction::is_coinbase_transaction() const
@@ -263,5 +280,5 @@ bool Transaction::operator==(const Transaction &other) const
          amount_ == other.amount_ &&
          data_ == other.data_ &&
          signature_ == other.signature_ &&
-         hash_ == other.hash_;
+         get_hash() == other.get_hash();
 }
@@ -1,10 +1,20 @@
 #ifndef TRANSACTION_HPP
 #define TRANSACTION_HPP
 
+#include "../common/schema.hpp"
 #include "../common/types.hpp"
 #include "../cryptography/cryptography.hpp"
+#include "../cryptography/signature_batch.hpp"
+#include "transaction_view.hpp"
+#include <functional>
+#include <span>
 #include <vector>
 
+// A transaction keeps its v1 encoding (everything but the hash) alongside
+// its fields, built once when the fields are set and patched in place by
+// set_signature(); signing, hashing and serialization copy from it rather
+// than re-encoding. The hash is computed on first use. As with any lazily
+// filled cache, call get_hash() before sharing an object between threads.
 class Transaction
 {
 public:
@@ -19,6 +29,9 @@ public:
   // Default constructor for deserialization
   Transaction();
 
+  // Copies the fields out of a parsed transaction
+  explicit Transaction(const TransactionView &view);
+
   // Accessor methods
   const PublicKey &get_sender_public_key() const;
   const PublicKey &get_recipient_public_key() const;
@@ -31,18 +44,40 @@ public:
   void set_signature(const Signature &signature);
 
   // Serialization and deserialization
-  bytes serialize() const;
-  bool deserialize(const bytes &data);
+  bytes serialize(serialization::Format format = serialization::Format::v1) const;
+  size_t serialized_size(serialization::Format format = serialization::Format::v1) const;
+  // Writes serialized_size(format) bytes to the front of out
+  bool serialize_into(std::span<byte> out, serialization::Format format = serialization::Format::v1) const;
+  // Accepts either format
+  bool deserialize(std::span<const byte> data);
 
-  // Gets the data to be signed
-  bytes get_data_to_sign() const;
+  // Gets the data to be signed; valid until the transaction is modified
+  std::span<const byte> get_data_to_sign() const;
 
-  // Computes the transaction's hash
+  // Recomputes the transaction's hash from its fields
   void compute_hash();
 
+  // Whether the hash it was decoded with matches its fields
+  bool hash_matches() const;
+
+  // Hashes those of the transactions not hashed yet with one sha256_many()
+  static void hash_all(std::span<const Transaction> transactions);
+
+  // hash_matches() for every transaction, rehashing them with one
+  // sha256_many(); transactions not hashed yet take the computed hash
+  static bool hashes_match(std::span<const Transaction> transactions);
+
   // Verifies the transaction's signature
   bool verify() const;
 
+  // What verify() checks, for every transaction but coinbase ones and
+  // those skip returns true for, with the signed messages hashed by one
+  // sha256_many(). Pass the result to cryptography::verify_batch() or
+  // first_invalid_signature().
+  static std::vector<cryptography::SignatureCheck> signature_checks(
+      std::span<const Transaction> transactions,
+      const std::function<bool(const Transaction &)> &skip = nullptr);
+
   bool is_coinbase_transaction() const;
 
   bool operator==(const Transaction &other) const;
@@ -53,7 +88,26 @@ private:
   uint64_t amount_;
   std::vector<byte> data_; // Optional data payload
   Signature signature_;
-  Hash hash_;
+  mutable Hash hash_;
+
+  // v1 encoding of every field but the hash: the signed fields, then the signature
+  bytes encoding_;
+  mutable bool hash_valid_ = false;
+
+  void encode();
+  byte *write_cached(byte *out) const;
+  void restore_cached(std::span<const byte> record, serialization::Format format);
+
+public:
+  // Serialized layout; everything before the signature is signed
+  using Schema = schema::Record<4,
+                                schema::Fixed<&Transaction::sender_public_key_>,
+                                schema::Fixed<&Transaction::recipient_public_key_>,
+                                schema::Fixed<&Transaction::amount_>,
+                                schema::Blob<&Transaction::data_>,
+                                schema::Fixed<&Transaction::signature_>,
+                                schema::Digest<&Transaction::hash_>>;
+  friend Schema;
 };
 
 #endif // TRANSACTION_HPP
@@ -0,0 +1,99 @@
+#include "transaction_proof.hpp"
+#include "../common/serialization.hpp"
+#include "../common/utilities.hpp"
+#include "../cryptography/cryptography.hpp"
+#include <algorithm>
+
+namespace
+{
+  using Schema = ValueBlock::Schema;
+
+  template <size_t I, typename Field>
+  Field read_header_field(const std::array<byte, ValueBlock::HEADER_SIZE> &header)
+  {
+    Field field;
+    std::copy_n(header.begin() + Schema::offset<I>(), field.size(), field.begin());
+    return field;
+  }
+}
+
+TransactionProof::TransactionProof(std::span<const byte, ValueBlock::HEADER_SIZE> header,
+                                   const Hash &transaction_hash,
+                                   cryptography::MerkleProof path)
+    : transaction_hash_(transaction_hash), path_(std::move(path))
+{
+  std::ranges::copy(header, header_.begin());
+}
+
+TransactionProof::TransactionProof()
+{
+  header_.fill(0);
+  transaction_hash_.fill(0);
+}
+
+const Hash &TransactionProof::get_transaction_hash() const
+{
+  return transaction_hash_;
+}
+
+const cryptography::MerkleProof &TransactionProof::get_path() const
+{
+  return path_;
+}
+
+Hash TransactionProof::get_block_hash() const
+{
+  return read_header_field<Schema::HASHED_COUNT, Hash>(header_);
+}
+
+Hash TransactionProof::get_merkle_root() const
+{
+  return read_header_field<3, Hash>(header_);
+}
+
+PublicKey TransactionProof::get_public_key() const
+{
+  return read_header_field<4, PublicKey>(header_);
+}
+
+bool TransactionProof::verify() const
+{
+  std::span<const byte> header(header_);
+  if (cryptography::sha256(header.first(Schema::offset<Schema::HASHED_COUNT>())) != get_block_hash())
+  {
+    return false;
+  }
+  Signature signature = read_header_field<Schema::SIGNED_COUNT, Signature>(header_);
+  if (!cryptography::verify_signature(header.first(Schema::offset<Schema::SIGNED_COUNT>()), signature, get_public_key()))
+  {
+    return false;
+  }
+  return path_.verify(transaction_hash_, get_merkle_root());
+}
+
+bytes TransactionProof::serialize() const
+{
+  bytes data(header_.size() + HASH_SIZE + path_.serialized_size());
+  byte *out = serialization::write_bytes(data.data(), header_);
+  out = serialization::write_bytes(out, transaction_hash_);
+  serialization::write_bytes(out, path_.serialize());
+  return data;
+}
+
+bool TransactionProof::deserialize(std::span<const byte> data)
+{
+  if (data.size() < header_.size() + HASH_SIZE)
+  {
+    utilities::log_error("TransactionProof too short: " + std::to_string(data.size()) + " bytes.");
+    return false;
+  }
+  cryptography::MerkleProof path;
+  if (!path.deserialize(data.subspan(header_.size() + HASH_SIZE)))
+  {
+    return false;
+  }
+  std::copy_n(data.begin(), header_.size(), header_.begin());
+  std::copy_n(data.begin() + header_.size(), HASH_SIZE, transaction_hash_.begin());
+  path_ = std::move(path);
+  return true;
+}
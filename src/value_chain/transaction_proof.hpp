@@ -0,0 +1,46 @@
+#ifndef TRANSACTION_PROOF_HPP
+#define TRANSACTION_PROOF_HPP
+
+#include "../common/types.hpp"
+#include "../cryptography/merkle.hpp"
+#include "value_block.hpp"
+#include <array>
+#include <span>
+
+// Evidence that a transaction is in a value block, small enough to hand to
+// a light client: the block's header and the Merkle path from the
+// transaction's hash to the root in that header. verify() needs nothing
+// else, so a client that trusts the block hash (or its signer) learns the
+// transaction is confirmed without downloading the block.
+//
+// Layout: [block header][transaction hash][Merkle proof]
+class TransactionProof {
+public:
+    TransactionProof(std::span<const byte, ValueBlock::HEADER_SIZE> header,
+                     const Hash& transaction_hash,
+                     cryptography::MerkleProof path);
+
+    // Default constructor for deserialization
+    TransactionProof();
+
+    const Hash& get_transaction_hash() const;
+    const cryptography::MerkleProof& get_path() const;
+    // Read from the header
+    Hash get_block_hash() const;
+    Hash get_merkle_root() const;
+    PublicKey get_public_key() const;
+
+    // Whether the header matches its hash and signature, and the path
+    // leads from the transaction to the header's Merkle root
+    bool verify() const;
+
+    bytes serialize() const;
+    bool deserialize(std::span<const byte> data);
+
+private:
+    std::array<byte, ValueBlock::HEADER_SIZE> header_;
+    Hash transaction_hash_;
+    cryptography::MerkleProof path_;
+};
+
+#endif // TRANSACTION_PROOF_HPP
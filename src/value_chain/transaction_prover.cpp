@@ -0,0 +1,102 @@
+#include "transaction_prover.hpp"
+#include "../common/utilities.hpp"
+#include <algorithm>
+
+TransactionProver::TransactionProver(std::shared_ptr<StorageInterface<ValueBlock>> storage, size_t max_trees)
+    : storage_(std::move(storage)), max_trees_(std::max<size_t>(max_trees, 1))
+{
+}
+
+std::optional<TransactionProof> TransactionProver::prove(const Hash &block_hash, const Hash &transaction_hash)
+{
+  auto entry = find(block_hash);
+  if (!entry)
+  {
+    entry = build(block_hash);
+    if (!entry)
+    {
+      return std::nullopt;
+    }
+  }
+
+  auto position = entry->positions.find(transaction_hash);
+  if (position == entry->positions.end())
+  {
+    return std::nullopt;
+  }
+  return TransactionProof(entry->header, transaction_hash, entry->tree.prove(position->second));
+}
+
+CacheStats TransactionProver::get_stats()
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return stats_;
+}
+
+std::shared_ptr<const TransactionProver::Entry> TransactionProver::find(const Hash &block_hash)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = entries_.find(block_hash);
+  if (it == entries_.end())
+  {
+    ++stats_.misses;
+    return nullptr;
+  }
+  ++stats_.hits;
+  lru_.splice(lru_.begin(), lru_, it->second);
+  return *it->second;
+}
+
+std::shared_ptr<const TransactionProver::Entry> TransactionProver::build(const Hash &block_hash)
+{
+  // Load and hash outside the lock; concurrent misses on one block may both
+  // build it, and the second simply replaces the first
+  auto block_opt = storage_->get_block(block_hash);
+  if (!block_opt)
+  {
+    return nullptr;
+  }
+  const std::vector<Transaction> &transactions = block_opt->get_transactions();
+  std::vector<Hash> leaves;
+  leaves.reserve(transactions.size());
+  for (const Transaction &transaction : transactions)
+  {
+    leaves.push_back(transaction.get_hash());
+  }
+
+  auto entry = std::make_shared<Entry>(Entry{block_hash, {}, cryptography::MerkleTree(leaves), {}, 0});
+  if (entry->tree.root() != block_opt->get_merkle_root())
+  {
+    utilities::log_error("Stored ValueBlock does not match its Merkle root.");
+    return nullptr;
+  }
+  bytes header = block_opt->serialize_header();
+  std::ranges::copy(header, entry->header.begin());
+  entry->positions.reserve(leaves.size());
+  for (size_t i = 0; i < leaves.size(); ++i)
+  {
+    entry->positions.emplace(leaves[i], i);
+  }
+  // About twice the leaves in the tree, plus the position table
+  entry->size = ValueBlock::HEADER_SIZE + leaves.size() * (3 * HASH_SIZE + sizeof(size_t));
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (auto it = entries_.find(block_hash); it != entries_.end())
+  {
+    stats_.bytes -= (*it->second)->size;
+    lru_.erase(it->second);
+    entries_.erase(it);
+  }
+  lru_.push_front(entry);
+  entries_[block_hash] = lru_.begin();
+  stats_.bytes += entry->size;
+  while (lru_.size() > max_trees_)
+  {
+    stats_.bytes -= lru_.back()->size;
+    entries_.erase(lru_.back()->block_hash);
+    lru_.pop_back();
+    ++stats_.evictions;
+  }
+  stats_.entries = lru_.size();
+  return entry;
+}
@@ -0,0 +1,55 @@
+#ifndef TRANSACTION_PROVER_HPP
+#define TRANSACTION_PROVER_HPP
+
+#include "../common/cache_stats.hpp"
+#include "../cryptography/merkle.hpp"
+#include "../storage/storage_interface.hpp"
+#include "transaction_proof.hpp"
+#include "value_block.hpp"
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+
+// Builds inclusion proofs for transactions in stored value blocks. The
+// first request for a block loads it and builds its whole Merkle tree;
+// the tree, the header and where each transaction sits are then kept for
+// the max_trees most recently used blocks, so further proofs from the same
+// block are answered without touching storage or hashing anything.
+class TransactionProver {
+public:
+    TransactionProver(std::shared_ptr<StorageInterface<ValueBlock>> storage, size_t max_trees);
+
+    // Proof that the transaction is in the block, or nothing if the block
+    // is not stored or does not contain it
+    std::optional<TransactionProof> prove(const Hash& block_hash, const Hash& transaction_hash);
+
+    // Hits and misses count blocks whose tree was or was not cached; bytes
+    // is the size of the cached trees
+    CacheStats get_stats();
+
+private:
+    struct Entry {
+        Hash block_hash;
+        std::array<byte, ValueBlock::HEADER_SIZE> header;
+        cryptography::MerkleTree tree;
+        std::unordered_map<Hash, size_t, HashHasher> positions;
+        size_t size;
+    };
+
+    std::shared_ptr<StorageInterface<ValueBlock>> storage_;
+    size_t max_trees_;
+    std::mutex mutex_;
+
+    // Most recently used entries at the front; entries are shared so
+    // proofs can be read from one after it has been evicted
+    std::list<std::shared_ptr<const Entry>> lru_;
+    std::unordered_map<Hash, std::list<std::shared_ptr<const Entry>>::iterator, HashHasher> entries_;
+    CacheStats stats_;
+
+    std::shared_ptr<const Entry> find(const Hash& block_hash);
+    std::shared_ptr<const Entry> build(const Hash& block_hash);
+};
+
+#endif // TRANSACTION_PROVER_HPP
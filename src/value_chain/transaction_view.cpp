@@ -0,0 +1,114 @@
+#include "transaction_view.hpp"
+#include "transaction.hpp"
+#include "../common/utilities.hpp"
+#include "../cryptography/cryptography.hpp"
+#include <algorithm>
+
+TransactionView::TransactionView(std::span<const byte> data)
+    : data_(data)
+{
+}
+
+std::optional<TransactionView> TransactionView::parse(std::span<const byte> data)
+{
+  // The view reads at fixed offsets, which must follow Transaction::Schema
+  using Schema = Transaction::Schema;
+  static_assert(FIXED_SIZE == Schema::MIN_SIZE);
+  static_assert(DATA_OFFSET == Schema::offset<3>() + sizeof(uint64_t));
+
+  if (data.size() < FIXED_SIZE)
+  {
+    utilities::log_error("Transaction too short: " + std::to_string(data.size()) + " bytes.");
+    return std::nullopt;
+  }
+
+  uint64_t data_size = 0;
+  serialization::read_value(data.data() + Schema::offset<3>(), data_size);
+  if (data_size != data.size() - FIXED_SIZE)
+  {
+    utilities::log_error("Transaction data size " + std::to_string(data_size) + " does not match its " +
+                         std::to_string(data.size()) + " serialized bytes.");
+    return std::nullopt;
+  }
+  return TransactionView(data);
+}
+
+std::span<const byte, PUBLIC_KEY_SIZE> TransactionView::sender_public_key() const
+{
+  return data_.subspan<0, PUBLIC_KEY_SIZE>();
+}
+
+std::span<const byte, PUBLIC_KEY_SIZE> TransactionView::recipient_public_key() const
+{
+  return data_.subspan<PUBLIC_KEY_SIZE, PUBLIC_KEY_SIZE>();
+}
+
+uint64_t TransactionView::amount() const
+{
+  uint64_t amount;
+  serialization::read_value(data_.data() + Transaction::Schema::offset<2>(), amount);
+  return amount;
+}
+
+std::span<const byte> TransactionView::data() const
+{
+  return data_.subspan(DATA_OFFSET, data_.size() - FIXED_SIZE);
+}
+
+std::span<const byte, SIGNATURE_SIZE> TransactionView::signature() const
+{
+  return std::span<const byte, SIGNATURE_SIZE>(data_.data() + data_.size() - HASH_SIZE - SIGNATURE_SIZE,
+                                               SIGNATURE_SIZE);
+}
+
+std::span<const byte, HASH_SIZE> TransactionView::hash() const
+{
+  return std::span<const byte, HASH_SIZE>(data_.data() + data_.size() - HASH_SIZE, HASH_SIZE);
+}
+
+std::span<const byte> TransactionView::data_to_sign() const
+{
+  return data_.first(data_.size() - SIGNATURE_SIZE - HASH_SIZE);
+}
+
+std::span<const byte> TransactionView::hashed_data() const
+{
+  // Exactly the serialized prefix in front of the hash
+  return data_.first(data_.size() - HASH_SIZE);
+}
+
+bool TransactionView::hash_matches() const
+{
+  Hash computed = cryptography::sha256(hashed_data());
+  return std::equal(computed.begin(), computed.end(), hash().begin());
+}
+
+bool TransactionView::is_coinbase_transaction() const
+{
+  auto sender = sender_public_key();
+  return std::all_of(sender.begin(), sender.end(), [](byte b)
+                     { return b == 0; });
+}
+
+bool TransactionView::verify() const
+{
+  if (is_coinbase_transaction())
+  {
+    return true;
+  }
+  Signature signature_copy;
+  PublicKey sender_copy;
+  std::ranges::copy(signature(), signature_copy.begin());
+  std::ranges::copy(sender_public_key(), sender_copy.begin());
+  return cryptography::verify_signature(data_to_sign(), signature_copy, sender_copy);
+}
+
+std::span<const byte> TransactionView::serialized() const
+{
+  return data_;
+}
+
+Transaction TransactionView::materialize() const
+{
+  return Transaction(*this);
+}
@@ -0,0 +1,58 @@
+#ifndef TRANSACTION_VIEW_HPP
+#define TRANSACTION_VIEW_HPP
+
+#include "../common/types.hpp"
+#include <optional>
+#include <span>
+
+class Transaction;
+
+// Read-only view of a serialized transaction. parse() checks the layout
+// once; the accessors then read fields straight out of the viewed bytes,
+// so validating, indexing or relaying a transaction copies nothing until
+// materialize() builds an owned Transaction. The bytes must outlive the
+// view.
+//
+// Layout: [sender key][recipient key][amount][data size][data][signature][hash]
+class TransactionView {
+public:
+    static constexpr size_t FIXED_SIZE = 2 * PUBLIC_KEY_SIZE + 2 * sizeof(uint64_t) + SIGNATURE_SIZE + HASH_SIZE;
+
+    // Checks that data holds exactly one serialized transaction
+    static std::optional<TransactionView> parse(std::span<const byte> data);
+
+    std::span<const byte, PUBLIC_KEY_SIZE> sender_public_key() const;
+    std::span<const byte, PUBLIC_KEY_SIZE> recipient_public_key() const;
+    uint64_t amount() const;
+    std::span<const byte> data() const;
+    std::span<const byte, SIGNATURE_SIZE> signature() const;
+    std::span<const byte, HASH_SIZE> hash() const;
+
+    // The signed fields, byte for byte what Transaction::get_data_to_sign() builds
+    std::span<const byte> data_to_sign() const;
+
+    // The bytes the hash covers: the signed fields followed by the signature
+    std::span<const byte> hashed_data() const;
+
+    // Whether the embedded hash matches the signed fields and signature
+    bool hash_matches() const;
+
+    bool is_coinbase_transaction() const;
+
+    // Checks the signature, like Transaction::verify()
+    bool verify() const;
+
+    // The whole serialized transaction
+    std::span<const byte> serialized() const;
+
+    Transaction materialize() const;
+
+private:
+    static constexpr size_t DATA_OFFSET = 2 * PUBLIC_KEY_SIZE + 2 * sizeof(uint64_t);
+
+    explicit TransactionView(std::span<const byte> data);
+
+    std::span<const byte> data_;
+};
+
+#endif // TRANSACTION_VIEW_HPP
@@ -1,8 +1,51 @@
 #include "value_block.hpp"
+#include "../common/serialization.hpp"
 #include "../common/utilities.hpp"
+#include "../common/thread_pool.hpp"
 #include "../cryptography/cryptography.hpp"
+#include "../cryptography/merkle.hpp"
+#include <atomic>
+#include <algorithm>
 #include <cstring>
 
+namespace
+{
+  // Transactions per chunk when hashing them on the thread pool
+  constexpr size_t TRANSACTIONS_PER_CHUNK = 64;
+
+  // Collects the transactions' hashes, hashing them in parallel batches
+  // where they were not hashed yet, and optionally checking them against
+  // their fields
+  std::vector<Hash> transaction_hashes(const std::vector<Transaction> &transactions, bool *all_match = nullptr)
+  {
+    std::vector<Hash> hashes(transactions.size());
+    std::atomic<bool> match = true;
+    ThreadPool::shared().parallel_for(transactions.size(), TRANSACTIONS_PER_CHUNK, [&](size_t begin, size_t end)
+                                      {
+      std::span<const Transaction> chunk(transactions.data() + begin, end - begin);
+      if (all_match)
+      {
+        if (!Transaction::hashes_match(chunk))
+        {
+          match = false;
+        }
+      }
+      else
+      {
+        Transaction::hash_all(chunk);
+      }
+      for (size_t i = begin; i < end; ++i)
+      {
+        hashes[i] = transactions[i].get_hash();
+      } });
+    if (all_match)
+    {
+      *all_match = match;
+    }
+    return hashes;
+  }
+}
+
 ValueBlock::ValueBlock(const Hash &previous_hash,
                        const Hash &time_block_hash,
                        TimePoint time,
@@ -12,10 +55,11 @@ ValueBlock::ValueBlock(const Hash &previous_hash,
       time_block_hash_(time_block_hash),
       time_(time),
       transactions_(transactions),
+      merkle_root_(cryptography::merkle_root(transaction_hashes(transactions_))),
       public_key_(public_key)
 {
   signature_.fill(0);
-  compute_hash();
+  encode_header();
 }
 
 ValueBlock::ValueBlock()
@@ -23,9 +67,29 @@ ValueBlock::ValueBlock()
 {
   previous_hash_.fill(0);
   time_block_hash_.fill(0);
+  merkle_root_.fill(0);
   public_key_.fill(0);
   signature_.fill(0);
   hash_.fill(0);
+  encode_header();
+}
+
+ValueBlock::ValueBlock(const ValueBlockView &view)
+    : time_(view.time())
+{
+  std::ranges::copy(view.previous_hash(), previous_hash_.begin());
+  std::ranges::copy(view.time_block_hash(), time_block_hash_.begin());
+  transactions_.reserve(view.transaction_count());
+  for (const TransactionView &transaction : view.transactions())
+  {
+    transactions_.emplace_back(transaction);
+  }
+  std::ranges::copy(view.merkle_root(), merkle_root_.begin());
+  std::ranges::copy(view.public_key(), public_key_.begin());
+  std::ranges::copy(view.signature(), signature_.begin());
+  std::ranges::copy(view.hash(), hash_.begin());
+  encode_header();
+  hash_valid_ = true;
 }
 
 const Hash &ValueBlock::get_previous_hash() const
@@ -48,6 +112,11 @@ const std::vector<Transaction> &ValueBlock::get_transactions() const
   return transactions_;
 }
 
+const Hash &ValueBlock::get_merkle_root() const
+{
+  return merkle_root_;
+}
+
 const PublicKey &ValueBlock::get_public_key() const
 {
   return public_key_;
@@ -60,176 +129,98 @@ const Signature &ValueBlock::get_signature() const
 
 const Hash &ValueBlock::get_hash() const
 {
+  if (!hash_valid_)
+  {
+    hash_ = cryptography::sha256(header_);
+    hash_valid_ = true;
+  }
   return hash_;
 }
 
 void ValueBlock::set_signature(const Signature &signature)
 {
+  // The signature is the last field in the cached header
   signature_ = signature;
-  compute_hash();
+  std::ranges::copy(signature_, header_.end() - SIGNATURE_SIZE);
+  hash_valid_ = false;
 }
 
 // value_block.cpp
 
-bytes ValueBlock::serialize() const
+bytes ValueBlock::serialize(serialization::Format format) const
 {
-  bytes data;
-
-  // Serialize previous hash
-  data.insert(data.end(), previous_hash_.begin(), previous_hash_.end());
-
-  // Serialize time block hash
-  data.insert(data.end(), time_block_hash_.begin(), time_block_hash_.end());
-
-  // Serialize time
-  bytes time_bytes(reinterpret_cast<const byte *>(&time_), reinterpret_cast<const byte *>(&time_) + sizeof(TimePoint));
-  data.insert(data.end(), time_bytes.begin(), time_bytes.end());
-
-  // Serialize number of transactions
-  uint64_t num_transactions = transactions_.size();
-  bytes num_tx_bytes(reinterpret_cast<const byte *>(&num_transactions), reinterpret_cast<const byte *>(&num_transactions) + sizeof(uint64_t));
-  data.insert(data.end(), num_tx_bytes.begin(), num_tx_bytes.end());
-
-  // Serialize transactions
-  for (const auto &tx : transactions_)
-  {
-    bytes tx_bytes = tx.serialize();
-    // Serialize transaction size
-    uint64_t tx_size = tx_bytes.size();
-    bytes tx_size_bytes(reinterpret_cast<const byte *>(&tx_size), reinterpret_cast<const byte *>(&tx_size) + sizeof(uint64_t));
-    data.insert(data.end(), tx_size_bytes.begin(), tx_size_bytes.end());
-    // Insert transaction bytes
-    data.insert(data.end(), tx_bytes.begin(), tx_bytes.end());
-  }
-
-  // Serialize public key
-  data.insert(data.end(), public_key_.begin(), public_key_.end());
-
-  // Serialize signature
-  data.insert(data.end(), signature_.begin(), signature_.end());
-
-  // Serialize hash
-  data.insert(data.end(), hash_.begin(), hash_.end());
-
+  bytes data(serialized_size(format));
+  serialize_into(data, format);
   return data;
 }
 
-bool ValueBlock::deserialize(const bytes &data)
+size_t ValueBlock::serialized_size(serialization::Format format) const
 {
-  size_t offset = 0;
-
-  // Deserialize previous hash
-  if (offset + previous_hash_.size() > data.size())
-    return false;
-  std::copy(data.begin() + offset, data.begin() + offset + previous_hash_.size(), previous_hash_.begin());
-  offset += previous_hash_.size();
-
-  // Deserialize time block hash
-  if (offset + time_block_hash_.size() > data.size())
-    return false;
-  std::copy(data.begin() + offset, data.begin() + offset + time_block_hash_.size(), time_block_hash_.begin());
-  offset += time_block_hash_.size();
-
-  // Deserialize time
-  if (offset + sizeof(TimePoint) > data.size())
-    return false;
-  std::memcpy(&time_, &data[offset], sizeof(TimePoint));
-  offset += sizeof(TimePoint);
-
-  // Deserialize number of transactions
-  uint64_t num_transactions = 0;
-  if (offset + sizeof(uint64_t) > data.size())
-    return false;
-  std::memcpy(&num_transactions, &data[offset], sizeof(uint64_t));
-  offset += sizeof(uint64_t);
+  return Schema::encoded_size(*this, format);
+}
 
-  // Deserialize transactions
-  transactions_.clear();
-  for (uint64_t i = 0; i < num_transactions; ++i)
+bool ValueBlock::serialize_into(std::span<byte> out, serialization::Format format) const
+{
+  size_t size = serialized_size(format);
+  if (out.size() < size)
   {
-    // Deserialize transaction size
-    uint64_t tx_size = 0;
-    if (offset + sizeof(uint64_t) > data.size())
-      return false;
-    std::memcpy(&tx_size, &data[offset], sizeof(uint64_t));
-    offset += sizeof(uint64_t);
-
-    // Deserialize transaction data
-    if (offset + tx_size > data.size())
-      return false;
-    bytes tx_bytes(data.begin() + offset, data.begin() + offset + tx_size);
-    offset += tx_size;
-
-    Transaction tx;
-    if (!tx.deserialize(tx_bytes))
-    {
-      utilities::log_error("Failed to deserialize transaction in ValueBlock.");
-      return false;
-    }
-    transactions_.push_back(tx);
-  }
-
-  // Deserialize public key
-  if (offset + public_key_.size() > data.size())
+    utilities::log_error("Buffer of " + std::to_string(out.size()) + " bytes too small for ValueBlock of " +
+                         std::to_string(size) + " bytes.");
     return false;
-  std::copy(data.begin() + offset, data.begin() + offset + public_key_.size(), public_key_.begin());
-  offset += public_key_.size();
-
-  // Deserialize signature
-  if (offset + signature_.size() > data.size())
-    return false;
-  std::copy(data.begin() + offset, data.begin() + offset + signature_.size(), signature_.begin());
-  offset += signature_.size();
+  }
+  get_hash();
+  Schema::encode(out.data(), *this, format);
+  return true;
+}
 
-  // Deserialize hash
-  if (offset + hash_.size() > data.size())
+bool ValueBlock::deserialize(std::span<const byte> data)
+{
+  ValueBlock block;
+  if (!Schema::decode(data, block))
+  {
+    utilities::log_error("Malformed ValueBlock of " + std::to_string(data.size()) + " bytes.");
     return false;
-  std::copy(data.begin() + offset, data.begin() + offset + hash_.size(), hash_.begin());
-  offset += hash_.size();
+  }
+  *this = std::move(block);
   utilities::log_info("ValueBlock deserialized successfully.");
   return true;
 }
 
-bytes ValueBlock::get_data_to_sign() const
+bytes ValueBlock::serialize_header() const
 {
-  bytes data;
-
-  // Include previous hash
-  data.insert(data.end(), previous_hash_.begin(), previous_hash_.end());
-
-  // Include time block hash
-  data.insert(data.end(), time_block_hash_.begin(), time_block_hash_.end());
-
-  // Include time
-  bytes time_bytes(reinterpret_cast<const byte *>(&time_), reinterpret_cast<const byte *>(&time_) + sizeof(TimePoint));
-  data.insert(data.end(), time_bytes.begin(), time_bytes.end());
+  bytes header(HEADER_SIZE);
+  byte *out = serialization::write_bytes(header.data(), header_);
+  serialization::write_bytes(out, get_hash());
+  return header;
+}
 
-  // Include number of transactions
-  uint64_t num_transactions = transactions_.size();
-  bytes num_tx_bytes(reinterpret_cast<const byte *>(&num_transactions), reinterpret_cast<const byte *>(&num_transactions) + sizeof(uint64_t));
-  data.insert(data.end(), num_tx_bytes.begin(), num_tx_bytes.end());
+std::span<const byte> ValueBlock::get_data_to_sign() const
+{
+  return std::span<const byte>(header_).first(HASHED_HEADER_SIZE - SIGNATURE_SIZE);
+}
 
-  // Include transactions
-  for (const auto &tx : transactions_)
-  {
-    bytes tx_bytes = tx.serialize();
-    // Include transaction size
-    uint64_t tx_size = tx_bytes.size();
-    bytes tx_size_bytes(reinterpret_cast<const byte *>(&tx_size), reinterpret_cast<const byte *>(&tx_size) + sizeof(uint64_t));
-    data.insert(data.end(), tx_size_bytes.begin(), tx_size_bytes.end());
-    // Include transaction bytes
-    data.insert(data.end(), tx_bytes.begin(), tx_bytes.end());
-  }
+void ValueBlock::compute_hash()
+{
+  hash_valid_ = false;
+  get_hash();
+}
 
-  // Include public key
-  data.insert(data.end(), public_key_.begin(), public_key_.end());
+bool ValueBlock::transactions_match_root() const
+{
+  bool all_match = false;
+  Hash root = cryptography::merkle_root(transaction_hashes(transactions_, &all_match));
+  return all_match && root == merkle_root_;
+}
 
-  return data;
+void ValueBlock::encode_header()
+{
+  Schema::write<Schema::HASHED_COUNT>(header_.data(), *this);
+  hash_valid_ = false;
 }
 
-void ValueBlock::compute_hash()
+void ValueBlock::restore_cached(std::span<const byte>, serialization::Format)
 {
-  bytes data = get_data_to_sign();
-  data.insert(data.end(), signature_.begin(), signature_.end());
-  hash_ = cryptography::sha256(data);
+  // Keep the hash the block was encoded with
+  encode_header();
+  hash_valid_ = true;
 }
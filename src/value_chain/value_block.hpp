@@ -1,11 +1,22 @@
 #ifndef VALUE_BLOCK_HPP
 #define VALUE_BLOCK_HPP
 
+#include "../common/schema.hpp"
 #include "../common/types.hpp"
 #include "../cryptography/cryptography.hpp"
+#include <array>
+#include <span>
 #include "transaction.hpp"
+#include "value_block_view.hpp"
 #include <vector>
 
+// A block is a fixed-size header followed by its transactions. The header
+// commits to the transactions through the Merkle root of their hashes, and
+// the signature and block hash cover only the header, so a header can be
+// checked without the transactions and hashing a block costs the same
+// whatever its size. The header's v1 encoding is kept up to date with its
+// fields; the hash is computed from it on first use, so call get_hash()
+// before sharing a block between threads.
 class ValueBlock {
 public:
     // Constructor for creating a new block
@@ -18,11 +29,15 @@ public:
     // Default constructor for deserialization
     ValueBlock();
 
+    // Copies the header and transactions out of a parsed block
+    explicit ValueBlock(const ValueBlockView& view);
+
     // Accessor methods
     const Hash& get_previous_hash() const;
     const Hash& get_time_block_hash() const;
     const TimePoint& get_time() const;
     const std::vector<Transaction>& get_transactions() const;
+    const Hash& get_merkle_root() const;
     const PublicKey& get_public_key() const;
     const Signature& get_signature() const;
     const Hash& get_hash() const;
@@ -31,23 +46,65 @@ public:
     void set_signature(const Signature& signature);
 
     // Serialization and deserialization
-    bytes serialize() const;
-    bool deserialize(const bytes& data);
+    bytes serialize(serialization::Format format = serialization::Format::v1) const;
+    size_t serialized_size(serialization::Format format = serialization::Format::v1) const;
+    // Writes serialized_size(format) bytes to the front of out
+    bool serialize_into(std::span<byte> out, serialization::Format format = serialization::Format::v1) const;
+    // Accepts either format
+    bool deserialize(std::span<const byte> data);
+
+    // The v1 header alone: the first HEADER_SIZE bytes of serialize()
+    bytes serialize_header() const;
 
-    // Gets the data to be signed
-    bytes get_data_to_sign() const;
+    // Gets the data to be signed; valid until the block is modified
+    std::span<const byte> get_data_to_sign() const;
 
-    // Computes the block's hash
+    // Recomputes the block's hash from its header
     void compute_hash();
 
+    // Whether every transaction matches its hash and the header's Merkle
+    // root matches those hashes; the check that ties the transactions to a
+    // header that was only hash-checked and signature-checked
+    bool transactions_match_root() const;
+
 private:
+    // The signed header fields, then the signature
+    static constexpr size_t HASHED_HEADER_SIZE =
+        3 * HASH_SIZE + sizeof(TimePoint) + PUBLIC_KEY_SIZE + SIGNATURE_SIZE;
+
     Hash previous_hash_;
     Hash time_block_hash_; // Reference to the corresponding TimeBlock
     TimePoint time_;
     std::vector<Transaction> transactions_;
+    Hash merkle_root_; // Root of the transactions' hashes
     PublicKey public_key_;
     Signature signature_;
-    Hash hash_;
+    mutable Hash hash_;
+
+    // v1 encoding of the hashed part of the header
+    std::array<byte, HASHED_HEADER_SIZE> header_;
+    mutable bool hash_valid_ = false;
+
+    void encode_header();
+    void restore_cached(std::span<const byte> record, serialization::Format format);
+
+public:
+    // Serialized layout: the header, through the hash, then the
+    // transactions. Everything before the signature is signed.
+    using Schema = schema::Record<5,
+                                  schema::Fixed<&ValueBlock::previous_hash_>,
+                                  schema::Fixed<&ValueBlock::time_block_hash_>,
+                                  schema::Fixed<&ValueBlock::time_>,
+                                  schema::Fixed<&ValueBlock::merkle_root_>,
+                                  schema::Fixed<&ValueBlock::public_key_>,
+                                  schema::Fixed<&ValueBlock::signature_>,
+                                  schema::Digest<&ValueBlock::hash_>,
+                                  schema::Sequence<&ValueBlock::transactions_>>;
+    friend Schema;
+
+    // Size of the v1 header, which leads every v1 block
+    static constexpr size_t HEADER_SIZE = Schema::offset<Schema::HASHED_COUNT + 1>();
+    static_assert(HASHED_HEADER_SIZE == Schema::offset<Schema::HASHED_COUNT>());
 };
 
 #endif // VALUE_BLOCK_HPP
@@ -0,0 +1,185 @@
+#include "value_block_view.hpp"
+#include "value_block.hpp"
+#include "../common/thread_pool.hpp"
+#include "../common/utilities.hpp"
+#include "../cryptography/cryptography.hpp"
+#include "../cryptography/merkle.hpp"
+#include "../cryptography/sha256_batch.hpp"
+#include <algorithm>
+#include <atomic>
+
+ValueBlockView::ValueBlockView(std::span<const byte> data, std::vector<TransactionView> transactions)
+    : data_(data), transactions_(std::move(transactions))
+{
+}
+
+std::optional<ValueBlockView> ValueBlockView::parse(std::span<const byte> data)
+{
+  // The view reads at fixed offsets, which must follow ValueBlock::Schema
+  using Schema = ValueBlock::Schema;
+  static_assert(HEADER_SIZE == ValueBlock::HEADER_SIZE);
+  static_assert(SIGNED_SIZE == Schema::offset<Schema::SIGNED_COUNT>());
+  static_assert(HEADER_SIZE + sizeof(uint64_t) == Schema::MIN_SIZE);
+
+  if (data.size() < HEADER_SIZE + sizeof(uint64_t))
+  {
+    utilities::log_error("ValueBlock too short: " + std::to_string(data.size()) + " bytes.");
+    return std::nullopt;
+  }
+
+  uint64_t transaction_count = 0;
+  serialization::read_value(data.data() + HEADER_SIZE, transaction_count);
+  // Every transaction needs at least its size prefix and fixed fields
+  size_t offset = HEADER_SIZE + sizeof(uint64_t);
+  size_t body_size = data.size() - offset;
+  if (transaction_count > body_size / (sizeof(uint64_t) + TransactionView::FIXED_SIZE))
+  {
+    utilities::log_error("ValueBlock claims " + std::to_string(transaction_count) + " transactions in " +
+                         std::to_string(data.size()) + " bytes.");
+    return std::nullopt;
+  }
+
+  std::vector<TransactionView> transactions;
+  transactions.reserve(transaction_count);
+  for (uint64_t i = 0; i < transaction_count; ++i)
+  {
+    uint64_t transaction_size = 0;
+    if (data.size() - offset < sizeof(uint64_t))
+    {
+      utilities::log_error("ValueBlock truncated in transaction " + std::to_string(i));
+      return std::nullopt;
+    }
+    serialization::read_value(data.data() + offset, transaction_size);
+    offset += sizeof(uint64_t);
+    if (transaction_size > data.size() - offset)
+    {
+      utilities::log_error("ValueBlock truncated in transaction " + std::to_string(i));
+      return std::nullopt;
+    }
+    auto transaction = TransactionView::parse(data.subspan(offset, transaction_size));
+    if (!transaction)
+    {
+      utilities::log_error("Failed to parse transaction " + std::to_string(i) + " in ValueBlock.");
+      return std::nullopt;
+    }
+    transactions.push_back(*transaction);
+    offset += transaction_size;
+  }
+
+  if (offset != data.size())
+  {
+    utilities::log_error("ValueBlock has " + std::to_string(data.size() - offset) + " unexpected bytes after its transactions.");
+    return std::nullopt;
+  }
+  return ValueBlockView(data, std::move(transactions));
+}
+
+std::span<const byte, HASH_SIZE> ValueBlockView::previous_hash() const
+{
+  return data_.subspan<0, HASH_SIZE>();
+}
+
+std::span<const byte, HASH_SIZE> ValueBlockView::time_block_hash() const
+{
+  return data_.subspan<HASH_SIZE, HASH_SIZE>();
+}
+
+TimePoint ValueBlockView::time() const
+{
+  TimePoint time;
+  serialization::read_value(data_.data() + ValueBlock::Schema::offset<2>(), time);
+  return time;
+}
+
+std::span<const byte, HASH_SIZE> ValueBlockView::merkle_root() const
+{
+  return data_.subspan<ValueBlock::Schema::offset<3>(), HASH_SIZE>();
+}
+
+size_t ValueBlockView::transaction_count() const
+{
+  return transactions_.size();
+}
+
+const TransactionView &ValueBlockView::transaction(size_t index) const
+{
+  return transactions_[index];
+}
+
+const std::vector<TransactionView> &ValueBlockView::transactions() const
+{
+  return transactions_;
+}
+
+std::span<const byte, PUBLIC_KEY_SIZE> ValueBlockView::public_key() const
+{
+  return data_.subspan<SIGNED_SIZE - PUBLIC_KEY_SIZE, PUBLIC_KEY_SIZE>();
+}
+
+std::span<const byte, SIGNATURE_SIZE> ValueBlockView::signature() const
+{
+  return data_.subspan<SIGNED_SIZE, SIGNATURE_SIZE>();
+}
+
+std::span<const byte, HASH_SIZE> ValueBlockView::hash() const
+{
+  return data_.subspan<HEADER_SIZE - HASH_SIZE, HASH_SIZE>();
+}
+
+std::span<const byte> ValueBlockView::data_to_sign() const
+{
+  return data_.first(SIGNED_SIZE);
+}
+
+bool ValueBlockView::hash_matches() const
+{
+  // The hash covers the signed fields followed by the signature, which is
+  // exactly the header in front of the hash
+  Hash computed = cryptography::sha256(data_.first(HEADER_SIZE - HASH_SIZE));
+  return std::equal(computed.begin(), computed.end(), hash().begin());
+}
+
+bool ValueBlockView::transactions_match_root() const
+{
+  // Rehashing the transactions is the expensive part; spread it out, with
+  // each chunk hashed as one batch
+  std::vector<Hash> hashes(transactions_.size());
+  std::atomic<bool> all_match = true;
+  ThreadPool::shared().parallel_for(transactions_.size(), 64, [&](size_t begin, size_t end)
+                                    {
+    std::vector<std::span<const byte>> preimages;
+    preimages.reserve(end - begin);
+    for (size_t i = begin; i < end; ++i)
+    {
+      preimages.push_back(transactions_[i].hashed_data());
+    }
+    cryptography::sha256_many(preimages, std::span<Hash>(hashes).subspan(begin, end - begin));
+    for (size_t i = begin; i < end; ++i)
+    {
+      if (!std::ranges::equal(hashes[i], transactions_[i].hash()))
+      {
+        all_match = false;
+      }
+    } });
+  if (!all_match)
+  {
+    return false;
+  }
+  Hash root = cryptography::merkle_root(hashes);
+  return std::equal(root.begin(), root.end(), merkle_root().begin());
+}
+
+std::span<const byte> ValueBlockView::header() const
+{
+  return data_.first(HEADER_SIZE);
+}
+
+std::span<const byte> ValueBlockView::serialized() const
+{
+  return data_;
+}
+
+ValueBlock ValueBlockView::materialize() const
+{
+  return ValueBlock(*this);
+}
@@ -0,0 +1,67 @@
+#ifndef VALUE_BLOCK_VIEW_HPP
+#define VALUE_BLOCK_VIEW_HPP
+
+#include "../common/types.hpp"
+#include "transaction_view.hpp"
+#include <optional>
+#include <span>
+#include <vector>
+
+class ValueBlock;
+
+// Read-only view of a serialized value block. parse() walks the block once
+// and keeps a table of where each transaction sits; header fields are read
+// at fixed offsets and transactions are handed out as TransactionViews, so
+// hash-checking, indexing or relaying a block allocates nothing per
+// transaction. The bytes must outlive the view.
+//
+// Layout: [previous hash][time block hash][time][merkle root][public key]
+//         [signature][hash][transaction count]([transaction size][transaction])...
+// The header, through the hash, has a fixed size, so header() and the
+// checks on it never look at the transactions.
+class ValueBlockView {
+public:
+    // Checks that data holds exactly one serialized block
+    static std::optional<ValueBlockView> parse(std::span<const byte> data);
+
+    std::span<const byte, HASH_SIZE> previous_hash() const;
+    std::span<const byte, HASH_SIZE> time_block_hash() const;
+    TimePoint time() const;
+    std::span<const byte, HASH_SIZE> merkle_root() const;
+    size_t transaction_count() const;
+    const TransactionView& transaction(size_t index) const;
+    const std::vector<TransactionView>& transactions() const;
+    std::span<const byte, PUBLIC_KEY_SIZE> public_key() const;
+    std::span<const byte, SIGNATURE_SIZE> signature() const;
+    std::span<const byte, HASH_SIZE> hash() const;
+
+    // The signed fields, byte for byte what ValueBlock::get_data_to_sign() builds
+    std::span<const byte> data_to_sign() const;
+
+    // Whether the embedded hash matches the signed fields and signature
+    bool hash_matches() const;
+
+    // Whether every transaction matches its embedded hash and the Merkle
+    // root matches those hashes
+    bool transactions_match_root() const;
+
+    // The serialized header, through the hash
+    std::span<const byte> header() const;
+
+    // The whole serialized block
+    std::span<const byte> serialized() const;
+
+    ValueBlock materialize() const;
+
+private:
+    static constexpr size_t HEADER_SIZE =
+        3 * HASH_SIZE + sizeof(TimePoint) + PUBLIC_KEY_SIZE + SIGNATURE_SIZE + HASH_SIZE;
+    static constexpr size_t SIGNED_SIZE = HEADER_SIZE - SIGNATURE_SIZE - HASH_SIZE;
+
+    ValueBlockView(std::span<const byte> data, std::vector<TransactionView> transactions);
+
+    std::span<const byte> data_;
+    std::vector<TransactionView> transactions_;
+};
+
+#endif // VALUE_BLOCK_VIEW_HPP
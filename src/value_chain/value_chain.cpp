@@ -38,3 +38,15 @@ bool ValueChain::block_exists(const Hash& block_hash) const {
 std::optional<ValueBlock> ValueChain::get_block(const Hash& block_hash) const {
     return storage_->get_block(block_hash);
 }
+
+std::optional<ValueBlock> ValueChain::get_block_by_height(uint64_t height) const {
+    return storage_->get_block_by_height(height);
+}
+
+std::optional<uint64_t> ValueChain::get_latest_height() const {
+    return storage_->get_latest_height();
+}
+
+size_t ValueChain::scan(uint64_t from_height, uint64_t to_height, const std::function<bool(const ValueBlock&)>& visitor) const {
+    return storage_->scan(from_height, to_height, visitor);
+}
@@ -5,6 +5,7 @@
 #include "../storage/storage_interface.hpp"
 #include <memory>
 #include <optional>
+#include <functional>
 
 class ValueChain {
 public:
@@ -25,6 +26,15 @@ public:
     // Retrieves a block by its hash
     std::optional<ValueBlock> get_block(const Hash& block_hash) const;
 
+    // Retrieves the block at the given height, the genesis block being height 0
+    std::optional<ValueBlock> get_block_by_height(uint64_t height) const;
+
+    // Height of the latest block, if the storage keeps a height index
+    std::optional<uint64_t> get_latest_height() const;
+
+    // Visits the blocks from from_height to to_height in order until the visitor returns false
+    size_t scan(uint64_t from_height, uint64_t to_height, const std::function<bool(const ValueBlock&)>& visitor) const;
+
 private:
     std::shared_ptr<StorageInterface<ValueBlock>> storage_;
 };
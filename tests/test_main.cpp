@@ -1,6 +1,39 @@
 #include <gtest/gtest.h>
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <condition_variable>
+#include <fstream>
+#include <future>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <fcntl.h>
+#include <unistd.h>
+#include "../src/common/crc32c.hpp"
+#include "../src/common/genesis_blocks.hpp"
+#include "../src/common/hex.hpp"
+#include "../src/common/thread_pool.hpp"
+#include "../src/common/utilities.hpp"
+#include "../src/consensus/signature_cache.hpp"
+#include "../src/consensus/time_chain_consensus.hpp"
+#include "../src/consensus/value_chain_consensus.hpp"
 #include "../src/cryptography/cryptography.hpp"
+#include "../src/cryptography/merkle.hpp"
 #include "../src/cryptography/schnorr_signature.hpp"
+#include "../src/cryptography/sha256_batch.hpp"
+#include "../src/cryptography/sha256_hasher.hpp"
+#include "../src/cryptography/signer.hpp"
+#include "../src/storage/async_storage_writer.hpp"
+#include "../src/storage/block_index.hpp"
+#include "../src/storage/bloom_filter.hpp"
+#include "../src/storage/caching_storage.hpp"
+#include "../src/storage/file_storage.hpp"
+#include "../src/storage/io_uring.hpp"
+#include "../src/storage/segment_storage.hpp"
+#include "../src/time_chain/time_block.hpp"
+#include "../src/value_chain/transaction_prover.hpp"
+#include "../src/value_chain/value_block.hpp"
 
 TEST(CryptographyTest, GeneratePrivateKey)
 {
@@ -26,6 +59,1882 @@ TEST(CryptographyTest, SignAndVerifyMessage)
   EXPECT_TRUE(is_valid);
 }
 
+TEST(CryptographyTest, SignerReusesKeypairAcrossThreads)
+{
+  PrivateKey private_key = cryptography::generate_private_key();
+  Signer signer(private_key);
+  EXPECT_EQ(signer.get_public_key(), cryptography::derive_public_key(private_key));
+
+  bytes message = {'b', 'l', 'o', 'c', 'k'};
+  EXPECT_TRUE(cryptography::verify_signature(message, signer.sign(message), signer.get_public_key()));
+  EXPECT_TRUE(cryptography::verify_signature(message, signer.sign_hash(cryptography::sha256(message)),
+                                             signer.get_public_key()));
+
+  // Repeat senders verified from many threads, each on its own context
+  std::vector<Signer> senders;
+  for (int i = 0; i < 3; ++i)
+  {
+    senders.emplace_back(cryptography::generate_private_key());
+  }
+  std::atomic<int> failures = 0;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t)
+  {
+    threads.emplace_back([&, t]
+                         {
+      for (int round = 0; round < 50; ++round)
+      {
+        const Signer &sender = senders[(t + round) % senders.size()];
+        const Signer &other = senders[(t + round + 1) % senders.size()];
+        bytes payload = {static_cast<byte>(t), static_cast<byte>(round)};
+        Signature signature = sender.sign(payload);
+        if (!cryptography::verify_signature(payload, signature, sender.get_public_key()) ||
+            cryptography::verify_signature(payload, signature, other.get_public_key()))
+        {
+          ++failures;
+        }
+      } });
+  }
+  for (std::thread &thread : threads)
+  {
+    thread.join();
+  }
+  EXPECT_EQ(failures, 0);
+}
+
+TEST(CryptographyTest, Sha256HasherMatchesOneShotAcrossSplits)
+{
+  std::string abc = "abc";
+  EXPECT_EQ(hex::encode(cryptography::sha256(bytes(abc.begin(), abc.end()))),
+            "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad");
+
+  bytes data(300);
+  for (size_t i = 0; i < data.size(); ++i)
+  {
+    data[i] = static_cast<byte>(i * 31 + 5);
+  }
+  std::span<const byte> all(data);
+  cryptography::Sha256Hasher hasher;
+  for (size_t split = 0; split <= data.size(); split += 7)
+  {
+    // finalize() leaves the hasher empty for the next digest
+    EXPECT_EQ(hasher.update(all.first(split)).update(all.subspan(split)).finalize(), cryptography::sha256(data));
+  }
+  EXPECT_EQ(hasher.finalize(), cryptography::sha256(bytes{}));
+  EXPECT_EQ(cryptography::double_sha256(data), cryptography::sha256(cryptography::sha256(data)));
+
+  // Each thread hashes on its own context
+  std::vector<std::future<Hash>> results;
+  for (int i = 0; i < 4; ++i)
+  {
+    results.push_back(std::async(std::launch::async, [&]
+                                 {
+      Hash hash{};
+      for (int round = 0; round < 100; ++round)
+      {
+        hash = cryptography::merkle_parent(cryptography::sha256(data), hash);
+      }
+      return hash; }));
+  }
+  Hash expected = results[0].get();
+  for (size_t i = 1; i < results.size(); ++i)
+  {
+    EXPECT_EQ(results[i].get(), expected);
+  }
+}
+
+TEST(CryptographyTest, Sha256ManyMatchesOneShotForEveryLength)
+{
+  bytes data(300);
+  for (size_t i = 0; i < data.size(); ++i)
+  {
+    data[i] = static_cast<byte>(i * 77 + 3);
+  }
+  // Lengths around the one- and two-block padding boundaries, in batches
+  // that leave lanes idle, fill them, and refill them unevenly
+  std::vector<std::span<const byte>> messages;
+  for (size_t size = 0; size <= 200; ++size)
+  {
+    messages.push_back(std::span<const byte>(data).subspan(size % 7, size));
+  }
+  messages.push_back(data);
+  // Every implementation the CPU supports, not just the one dispatched to
+  std::vector<cryptography::Sha256ManyImplementation> implementations = cryptography::sha256_many_implementations();
+  ASSERT_STREQ(implementations.front().name, cryptography::sha256_many_instruction_set());
+  ASSERT_STREQ(implementations.back().name, "portable");
+  for (const auto &implementation : implementations)
+  {
+    for (size_t batch : {1, 3, 8, 9, 41, 202})
+    {
+      std::span<const std::span<const byte>> batch_messages(messages.data(), batch);
+      std::vector<Hash> hashes(batch);
+      implementation.hash(batch_messages, hashes);
+      for (size_t i = 0; i < batch; ++i)
+      {
+        ASSERT_EQ(hashes[i], cryptography::sha256(batch_messages[i]))
+            << implementation.name << " batch " << batch << " length " << batch_messages[i].size();
+      }
+    }
+    implementation.hash({}, {});
+  }
+  std::vector<Hash> hashes(3);
+  cryptography::sha256_many(std::span<const std::span<const byte>>(messages.data(), 3), hashes);
+  EXPECT_EQ(hashes[2], cryptography::sha256(messages[2]));
+}
+
+TEST(CommonTest, Crc32cMatchesReferenceAndPortableImplementation)
+{
+  std::string check = "123456789";
+  bytes check_bytes(check.begin(), check.end());
+  EXPECT_EQ(crc32c::compute(check_bytes), 0xE3069283u);
+  EXPECT_EQ(crc32c::extend_portable(0, check_bytes), 0xE3069283u);
+
+  // Every length and alignment around the word-sized fast paths, in one piece and in two
+  bytes data(300);
+  for (size_t i = 0; i < data.size(); ++i)
+  {
+    data[i] = static_cast<byte>(i * 131 + 7);
+  }
+  for (size_t offset = 0; offset < 8; ++offset)
+  {
+    for (size_t size = 0; offset + size <= 80; ++size)
+    {
+      std::span<const byte> piece(data.data() + offset, size);
+      uint32_t expected = crc32c::extend_portable(0, piece);
+      ASSERT_EQ(crc32c::compute(piece), expected);
+      ASSERT_EQ(crc32c::extend(crc32c::extend(0, piece.first(size / 3)), piece.subspan(size / 3)), expected);
+    }
+  }
+  EXPECT_EQ(crc32c::compute(data), crc32c::extend_portable(0, data));
+}
+
+TEST(CommonTest, HexCodecMatchesPortableAndRejectsInvalidInput)
+{
+  bytes check = {0x00, 0x01, 0x7f, 0x80, 0xab, 0xff};
+  EXPECT_EQ(hex::encode(check), "00017f80abff");
+  EXPECT_EQ(hex::decode("00017F80aBfF"), check);
+
+  // Every length and alignment around the 16- and 32-byte vector paths
+  bytes data(200);
+  for (size_t i = 0; i < data.size(); ++i)
+  {
+    data[i] = static_cast<byte>(i * 131 + 7);
+  }
+  // Every implementation the CPU supports, not just the one dispatched to
+  std::vector<hex::Implementation> implementations = hex::implementations();
+  ASSERT_STREQ(implementations.front().name, hex::instruction_set());
+  ASSERT_STREQ(implementations.back().name, "portable");
+  for (const auto &implementation : implementations)
+  {
+    for (size_t offset = 0; offset < 4; ++offset)
+    {
+      for (size_t size = 0; offset + size <= 140; ++size)
+      {
+        std::span<const byte> piece(data.data() + offset, size);
+        std::string expected(hex::encoded_size(size), '\0');
+        hex::encode_portable(piece, expected.data());
+        std::string encoded(hex::encoded_size(size), '\0');
+        ASSERT_EQ(implementation.encode(piece, encoded.data()), encoded.data() + encoded.size());
+        ASSERT_EQ(encoded, expected) << implementation.name;
+
+        std::string upper = expected;
+        std::ranges::transform(upper, upper.begin(), [](char c)
+                               { return static_cast<char>(std::toupper(c)); });
+        bytes decoded(size);
+        for (const std::string &text : {expected, upper})
+        {
+          ASSERT_TRUE(implementation.decode(text, decoded.data())) << implementation.name;
+          ASSERT_TRUE(std::equal(decoded.begin(), decoded.end(), piece.begin())) << implementation.name;
+        }
+      }
+    }
+
+    // A bad character is caught wherever it lands in a vector
+    std::string text = hex::encode(data);
+    bytes out(data.size());
+    for (size_t i = 0; i < text.size(); i += 13)
+    {
+      for (char bad : {'g', 'G', '/', ':', '@', '`', ' ', '\xff'})
+      {
+        std::string corrupt = text;
+        corrupt[i] = bad;
+        ASSERT_FALSE(implementation.decode(corrupt, out.data())) << implementation.name << " " << i << " " << bad;
+      }
+    }
+  }
+  EXPECT_FALSE(hex::decode("abc").has_value());
+  EXPECT_EQ(hex::decode(""), bytes{});
+}
+
+TEST(CommonTest, ThreadPoolRunsEveryIndexOnce)
+{
+  ThreadPool pool(3);
+  std::vector<std::atomic<int>> runs(10000);
+  pool.parallel_for(runs.size(), 7, [&](size_t begin, size_t end)
+                    {
+    EXPECT_LT(begin, end);
+    for (size_t i = begin; i < end; ++i)
+    {
+      ++runs[i];
+    } });
+  EXPECT_TRUE(std::all_of(runs.begin(), runs.end(), [](const std::atomic<int> &count)
+                          { return count == 1; }));
+
+  // Nested calls make progress even with every worker busy
+  std::atomic<size_t> total = 0;
+  pool.parallel_for(8, 1, [&](size_t begin, size_t end)
+                    { pool.parallel_for(100, 1, [&](size_t inner_begin, size_t inner_end)
+                                        { total += (end - begin) * (inner_end - inner_begin); }); });
+  EXPECT_EQ(total, 800u);
+  pool.parallel_for(0, 1, [](size_t, size_t)
+                    { ADD_FAILURE(); });
+}
+
+TEST(ValueChainTest, ValueBlockViewReadsSerializedBlockInPlace)
+{
+  PrivateKey private_key = cryptography::generate_private_key();
+  PublicKey public_key = cryptography::derive_public_key(private_key);
+  PublicKey recipient = cryptography::derive_public_key(cryptography::generate_private_key());
+  std::vector<Transaction> transactions;
+  transactions.emplace_back(recipient, 50);
+  for (uint64_t amount = 1; amount <= 3; ++amount)
+  {
+    Transaction transaction(public_key, recipient, amount, bytes(amount * 10, static_cast<byte>(amount)));
+    transaction.set_signature(cryptography::sign_message(transaction.get_data_to_sign(), private_key));
+    transactions.push_back(transaction);
+  }
+  Hash time_block_hash = cryptography::sha256(bytes{1, 2, 3});
+  ValueBlock block(Hash{}, time_block_hash, 1234, transactions, public_key);
+  block.set_signature(cryptography::sign_message(block.get_data_to_sign(), private_key));
+  bytes serialized = block.serialize();
+
+  auto view = ValueBlockView::parse(serialized);
+  ASSERT_TRUE(view);
+  EXPECT_TRUE(view->hash_matches());
+  EXPECT_TRUE(std::ranges::equal(view->hash(), block.get_hash()));
+  EXPECT_TRUE(std::ranges::equal(view->time_block_hash(), time_block_hash));
+  EXPECT_EQ(view->time(), 1234u);
+  EXPECT_TRUE(std::ranges::equal(view->public_key(), public_key));
+  EXPECT_TRUE(std::ranges::equal(view->data_to_sign(), block.get_data_to_sign()));
+  ASSERT_EQ(view->transaction_count(), transactions.size());
+  for (size_t i = 0; i < transactions.size(); ++i)
+  {
+    const TransactionView &transaction = view->transaction(i);
+    // Views point into the block's own bytes
+    EXPECT_GE(transaction.serialized().data(), serialized.data());
+    EXPECT_TRUE(std::ranges::equal(transaction.serialized(), transactions[i].serialize()));
+    EXPECT_EQ(transaction.amount(), transactions[i].get_amount());
+    EXPECT_TRUE(std::ranges::equal(transaction.data(), transactions[i].get_data()));
+    EXPECT_TRUE(std::ranges::equal(transaction.data_to_sign(), transactions[i].get_data_to_sign()));
+    EXPECT_EQ(transaction.is_coinbase_transaction(), i == 0);
+    EXPECT_TRUE(transaction.hash_matches());
+    EXPECT_TRUE(transaction.verify());
+    EXPECT_EQ(transaction.materialize(), transactions[i]);
+  }
+  EXPECT_EQ(view->materialize().serialize(), serialized);
+
+  // Damage is caught by the hash check, bad framing by parse itself
+  bytes damaged = serialized;
+  damaged[100] ^= 0x01;
+  ASSERT_TRUE(ValueBlockView::parse(damaged));
+  EXPECT_FALSE(ValueBlockView::parse(damaged)->hash_matches());
+  EXPECT_FALSE(ValueBlockView::parse(std::span<const byte>(serialized).first(serialized.size() - 1)));
+  bytes extended = serialized;
+  extended.push_back(0);
+  EXPECT_FALSE(ValueBlockView::parse(extended));
+  ValueBlock decoded;
+  EXPECT_FALSE(decoded.deserialize(extended));
+  ASSERT_TRUE(decoded.deserialize(serialized));
+  EXPECT_EQ(decoded.get_transactions(), transactions);
+}
+
+TEST(ValueChainTest, BlocksSerializeIntoPreallocatedBuffers)
+{
+  PrivateKey private_key = cryptography::generate_private_key();
+  PublicKey public_key = cryptography::derive_public_key(private_key);
+  Transaction coinbase(public_key, 50);
+  Transaction transfer(public_key, public_key, 7, bytes(33, 0xab));
+  transfer.set_signature(cryptography::sign_message(transfer.get_data_to_sign(), private_key));
+  ValueBlock value_block(Hash{}, Hash{}, 99, {coinbase, transfer}, public_key);
+  value_block.set_signature(cryptography::sign_message(value_block.get_data_to_sign(), private_key));
+  TimeBlock time_block(Hash{}, 99, public_key);
+  time_block.set_signature(cryptography::sign_message(time_block.get_data_to_sign(), private_key));
+
+  auto check = [](const auto &object)
+  {
+    bytes serialized = object.serialize();
+    EXPECT_EQ(object.serialized_size(), serialized.size());
+
+    // Writes exactly serialized_size() bytes and leaves the rest alone
+    bytes buffer(object.serialized_size() + 8, 0xee);
+    ASSERT_TRUE(object.serialize_into(buffer));
+    EXPECT_TRUE(std::equal(serialized.begin(), serialized.end(), buffer.begin()));
+    EXPECT_TRUE(std::all_of(buffer.begin() + serialized.size(), buffer.end(), [](byte b)
+                            { return b == 0xee; }));
+    EXPECT_FALSE(object.serialize_into(std::span<byte>(buffer).first(serialized.size() - 1)));
+
+    // The signed fields lead the serialization, and the hash covers them plus the signature
+    auto data_to_sign = object.get_data_to_sign();
+    EXPECT_TRUE(std::equal(data_to_sign.begin(), data_to_sign.end(), serialized.begin()));
+    EXPECT_EQ(cryptography::sha256(std::span<const byte>(serialized).first(data_to_sign.size() + SIGNATURE_SIZE)),
+              object.get_hash());
+  };
+  check(coinbase);
+  check(transfer);
+  check(value_block);
+  check(time_block);
+  EXPECT_EQ(transfer.serialized_size(), TransactionView::FIXED_SIZE + 33);
+  EXPECT_EQ(time_block.serialized_size(), TimeBlock::SERIALIZED_SIZE);
+}
+
+TEST(ValueChainTest, SchemasDefineLayoutsAndRejectMalformedInput)
+{
+  // Fixed layouts are resolved at compile time
+  static_assert(TimeBlock::Schema::FIXED);
+  static_assert(TimeBlock::Schema::offset<1>() == HASH_SIZE);
+  static_assert(TimeBlock::Schema::offset<TimeBlock::Schema::SIGNED_COUNT>() == HASH_SIZE + 8 + PUBLIC_KEY_SIZE);
+  static_assert(TimeBlock::SERIALIZED_SIZE == 168);
+  static_assert(!Transaction::Schema::FIXED);
+  static_assert(Transaction::Schema::offset<3>() == 2 * PUBLIC_KEY_SIZE + 8);
+
+  PrivateKey private_key = cryptography::generate_private_key();
+  PublicKey public_key = cryptography::derive_public_key(private_key);
+  TimeBlock time_block(Hash{}, 42, public_key);
+  time_block.set_signature(cryptography::sign_message(time_block.get_data_to_sign(), private_key));
+  TimeBlock decoded_time_block;
+  ASSERT_TRUE(decoded_time_block.deserialize(time_block.serialize()));
+  EXPECT_EQ(decoded_time_block.get_hash(), time_block.get_hash());
+  EXPECT_EQ(decoded_time_block.get_time(), 42u);
+
+  // Integers are little-endian on the wire, whatever the host's byte order
+  TimeBlock ordered(Hash{}, 0x0102030405060708ULL, public_key);
+  bytes ordered_bytes = ordered.serialize();
+  const byte *time_field = ordered_bytes.data() + TimeBlock::Schema::offset<1>();
+  EXPECT_EQ(bytes(time_field, time_field + 8), (bytes{8, 7, 6, 5, 4, 3, 2, 1}));
+  uint64_t time_value = 0;
+  serialization::read_value(time_field, time_value);
+  EXPECT_EQ(time_value, 0x0102030405060708ULL);
+
+  Transaction transaction(public_key, public_key, 5, bytes{1, 2, 3});
+  transaction.set_signature(cryptography::sign_message(transaction.get_data_to_sign(), private_key));
+  bytes serialized = transaction.serialize();
+  Transaction decoded;
+  ASSERT_TRUE(decoded.deserialize(serialized));
+  EXPECT_EQ(decoded, transaction);
+
+  // A data length running past the end, or short of it, is rejected
+  bytes overlong = serialized;
+  overlong[Transaction::Schema::offset<3>()] = 200;
+  EXPECT_FALSE(decoded.deserialize(overlong));
+  bytes underlong = serialized;
+  underlong[Transaction::Schema::offset<3>()] = 2;
+  EXPECT_FALSE(decoded.deserialize(underlong));
+  EXPECT_EQ(decoded, transaction); // Failed reads leave the object alone
+
+  // A transaction count the block could not hold is rejected before allocating
+  ValueBlock block(Hash{}, Hash{}, 1, {transaction}, public_key);
+  bytes block_bytes = block.serialize();
+  ValueBlock decoded_block;
+  ASSERT_TRUE(decoded_block.deserialize(block_bytes));
+  EXPECT_EQ(decoded_block.get_hash(), block.get_hash());
+  uint64_t huge_count = UINT64_MAX / 2;
+  std::memcpy(block_bytes.data() + ValueBlock::Schema::offset<7>(), &huge_count, sizeof(huge_count));
+  EXPECT_FALSE(decoded_block.deserialize(block_bytes));
+}
+
+TEST(ValueChainTest, CompactFormatRoundTripsAlongsideOriginal)
+{
+  using serialization::Format;
+
+  // LEB128 boundaries, and rejection of padded or oversized encodings
+  for (uint64_t value : {uint64_t{0}, uint64_t{127}, uint64_t{128}, uint64_t{16383}, uint64_t{16384}, UINT64_MAX})
+  {
+    byte buffer[serialization::MAX_VARINT_SIZE];
+    byte *end = serialization::write_varint(buffer, value);
+    EXPECT_EQ(static_cast<size_t>(end - buffer), serialization::varint_size(value));
+    std::span<const byte> in(buffer, end);
+    uint64_t decoded = 0;
+    ASSERT_TRUE(serialization::read_varint(in, decoded));
+    EXPECT_EQ(decoded, value);
+    EXPECT_TRUE(in.empty());
+  }
+  const byte padded[] = {0x85, 0x00};
+  const byte oversized[] = {0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x02};
+  const byte truncated[] = {0x80};
+  for (std::span<const byte> in : {std::span<const byte>(padded), std::span<const byte>(oversized), std::span<const byte>(truncated)})
+  {
+    uint64_t decoded = 0;
+    EXPECT_FALSE(serialization::read_varint(in, decoded));
+  }
+
+  PrivateKey private_key = cryptography::generate_private_key();
+  PublicKey public_key = cryptography::derive_public_key(private_key);
+  Transaction transfer(public_key, public_key, 10);
+  transfer.set_signature(cryptography::sign_message(transfer.get_data_to_sign(), private_key));
+  Transaction with_data(public_key, public_key, 300, bytes(200, 0x02));
+  with_data.set_signature(cryptography::sign_message(with_data.get_data_to_sign(), private_key));
+  ValueBlock block(Hash{}, Hash{}, GENESIS_TIME, {Transaction(public_key, 50), transfer, with_data}, public_key);
+  block.set_signature(cryptography::sign_message(block.get_data_to_sign(), private_key));
+
+  // A plain transfer drops from 176 to 163 bytes
+  bytes compact = transfer.serialize(Format::v2);
+  EXPECT_EQ(transfer.serialize().size(), 176u);
+  EXPECT_EQ(compact.size(), 163u);
+  EXPECT_EQ(compact.size(), transfer.serialized_size(Format::v2));
+  EXPECT_EQ(compact[0], serialization::FORMAT_V2_TAG);
+  EXPECT_EQ(Transaction::Schema::detect(compact), Format::v2);
+  EXPECT_EQ(Transaction::Schema::detect(transfer.serialize()), Format::v1);
+
+  // Either encoding decodes to the same object, with the same hash
+  auto check = [](const auto &object, auto decoded)
+  {
+    bytes original = object.serialize(Format::v1);
+    bytes v2 = object.serialize(Format::v2);
+    ASSERT_TRUE(decoded.deserialize(v2));
+    EXPECT_EQ(decoded.get_hash(), object.get_hash());
+    EXPECT_EQ(decoded.serialize(), original);
+    decoded.compute_hash();
+    EXPECT_EQ(decoded.get_hash(), object.get_hash());
+    ASSERT_TRUE(decoded.deserialize(original));
+    EXPECT_EQ(decoded.serialize(Format::v2), v2);
+
+    // Truncated or extended v2 encodings are rejected
+    EXPECT_FALSE(decoded.deserialize(std::span<const byte>(v2).first(v2.size() - 1)));
+    bytes extended = v2;
+    extended.push_back(0);
+    EXPECT_FALSE(decoded.deserialize(extended));
+  };
+  check(with_data, Transaction());
+  check(block, ValueBlock());
+  EXPECT_LT(block.serialized_size(Format::v2), block.serialized_size());
+  // Nanosecond times need a 9-byte varint, so time blocks grow slightly
+  TimeBlock time_block(Hash{}, GENESIS_TIME, public_key);
+  check(time_block, TimeBlock());
+  EXPECT_EQ(time_block.serialized_size(Format::v2), 1 + TimeBlock::SERIALIZED_SIZE - 8 + 9);
+
+  // Storage writes the compact format and reads either
+  fs::path directory = fs::temp_directory_path() / "coin_platform_compact_format_test";
+  fs::remove_all(directory);
+  {
+    SegmentStorage<ValueBlock> storage;
+    ASSERT_TRUE(storage.initialize(directory.string()));
+    ASSERT_TRUE(storage.store_block(block));
+  }
+  SegmentStorageOptions options;
+  options.format = Format::v2;
+  ValueBlock next(block.get_hash(), Hash{}, GENESIS_TIME + 1, {Transaction(public_key, 50)}, public_key);
+  {
+    SegmentStorage<ValueBlock> storage(options);
+    ASSERT_TRUE(storage.initialize(directory.string()));
+    ASSERT_TRUE(storage.store_block(next));
+    auto view = storage.get_block_view(next.get_hash());
+    ASSERT_TRUE(view);
+    EXPECT_TRUE(std::ranges::equal(view->data(), next.serialize(Format::v2)));
+  }
+  SegmentStorage<ValueBlock> reopened(options);
+  ASSERT_TRUE(reopened.initialize(directory.string()));
+  auto stored = reopened.get_block(block.get_hash());
+  ASSERT_TRUE(stored);
+  EXPECT_EQ(stored->get_transactions(), block.get_transactions());
+  stored = reopened.get_block(next.get_hash());
+  ASSERT_TRUE(stored);
+  EXPECT_EQ(stored->get_hash(), next.get_hash());
+  reopened.close();
+  fs::remove_all(directory);
+}
+
+TEST(ValueChainTest, CompactTransactionsAreRelayedAndAdmitted)
+{
+  PrivateKey private_key = cryptography::generate_private_key();
+  PublicKey public_key = cryptography::derive_public_key(private_key);
+  ValueChainConsensus consensus(nullptr, nullptr, nullptr, private_key);
+
+  // Encoded as a node running --block-format v2 broadcasts it; a plain
+  // transfer is shorter than any v1 transaction
+  Transaction transfer(public_key, public_key, 10);
+  transfer.set_signature(cryptography::sign_message(transfer.get_data_to_sign(), private_key));
+  bytes payload(transfer.serialized_size(serialization::Format::v2));
+  transfer.serialize_into(payload, serialization::Format::v2);
+  ASSERT_LT(payload.size(), Transaction::Schema::MIN_SIZE);
+
+  Transaction received;
+  ASSERT_TRUE(received.deserialize(payload));
+  EXPECT_EQ(received, transfer);
+  EXPECT_TRUE(consensus.add_transaction(received));
+
+  // Damage is still caught after decoding
+  payload[1 + 2 * PUBLIC_KEY_SIZE] ^= 0x01; // The amount's varint
+  ASSERT_TRUE(received.deserialize(payload));
+  EXPECT_FALSE(consensus.add_transaction(received));
+  EXPECT_FALSE(received.deserialize(std::span<const byte>(payload).first(payload.size() - 1)));
+}
+
+TEST(ValueChainTest, CachedEncodingsServeSigningHashingAndSerialization)
+{
+  PrivateKey private_key = cryptography::generate_private_key();
+  PublicKey public_key = cryptography::derive_public_key(private_key);
+  Transaction transfer(public_key, public_key, 5, bytes(40, 0x11));
+  ValueBlock block(Hash{}, Hash{}, GENESIS_TIME, {Transaction(public_key, 50), transfer}, public_key);
+
+  // The preimage is a view of the cached encoding, not a fresh copy
+  std::span<const byte> preimage = transfer.get_data_to_sign();
+  EXPECT_EQ(preimage.data(), transfer.get_data_to_sign().data());
+  EXPECT_EQ(block.get_data_to_sign().data(), block.get_data_to_sign().data());
+
+  // Signing patches the encoding in place and the hash follows it
+  auto check = [&](auto &object)
+  {
+    Hash unsigned_hash = object.get_hash();
+    object.set_signature(cryptography::sign_message(object.get_data_to_sign(), private_key));
+    bytes serialized = object.serialize();
+    EXPECT_NE(object.get_hash(), unsigned_hash);
+    size_t hashed_size = object.get_data_to_sign().size() + SIGNATURE_SIZE;
+    EXPECT_EQ(object.get_hash(), cryptography::sha256(std::span<const byte>(serialized).first(hashed_size)));
+    EXPECT_TRUE(std::ranges::equal(object.get_data_to_sign(), std::span<const byte>(serialized).first(object.get_data_to_sign().size())));
+    EXPECT_TRUE(cryptography::verify_signature(object.get_data_to_sign(), object.get_signature(), public_key));
+
+    // Decoding either format restores an encoding that reproduces the input
+    for (serialization::Format format : {serialization::Format::v1, serialization::Format::v2})
+    {
+      std::remove_cvref_t<decltype(object)> decoded;
+      ASSERT_TRUE(decoded.deserialize(object.serialize(format)));
+      EXPECT_EQ(decoded.serialize(), serialized);
+      EXPECT_EQ(decoded.get_hash(), object.get_hash());
+      EXPECT_TRUE(std::ranges::equal(decoded.get_data_to_sign(), object.get_data_to_sign()));
+    }
+  };
+  check(transfer);
+  check(block);
+  TimeBlock time_block(Hash{}, GENESIS_TIME, public_key);
+  check(time_block);
+
+  // A block copies the encodings of the transactions it was built from
+  ValueBlock rebuilt(Hash{}, Hash{}, GENESIS_TIME, {transfer}, public_key);
+  auto view = ValueBlockView::parse(rebuilt.serialize());
+  ASSERT_TRUE(view);
+  EXPECT_TRUE(std::ranges::equal(view->transaction(0).serialized(), transfer.serialize()));
+  EXPECT_EQ(view->transaction(0).materialize(), transfer);
+}
+
+TEST(ValueChainTest, MerkleRootCommitsHeaderToTransactions)
+{
+  // Odd nodes move up unpaired; large levels hash in parallel to the same root
+  std::vector<Hash> leaves(5001);
+  for (size_t i = 0; i < leaves.size(); ++i)
+  {
+    leaves[i] = cryptography::sha256(bytes{static_cast<byte>(i), static_cast<byte>(i >> 8)});
+  }
+  auto leaf = [](const Hash &hash)
+  {
+    bytes preimage = {0x00};
+    preimage.insert(preimage.end(), hash.begin(), hash.end());
+    return cryptography::sha256(preimage);
+  };
+  EXPECT_EQ(cryptography::merkle_root({}), Hash{});
+  EXPECT_EQ(cryptography::merkle_root(std::span(leaves).first(1)), leaf(leaves[0]));
+  EXPECT_EQ(cryptography::merkle_leaf(leaves[0]), leaf(leaves[0]));
+  bytes pair = {0x01};
+  pair.insert(pair.end(), leaves[0].begin(), leaves[0].end());
+  pair.insert(pair.end(), leaves[1].begin(), leaves[1].end());
+  EXPECT_EQ(cryptography::merkle_parent(leaves[0], leaves[1]), cryptography::sha256(pair));
+  EXPECT_EQ(cryptography::merkle_root(std::span(leaves).first(3)),
+            cryptography::merkle_parent(cryptography::merkle_parent(leaf(leaves[0]), leaf(leaves[1])), leaf(leaves[2])));
+
+  // An inner node passed off as a leaf does not reproduce the root
+  std::vector<Hash> folded = {cryptography::merkle_parent(leaf(leaves[0]), leaf(leaves[1])), leaves[2]};
+  EXPECT_NE(cryptography::merkle_root(folded), cryptography::merkle_root(std::span(leaves).first(3)));
+
+  std::vector<Hash> level;
+  for (const Hash &hash : leaves)
+  {
+    level.push_back(leaf(hash));
+  }
+  while (level.size() > 1)
+  {
+    std::vector<Hash> parents;
+    for (size_t i = 0; i + 1 < level.size(); i += 2)
+    {
+      parents.push_back(cryptography::merkle_parent(level[i], level[i + 1]));
+    }
+    if (level.size() % 2 == 1)
+    {
+      parents.push_back(level.back());
+    }
+    level = std::move(parents);
+  }
+  EXPECT_EQ(cryptography::merkle_root(leaves), level[0]);
+
+  PrivateKey private_key = cryptography::generate_private_key();
+  PublicKey public_key = cryptography::derive_public_key(private_key);
+  std::vector<Transaction> transactions = {Transaction(public_key, 50)};
+  for (uint64_t amount = 1; amount <= 4; ++amount)
+  {
+    transactions.emplace_back(public_key, public_key, amount, bytes(amount * 100, 0x5a));
+    transactions.back().set_signature(cryptography::sign_message(transactions.back().get_data_to_sign(), private_key));
+  }
+  ValueBlock block(Hash{}, Hash{}, GENESIS_TIME, transactions, public_key);
+  block.set_signature(cryptography::sign_message(block.get_data_to_sign(), private_key));
+  std::vector<Hash> hashes;
+  for (const Transaction &transaction : transactions)
+  {
+    hashes.push_back(transaction.get_hash());
+  }
+  EXPECT_EQ(block.get_merkle_root(), cryptography::merkle_root(hashes));
+  EXPECT_TRUE(block.transactions_match_root());
+
+  // The header leads the block and is all the hash and signature cover
+  bytes serialized = block.serialize();
+  auto view = ValueBlockView::parse(serialized);
+  ASSERT_TRUE(view);
+  EXPECT_TRUE(std::ranges::equal(view->header(), std::span(serialized).first(ValueBlock::HEADER_SIZE)));
+  EXPECT_TRUE(std::ranges::equal(view->merkle_root(), block.get_merkle_root()));
+  EXPECT_EQ(cryptography::sha256(view->header().first(ValueBlock::HEADER_SIZE - HASH_SIZE)), block.get_hash());
+  EXPECT_TRUE(view->transactions_match_root());
+
+  // Changing a transaction leaves the header intact but breaks the root
+  bytes tampered = serialized;
+  tampered[tampered.size() - HASH_SIZE - SIGNATURE_SIZE - 1] ^= 0x01;
+  auto tampered_view = ValueBlockView::parse(tampered);
+  ASSERT_TRUE(tampered_view);
+  EXPECT_TRUE(tampered_view->hash_matches());
+  EXPECT_FALSE(tampered_view->transactions_match_root());
+  ValueBlock tampered_block;
+  ASSERT_TRUE(tampered_block.deserialize(tampered));
+  EXPECT_EQ(tampered_block.get_hash(), block.get_hash());
+  EXPECT_FALSE(tampered_block.transactions_match_root());
+
+  // So does a consistently rehashed transaction
+  std::vector<Transaction> swapped = transactions;
+  swapped.back() = Transaction(public_key, public_key, 99);
+  ValueBlock other(Hash{}, Hash{}, GENESIS_TIME, swapped, public_key);
+  bytes spliced(serialized.begin(), serialized.begin() + ValueBlock::HEADER_SIZE);
+  bytes other_serialized = other.serialize();
+  spliced.insert(spliced.end(), other_serialized.begin() + ValueBlock::HEADER_SIZE, other_serialized.end());
+  ASSERT_TRUE(tampered_block.deserialize(spliced));
+  EXPECT_FALSE(tampered_block.transactions_match_root());
+
+  // The shipped genesis block commits to its coinbase the same way
+  ValueBlock genesis_block;
+  ASSERT_TRUE(genesis_block.deserialize(genesis::VALUE_CHAIN_GENESIS_BLOCK_DATA));
+  EXPECT_EQ(genesis_block.get_hash(), genesis::VALUE_CHAIN_GENESIS_HASH);
+  genesis_block.compute_hash();
+  EXPECT_EQ(genesis_block.get_hash(), genesis::VALUE_CHAIN_GENESIS_HASH);
+  EXPECT_TRUE(genesis_block.transactions_match_root());
+}
+
+TEST(ValueChainTest, InclusionProofsComeFromCachedTrees)
+{
+  // Every leaf of every width proves against the root, and only its own leaf does
+  for (size_t width = 1; width <= 19; ++width)
+  {
+    std::vector<Hash> leaves(width);
+    for (size_t i = 0; i < width; ++i)
+    {
+      leaves[i] = cryptography::sha256(bytes{static_cast<byte>(width), static_cast<byte>(i)});
+    }
+    cryptography::MerkleTree tree(leaves);
+    ASSERT_EQ(tree.root(), cryptography::merkle_root(leaves));
+    for (size_t i = 0; i < width; ++i)
+    {
+      cryptography::MerkleProof proof = tree.prove(i);
+      EXPECT_EQ(cryptography::MerkleProof::path_length(i, width), proof.siblings.size());
+      EXPECT_TRUE(proof.verify(leaves[i], tree.root()));
+      EXPECT_FALSE(proof.verify(leaves[(i + 1) % width], tree.root()) && width > 1);
+
+      cryptography::MerkleProof decoded;
+      bytes serialized = proof.serialize();
+      EXPECT_EQ(serialized[0], i); // Integers are little-endian on every host
+      EXPECT_EQ(serialized[8], width);
+      ASSERT_TRUE(decoded.deserialize(serialized));
+      EXPECT_TRUE(decoded.verify(leaves[i], tree.root()));
+      serialized.push_back(0);
+      EXPECT_FALSE(decoded.deserialize(serialized));
+    }
+  }
+  EXPECT_FALSE(cryptography::MerkleProof::path_length(5, 5));
+
+  PrivateKey private_key = cryptography::generate_private_key();
+  PublicKey public_key = cryptography::derive_public_key(private_key);
+  std::vector<Transaction> transactions = {Transaction(public_key, 50)};
+  for (uint64_t amount = 1; amount < 40; ++amount)
+  {
+    transactions.emplace_back(public_key, public_key, amount, bytes(64, static_cast<byte>(amount)));
+    transactions.back().set_signature(cryptography::sign_message(transactions.back().get_data_to_sign(), private_key));
+  }
+  ValueBlock block(Hash{}, Hash{}, GENESIS_TIME, transactions, public_key);
+  block.set_signature(cryptography::sign_message(block.get_data_to_sign(), private_key));
+  ValueBlock other(block.get_hash(), Hash{}, GENESIS_TIME + 1, {Transaction(public_key, 25)}, public_key);
+  other.set_signature(cryptography::sign_message(other.get_data_to_sign(), private_key));
+
+  fs::path directory = fs::temp_directory_path() / "coin_platform_proof_test";
+  fs::remove_all(directory);
+  auto storage = std::make_shared<SegmentStorage<ValueBlock>>();
+  ASSERT_TRUE(storage->initialize(directory.string()));
+  ASSERT_TRUE(storage->store_block(block));
+  ASSERT_TRUE(storage->store_block(other));
+
+  // One tree build serves every transaction in the block
+  TransactionProver prover(storage, 1);
+  for (const Transaction &transaction : transactions)
+  {
+    auto proof = prover.prove(block.get_hash(), transaction.get_hash());
+    ASSERT_TRUE(proof);
+    EXPECT_TRUE(proof->verify());
+    EXPECT_EQ(proof->get_block_hash(), block.get_hash());
+    EXPECT_EQ(proof->get_merkle_root(), block.get_merkle_root());
+
+    bytes serialized = proof->serialize();
+    EXPECT_LT(serialized.size(), 500u);
+    TransactionProof decoded;
+    ASSERT_TRUE(decoded.deserialize(serialized));
+    EXPECT_TRUE(decoded.verify());
+    EXPECT_EQ(decoded.get_transaction_hash(), transaction.get_hash());
+  }
+  CacheStats stats = prover.get_stats();
+  EXPECT_EQ(stats.misses, 1u);
+  EXPECT_EQ(stats.hits, transactions.size() - 1);
+  EXPECT_EQ(stats.entries, 1u);
+
+  // Proofs fail against a forged header or for a transaction moved elsewhere
+  bytes serialized = prover.prove(block.get_hash(), transactions[7].get_hash())->serialize();
+  bytes forged = serialized;
+  forged[ValueBlock::Schema::offset<2>()] ^= 0x01;
+  TransactionProof decoded;
+  ASSERT_TRUE(decoded.deserialize(forged));
+  EXPECT_FALSE(decoded.verify());
+  bytes moved = serialized;
+  moved[ValueBlock::HEADER_SIZE + HASH_SIZE] ^= 0x01; // Leaf index
+  ASSERT_TRUE(decoded.deserialize(moved));
+  EXPECT_FALSE(decoded.verify());
+
+  // Unknown blocks and transactions have no proof; the cache keeps max_trees blocks
+  EXPECT_FALSE(prover.prove(Hash{}, transactions[0].get_hash()));
+  EXPECT_FALSE(prover.prove(block.get_hash(), other.get_transactions()[0].get_hash()));
+  ASSERT_TRUE(prover.prove(other.get_hash(), other.get_transactions()[0].get_hash()));
+  stats = prover.get_stats();
+  EXPECT_EQ(stats.entries, 1u);
+  EXPECT_EQ(stats.evictions, 1u);
+
+  storage->close();
+  fs::remove_all(directory);
+}
+
+TEST(ValueChainTest, BatchVerificationFlagsEveryBadSignature)
+{
+  PrivateKey private_key = cryptography::generate_private_key();
+  PublicKey public_key = cryptography::derive_public_key(private_key);
+  PublicKey recipient = cryptography::derive_public_key(cryptography::generate_private_key());
+  std::vector<Transaction> transactions;
+  transactions.emplace_back(recipient, 50);
+  for (uint64_t amount = 1; amount <= 100; ++amount)
+  {
+    Transaction transaction(public_key, recipient, amount, bytes(amount % 9, static_cast<byte>(amount)));
+    transaction.set_signature(cryptography::sign_message(transaction.get_data_to_sign(), private_key));
+    transactions.push_back(transaction);
+  }
+
+  // Coinbase transactions carry no signature to check
+  std::vector<cryptography::SignatureCheck> checks = Transaction::signature_checks(transactions);
+  ASSERT_EQ(checks.size(), 100u);
+  std::vector<bool> valid = cryptography::verify_batch(checks);
+  EXPECT_EQ(std::count(valid.begin(), valid.end(), true), 100);
+  EXPECT_FALSE(cryptography::first_invalid_signature(checks).has_value());
+
+  checks[80].signature[0] ^= 0x01;
+  checks[37].message_hash[5] ^= 0x01;
+  valid = cryptography::verify_batch(checks);
+  for (size_t i = 0; i < checks.size(); ++i)
+  {
+    EXPECT_EQ(valid[i], i != 37 && i != 80) << i;
+  }
+  EXPECT_EQ(cryptography::first_invalid_signature(checks), 37u);
+  EXPECT_EQ(cryptography::first_invalid_signature(std::span(checks).subspan(40)), 40u);
+
+  EXPECT_TRUE(cryptography::verify_batch({}).empty());
+  EXPECT_FALSE(cryptography::first_invalid_signature({}).has_value());
+}
+
+TEST(ValueChainTest, SignatureCacheSkipsVerifiedTransactions)
+{
+  PrivateKey private_key = cryptography::generate_private_key();
+  Signer signer(private_key);
+  PublicKey recipient = cryptography::derive_public_key(cryptography::generate_private_key());
+  std::vector<Transaction> transactions;
+  transactions.emplace_back(recipient, 50);
+  for (uint64_t amount = 1; amount <= 10; ++amount)
+  {
+    Transaction transaction(signer.get_public_key(), recipient, amount);
+    transaction.set_signature(signer.sign(transaction.get_data_to_sign()));
+    transactions.push_back(transaction);
+  }
+
+  // Admission verified the even amounts; only the odd ones are left to check
+  SignatureCache cache(1024);
+  for (const Transaction &transaction : transactions)
+  {
+    if (!transaction.is_coinbase_transaction() && transaction.get_amount() % 2 == 0)
+    {
+      cache.insert(transaction.get_hash());
+    }
+  }
+  std::vector<cryptography::SignatureCheck> checks = Transaction::signature_checks(
+      transactions, [&](const Transaction &transaction)
+      { return cache.lookup(transaction.get_hash()); });
+  EXPECT_EQ(checks.size(), 5u);
+  EXPECT_FALSE(cryptography::first_invalid_signature(checks).has_value());
+  CacheStats stats = cache.get_stats();
+  EXPECT_EQ(stats.hits, 5u);
+  EXPECT_EQ(stats.misses, 5u);
+  EXPECT_EQ(stats.entries, 5u);
+
+  // Admission checks the cache without counting; only block validation does
+  EXPECT_TRUE(cache.contains(transactions[2].get_hash()));
+  EXPECT_FALSE(cache.contains(transactions[1].get_hash()));
+  stats = cache.get_stats();
+  EXPECT_EQ(stats.hits, 5u);
+  EXPECT_EQ(stats.misses, 5u);
+
+  // Bounded: concurrent inserts past capacity evict the oldest entries
+  SignatureCache small(64);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t)
+  {
+    threads.emplace_back([&, t]
+                         {
+      for (int i = 0; i < 500; ++i)
+      {
+        small.insert(cryptography::sha256(bytes{static_cast<byte>(t), static_cast<byte>(i), static_cast<byte>(i >> 8)}));
+      } });
+  }
+  for (std::thread &thread : threads)
+  {
+    thread.join();
+  }
+  stats = small.get_stats();
+  EXPECT_LE(stats.entries, 64u);
+  EXPECT_EQ(stats.entries + stats.evictions, 2000u);
+  Hash newest = cryptography::sha256(bytes{9, 9, 9});
+  small.insert(newest);
+  EXPECT_TRUE(small.contains(newest));
+}
+
+TEST(StorageTest, BlockIndexGrowsAndFindsEntries)
+{
+  BlockIndex<uint64_t> index(16);
+  for (uint64_t i = 0; i < 1000; ++i)
+  {
+    index.insert_or_assign(cryptography::sha256(bytes{static_cast<byte>(i), static_cast<byte>(i >> 8)}), i);
+  }
+  EXPECT_EQ(index.size(), 1000u);
+  for (uint64_t i = 0; i < 1000; ++i)
+  {
+    const uint64_t *value = index.find(cryptography::sha256(bytes{static_cast<byte>(i), static_cast<byte>(i >> 8)}));
+    ASSERT_NE(value, nullptr);
+    EXPECT_EQ(*value, i);
+  }
+  EXPECT_FALSE(index.contains(Hash{}));
+}
+
+TEST(StorageTest, BloomFilterHasNoFalseNegativesAndSurvivesReload)
+{
+  auto key = [](int i)
+  { return cryptography::sha256(bytes{static_cast<byte>(i), static_cast<byte>(i >> 8), 0x42}); };
+
+  BloomFilter filter(1000);
+  for (int i = 0; i < 1000; ++i)
+  {
+    filter.insert(key(i));
+  }
+  int false_positives = 0;
+  for (int i = 0; i < 1000; ++i)
+  {
+    EXPECT_TRUE(filter.may_contain(key(i)));
+    false_positives += filter.may_contain(key(i + 1000)) ? 1 : 0;
+  }
+  EXPECT_LT(false_positives, 50);
+
+  fs::path filename = fs::temp_directory_path() / "coin_platform_bloom_test.bloom";
+  ASSERT_TRUE(filter.save(filename.string(), 1234));
+  uint64_t watermark = 0;
+  auto loaded = BloomFilter::load(filename.string(), watermark);
+  ASSERT_TRUE(loaded.has_value());
+  EXPECT_EQ(watermark, 1234u);
+  EXPECT_EQ(loaded->size(), filter.size());
+  for (int i = 0; i < 1000; ++i)
+  {
+    EXPECT_EQ(loaded->may_contain(key(i + 1000)), filter.may_contain(key(i + 1000)));
+    EXPECT_TRUE(loaded->may_contain(key(i)));
+  }
+
+  // Damaged files are rejected instead of trusted
+  std::ifstream saved_file(filename, std::ios::binary);
+  std::vector<char> saved((std::istreambuf_iterator<char>(saved_file)), std::istreambuf_iterator<char>());
+  saved_file.close();
+  auto write_file = [&](const std::vector<char> &contents)
+  {
+    std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+    file.write(contents.data(), contents.size());
+  };
+  std::vector<char> flipped = saved;
+  flipped[100] ^= 0x10;
+  write_file(flipped);
+  EXPECT_FALSE(BloomFilter::load(filename.string(), watermark));
+  write_file(std::vector<char>(saved.begin(), saved.end() - 64));
+  EXPECT_FALSE(BloomFilter::load(filename.string(), watermark));
+  std::vector<char> huge = saved;
+  std::fill(huge.begin() + 8, huge.begin() + 16, static_cast<char>(0x7f)); // Capacity
+  write_file(huge);
+  EXPECT_FALSE(BloomFilter::load(filename.string(), watermark));
+  fs::remove(filename);
+
+  // SegmentStorage rebuilds a corrupt filter from its index
+  fs::path directory = fs::temp_directory_path() / "coin_platform_bloom_rebuild_test";
+  fs::remove_all(directory);
+  PublicKey public_key = cryptography::derive_public_key(cryptography::generate_private_key());
+  std::vector<TimeBlock> blocks;
+  for (int i = 0; i < 20; ++i)
+  {
+    blocks.emplace_back(Hash{}, i + 1, public_key);
+  }
+  {
+    SegmentStorage<TimeBlock> storage;
+    ASSERT_TRUE(storage.initialize(directory.string()));
+    ASSERT_TRUE(storage.store_blocks(blocks));
+    storage.close();
+  }
+  {
+    // Clear every bit of the filter but keep its header and checksum
+    size_t length = fs::file_size(directory / "blocks.bloom");
+    std::fstream file(directory / "blocks.bloom", std::ios::binary | std::ios::in | std::ios::out);
+    ASSERT_TRUE(file);
+    file.seekp(32);
+    file.write(std::string(length - 36, '\0').data(), length - 36);
+  }
+  SegmentStorage<TimeBlock> reopened;
+  ASSERT_TRUE(reopened.initialize(directory.string()));
+  for (const auto &block : blocks)
+  {
+    EXPECT_TRUE(reopened.block_exists(block.get_hash()));
+  }
+  reopened.close();
+  fs::remove_all(directory);
+}
+
+TEST(StorageTest, SegmentStorageRoundTripAndReopen)
+{
+  fs::path directory = fs::temp_directory_path() / "coin_platform_segment_storage_test";
+  fs::remove_all(directory);
+
+  PublicKey public_key = cryptography::derive_public_key(cryptography::generate_private_key());
+  std::vector<TimeBlock> blocks;
+  Hash previous_hash = {};
+  for (TimePoint time = 1; time <= 50; ++time)
+  {
+    blocks.emplace_back(previous_hash, time, public_key);
+    previous_hash = blocks.back().get_hash();
+  }
+
+  {
+    // Small segments force several rollovers
+    SegmentStorageOptions options;
+    options.segment_size = 1024;
+    SegmentStorage<TimeBlock> storage(options);
+    ASSERT_TRUE(storage.initialize(directory.string()));
+    for (const auto &block : blocks)
+    {
+      ASSERT_TRUE(storage.store_block(block));
+    }
+  }
+  // The Bloom filter is saved on close and reloaded below
+  EXPECT_TRUE(fs::exists(directory / "blocks.bloom"));
+
+  SegmentStorage<TimeBlock> reopened;
+  ASSERT_TRUE(reopened.initialize(directory.string()));
+  for (const auto &block : blocks)
+  {
+    auto stored = reopened.get_block(block.get_hash());
+    ASSERT_TRUE(stored);
+    EXPECT_EQ(stored->serialize(), block.serialize());
+  }
+  auto latest = reopened.get_latest_block();
+  ASSERT_TRUE(latest);
+  EXPECT_EQ(latest->get_hash(), blocks.back().get_hash());
+  EXPECT_FALSE(reopened.block_exists(Hash{}));
+
+  // Views stay valid after the storage is closed
+  auto view = reopened.get_block_view(blocks.front().get_hash());
+  ASSERT_TRUE(view);
+  reopened.close();
+  EXPECT_TRUE(std::ranges::equal(view->data(), blocks.front().serialize()));
+  auto materialized = view->materialize();
+  ASSERT_TRUE(materialized);
+  EXPECT_EQ(materialized->get_hash(), blocks.front().get_hash());
+
+  fs::remove_all(directory);
+}
+
+TEST(StorageTest, SegmentStorageGroupCommitsConcurrentWriters)
+{
+  fs::path directory = fs::temp_directory_path() / "coin_platform_group_commit_test";
+  fs::remove_all(directory);
+
+  PublicKey public_key = cryptography::derive_public_key(cryptography::generate_private_key());
+  constexpr int WRITERS = 4;
+  constexpr int BLOCKS_PER_WRITER = 25;
+  std::vector<std::vector<TimeBlock>> batches(WRITERS);
+  for (int writer = 0; writer < WRITERS; ++writer)
+  {
+    for (int i = 0; i < BLOCKS_PER_WRITER; ++i)
+    {
+      batches[writer].emplace_back(Hash{}, writer * 1000 + i + 1, public_key);
+    }
+  }
+
+  SegmentStorageOptions options;
+  options.sync_writes = true;
+  options.segment_size = 4096;
+  {
+    SegmentStorage<TimeBlock> storage(options);
+    ASSERT_TRUE(storage.initialize(directory.string()));
+    std::vector<std::thread> writers;
+    for (int writer = 0; writer < WRITERS; ++writer)
+    {
+      writers.emplace_back([&, writer]()
+                           {
+        // Half the writers use the batch API, half store one block at a time
+        if (writer % 2 == 0)
+        {
+          EXPECT_TRUE(storage.store_blocks(batches[writer]));
+        }
+        else
+        {
+          for (const auto &block : batches[writer])
+          {
+            EXPECT_TRUE(storage.store_block(block));
+          }
+        } });
+    }
+    for (auto &thread : writers)
+    {
+      thread.join();
+    }
+  }
+
+  SegmentStorage<TimeBlock> reopened(options);
+  ASSERT_TRUE(reopened.initialize(directory.string()));
+  for (const auto &batch : batches)
+  {
+    for (const auto &block : batch)
+    {
+      EXPECT_TRUE(reopened.block_exists(block.get_hash()));
+    }
+  }
+  reopened.close();
+  fs::remove_all(directory);
+}
+
+TEST(StorageTest, SegmentStorageReadsCommittedBlocksDuringAppends)
+{
+  fs::path directory = fs::temp_directory_path() / "coin_platform_concurrent_read_test";
+  fs::remove_all(directory);
+
+  PublicKey public_key = cryptography::derive_public_key(cryptography::generate_private_key());
+  std::vector<TimeBlock> blocks;
+  for (int i = 0; i < 200; ++i)
+  {
+    blocks.emplace_back(Hash{}, i + 1, public_key);
+  }
+
+  SegmentStorageOptions options;
+  options.segment_size = 8192;
+  SegmentStorage<TimeBlock> storage(options);
+  ASSERT_TRUE(storage.initialize(directory.string()));
+  ASSERT_TRUE(storage.store_block(blocks[0]));
+
+  std::atomic<bool> writing{true};
+  std::thread writer([&]()
+                     {
+    for (size_t i = 1; i < blocks.size(); ++i)
+    {
+      EXPECT_TRUE(storage.store_block(blocks[i]));
+    }
+    writing = false; });
+
+  // Every block a reader can see must be fully committed and decodable
+  std::vector<std::thread> readers;
+  for (int reader = 0; reader < 3; ++reader)
+  {
+    readers.emplace_back([&]()
+                         {
+      while (writing)
+      {
+        auto latest = storage.get_latest_block();
+        ASSERT_TRUE(latest.has_value());
+        EXPECT_TRUE(storage.block_exists(latest->get_hash()));
+        EXPECT_TRUE(storage.get_block(blocks[0].get_hash()).has_value());
+      } });
+  }
+  writer.join();
+  for (auto &thread : readers)
+  {
+    thread.join();
+  }
+
+  EXPECT_EQ(storage.get_latest_block()->get_hash(), blocks.back().get_hash());
+  LockStats stats = storage.get_lock_stats();
+  EXPECT_GE(stats.exclusive_acquisitions, blocks.size() - 1);
+  EXPECT_GT(stats.shared_acquisitions, 0u);
+  storage.close();
+  fs::remove_all(directory);
+}
+
+namespace
+{
+  // In-memory backend whose writes wait until the test opens the gate, and
+  // which refuses any batch holding a rejected block
+  class GatedStorage : public StorageInterface<TimeBlock>
+  {
+  public:
+    bool initialize(const std::string &) override { return true; }
+
+    bool store_block(const TimeBlock &block) override
+    {
+      return store_blocks(std::span<const TimeBlock>(&block, 1));
+    }
+
+    bool store_blocks(std::span<const TimeBlock> blocks) override
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      ++writes_started_;
+      cv_.notify_all();
+      cv_.wait(lock, [this]()
+               { return open_; });
+      for (const auto &block : blocks)
+      {
+        if (rejected_.contains(block.get_hash()))
+        {
+          return false;
+        }
+      }
+      for (const auto &block : blocks)
+      {
+        blocks_.insert_or_assign(block.get_hash(), block);
+        latest_ = block;
+      }
+      return true;
+    }
+
+    std::optional<TimeBlock> get_block(const Hash &block_hash) override
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      auto it = blocks_.find(block_hash);
+      return it == blocks_.end() ? std::nullopt : std::optional<TimeBlock>(it->second);
+    }
+
+    std::optional<TimeBlock> get_latest_block() override
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      return latest_;
+    }
+
+    bool block_exists(const Hash &block_hash) override
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      return blocks_.contains(block_hash);
+    }
+
+    void close() override {}
+
+    void open()
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      open_ = true;
+      cv_.notify_all();
+    }
+
+    void reject(const Hash &block_hash)
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      rejected_.insert(block_hash);
+    }
+
+    // Waits until count store calls have reached the backend
+    void wait_for_writes(size_t count)
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      cv_.wait(lock, [&]()
+               { return writes_started_ >= count; });
+    }
+
+  private:
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool open_ = false;
+    size_t writes_started_ = 0;
+    std::unordered_map<Hash, TimeBlock, HashHasher> blocks_;
+    std::unordered_set<Hash, HashHasher> rejected_;
+    std::optional<TimeBlock> latest_;
+  };
+}
+
+TEST(StorageTest, AsyncStorageWriterServesQueuedBlocksAndCompletesFutures)
+{
+  fs::path directory = fs::temp_directory_path() / "coin_platform_async_writer_test";
+  fs::remove_all(directory);
+
+  PublicKey public_key = cryptography::derive_public_key(cryptography::generate_private_key());
+  std::vector<TimeBlock> blocks;
+  for (int i = 0; i < 50; ++i)
+  {
+    blocks.emplace_back(Hash{}, i + 1, public_key);
+  }
+
+  auto backend = std::make_shared<SegmentStorage<TimeBlock>>();
+  AsyncStorageWriter<TimeBlock> writer(backend, 8);
+  ASSERT_TRUE(writer.initialize(directory.string()));
+
+  std::vector<std::future<bool>> stored;
+  for (const auto &block : blocks)
+  {
+    stored.push_back(writer.store_block_async(block));
+    // Queued blocks are readable before the writer gets to them
+    EXPECT_TRUE(writer.block_exists(block.get_hash()));
+    EXPECT_EQ(writer.get_latest_block()->get_hash(), block.get_hash());
+  }
+  for (auto &future : stored)
+  {
+    EXPECT_TRUE(future.get());
+  }
+
+  writer.flush();
+  EXPECT_EQ(backend->get_latest_block()->get_hash(), blocks.back().get_hash());
+  for (const auto &block : blocks)
+  {
+    EXPECT_TRUE(backend->block_exists(block.get_hash()));
+  }
+  writer.close();
+  fs::remove_all(directory);
+}
+
+TEST(StorageTest, AsyncStorageWriterReportsEachQueuedWrite)
+{
+  PublicKey public_key = cryptography::derive_public_key(cryptography::generate_private_key());
+  std::vector<TimeBlock> blocks;
+  for (TimePoint time = 1; time <= 4; ++time)
+  {
+    blocks.emplace_back(Hash{}, time, public_key);
+  }
+  auto backend = std::make_shared<GatedStorage>();
+  backend->reject(blocks[2].get_hash());
+  AsyncStorageWriter<TimeBlock> writer(backend, 16);
+  ASSERT_TRUE(writer.initialize(""));
+
+  // The first write holds the writer, so the other three queue up and
+  // reach the backend as one batch, which the rejected block fails
+  std::vector<std::future<bool>> stored;
+  stored.push_back(writer.store_block_async(blocks[0]));
+  backend->wait_for_writes(1);
+  for (size_t i = 1; i < blocks.size(); ++i)
+  {
+    stored.push_back(writer.store_block_async(blocks[i]));
+  }
+  backend->open();
+  EXPECT_TRUE(stored[0].get());
+  EXPECT_TRUE(stored[1].get());
+  EXPECT_FALSE(stored[2].get());
+  EXPECT_TRUE(stored[3].get());
+  EXPECT_TRUE(backend->block_exists(blocks[1].get_hash()));
+  EXPECT_FALSE(backend->block_exists(blocks[2].get_hash()));
+  EXPECT_TRUE(backend->block_exists(blocks[3].get_hash()));
+  writer.close();
+}
+
+TEST(StorageTest, ConsensusMovesOnWhileBlocksArePersisted)
+{
+  auto backend = std::make_shared<GatedStorage>();
+  auto writer = std::make_shared<AsyncStorageWriter<TimeBlock>>(backend, 16);
+  ASSERT_TRUE(writer->initialize(""));
+  PrivateKey private_key = cryptography::generate_private_key();
+  TimeChainConsensus consensus(writer, nullptr, private_key);
+
+  // handle_block returns with the write still held at the gate
+  Signer signer(private_key);
+  TimeBlock received(Hash{}, utilities::get_current_time() - 1000000000, signer.get_public_key());
+  received.set_signature(signer.sign(received.get_data_to_sign()));
+  consensus.handle_block(received);
+  backend->wait_for_writes(1);
+  EXPECT_TRUE(writer->block_exists(received.get_hash()));
+  EXPECT_FALSE(backend->block_exists(received.get_hash()));
+
+  // The next block builds on the queued one and is only handed back for
+  // relaying once it is stored
+  std::promise<TimeBlock> relayed;
+  while (!consensus.produce_block([&](const TimeBlock &block)
+                                  { relayed.set_value(block); }))
+  {
+  }
+  std::future<TimeBlock> relayed_block = relayed.get_future();
+  EXPECT_EQ(relayed_block.wait_for(std::chrono::milliseconds(50)), std::future_status::timeout);
+
+  backend->open();
+  writer->flush();
+  ASSERT_EQ(relayed_block.wait_for(std::chrono::seconds(0)), std::future_status::ready);
+  TimeBlock produced = relayed_block.get();
+  EXPECT_EQ(produced.get_previous_hash(), received.get_hash());
+  EXPECT_TRUE(backend->block_exists(received.get_hash()));
+  EXPECT_TRUE(backend->block_exists(produced.get_hash()));
+  writer->close();
+}
+
+TEST(StorageTest, SegmentStorageIndexesHeightsAcrossBranchSwitches)
+{
+  fs::path directory = fs::temp_directory_path() / "coin_platform_height_index_test";
+  fs::remove_all(directory);
+
+  PublicKey public_key = cryptography::derive_public_key(cryptography::generate_private_key());
+  auto extend = [&](std::vector<TimeBlock> &chain, Hash previous_hash, TimePoint first_time, int count)
+  {
+    for (int i = 0; i < count; ++i)
+    {
+      chain.emplace_back(previous_hash, first_time + i, public_key);
+      previous_hash = chain.back().get_hash();
+    }
+  };
+  std::vector<TimeBlock> main_chain;
+  extend(main_chain, Hash{}, 1, 100);
+  // A competing branch forking off after height 59 that ends up longer
+  std::vector<TimeBlock> branch;
+  extend(branch, main_chain[59].get_hash(), 1000, 50);
+
+  SegmentStorageOptions options;
+  options.memory_map = false; // Exercise the coalesced pread path
+  {
+    SegmentStorage<TimeBlock> storage(options);
+    ASSERT_TRUE(storage.initialize(directory.string()));
+    ASSERT_TRUE(storage.store_blocks(main_chain));
+    EXPECT_EQ(storage.get_latest_height(), 99u);
+    EXPECT_EQ(storage.get_block_by_height(42)->get_hash(), main_chain[42].get_hash());
+    ASSERT_TRUE(storage.store_blocks(branch));
+  }
+
+  for (bool memory_map : {false, true})
+  {
+    options.memory_map = memory_map;
+    SegmentStorage<TimeBlock> storage(options);
+    ASSERT_TRUE(storage.initialize(directory.string()));
+    EXPECT_EQ(storage.get_latest_height(), 109u);
+    EXPECT_EQ(storage.get_block_by_height(59)->get_hash(), main_chain[59].get_hash());
+    EXPECT_EQ(storage.get_block_by_height(60)->get_hash(), branch[0].get_hash());
+    EXPECT_FALSE(storage.get_block_by_height(110));
+
+    std::vector<Hash> scanned;
+    size_t visited = storage.scan(50, UINT64_MAX, [&](const TimeBlock &block)
+                                  {
+      scanned.push_back(block.get_hash());
+      return true; });
+    ASSERT_EQ(visited, 60u);
+    EXPECT_EQ(scanned.front(), main_chain[50].get_hash());
+    EXPECT_EQ(scanned.back(), branch.back().get_hash());
+    for (size_t i = 1; i < scanned.size(); ++i)
+    {
+      EXPECT_EQ(storage.get_block(scanned[i])->get_previous_hash(), scanned[i - 1]);
+    }
+    EXPECT_EQ(storage.scan(0, 200, [](const TimeBlock &)
+                           { return false; }),
+              1u);
+  }
+  fs::remove_all(directory);
+}
+
+TEST(StorageTest, SegmentStorageRecoversFromTornCommitsAndManifest)
+{
+  fs::path directory = fs::temp_directory_path() / "coin_platform_recovery_test";
+  fs::path before = fs::temp_directory_path() / "coin_platform_recovery_test_before";
+  fs::path after = fs::temp_directory_path() / "coin_platform_recovery_test_after";
+  for (const auto &path : {directory, before, after})
+  {
+    fs::remove_all(path);
+  }
+  auto read_file = [](const fs::path &path)
+  {
+    std::ifstream file(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(file), {});
+  };
+
+  PublicKey public_key = cryptography::derive_public_key(cryptography::generate_private_key());
+  std::vector<TimeBlock> blocks;
+  Hash previous_hash = {};
+  for (TimePoint time = 1; time <= 100; ++time)
+  {
+    blocks.emplace_back(previous_hash, time, public_key);
+    previous_hash = blocks.back().get_hash();
+  }
+  std::span<const TimeBlock> chain(blocks);
+  SegmentStorageOptions small_log;
+  small_log.segment_size = 1 << 20;
+
+  {
+    // Copying the files of an open storage captures what a crash would leave behind
+    SegmentStorage<TimeBlock> storage(small_log);
+    ASSERT_TRUE(storage.initialize(directory.string()));
+    ASSERT_TRUE(storage.store_blocks(chain.first(90)));
+    fs::copy(directory, before, fs::copy_options::recursive);
+    ASSERT_TRUE(storage.store_blocks(chain.subspan(90)));
+    fs::copy(directory, after, fs::copy_options::recursive);
+  }
+
+  // Tear the last commit by corrupting a byte in the middle of its records
+  fs::path segment = after / "segment_00000000.log";
+  std::string old_log = read_file(before / "segment_00000000.log");
+  std::string new_log = read_file(segment);
+  ASSERT_EQ(old_log.size(), new_log.size());
+  size_t commit_start = std::mismatch(old_log.begin(), old_log.end(), new_log.begin()).first - old_log.begin();
+  ASSERT_LT(commit_start, old_log.size());
+  {
+    std::fstream file(segment, std::ios::binary | std::ios::in | std::ios::out);
+    file.seekp(commit_start + 100);
+    file.put(static_cast<char>(new_log[commit_start + 100] ^ 0xFF));
+  }
+  {
+    SegmentStorage<TimeBlock> storage(small_log);
+    ASSERT_TRUE(storage.initialize(after.string()));
+    EXPECT_EQ(storage.get_latest_height(), 89u);
+    EXPECT_EQ(storage.get_latest_block()->get_hash(), blocks[89].get_hash());
+    EXPECT_FALSE(storage.block_exists(blocks[90].get_hash()));
+    // The discarded tail is overwritten by the next commit
+    ASSERT_TRUE(storage.store_blocks(chain.subspan(90)));
+  }
+  {
+    SegmentStorage<TimeBlock> storage(small_log);
+    ASSERT_TRUE(storage.initialize(after.string()));
+    EXPECT_EQ(storage.get_latest_height(), 99u);
+    EXPECT_EQ(storage.get_block(blocks[95].get_hash())->serialize(), blocks[95].serialize());
+  }
+
+  // Small segments write a checkpoint on every rollover; recovery replays
+  // the log after it and falls back to a full replay without a usable one
+  fs::remove_all(directory);
+  SegmentStorageOptions options;
+  options.segment_size = 1024;
+  {
+    SegmentStorage<TimeBlock> storage(options);
+    ASSERT_TRUE(storage.initialize(directory.string()));
+    for (const auto &block : blocks)
+    {
+      ASSERT_TRUE(storage.store_block(block));
+    }
+    EXPECT_TRUE(fs::exists(directory / "MANIFEST"));
+  }
+  for (int round = 0; round < 3; ++round)
+  {
+    if (round == 1)
+    {
+      std::fstream file(directory / "MANIFEST", std::ios::binary | std::ios::in | std::ios::out);
+      file.seekp(40);
+      file.put('\x7F');
+    }
+    else if (round == 2)
+    {
+      fs::remove(directory / "MANIFEST");
+    }
+    SegmentStorage<TimeBlock> storage(options);
+    ASSERT_TRUE(storage.initialize(directory.string()));
+    EXPECT_EQ(storage.get_latest_height(), 99u);
+    EXPECT_EQ(storage.get_block_by_height(50)->get_hash(), blocks[50].get_hash());
+    EXPECT_TRUE(storage.block_exists(blocks.front().get_hash()));
+  }
+
+  for (const auto &path : {directory, before, after})
+  {
+    fs::remove_all(path);
+  }
+}
+
+TEST(StorageTest, SegmentStorageAppendsManifestChunksOnRollover)
+{
+  fs::path directory = fs::temp_directory_path() / "coin_platform_manifest_chunks_test";
+  fs::path crashed = fs::temp_directory_path() / "coin_platform_manifest_chunks_test_crashed";
+  fs::remove_all(directory);
+  fs::remove_all(crashed);
+
+  PublicKey public_key = cryptography::derive_public_key(cryptography::generate_private_key());
+  auto extend = [&](std::vector<TimeBlock> &chain, Hash previous_hash, TimePoint first_time, int count)
+  {
+    for (int i = 0; i < count; ++i)
+    {
+      chain.emplace_back(previous_hash, first_time + i, public_key);
+      previous_hash = chain.back().get_hash();
+    }
+  };
+  std::vector<TimeBlock> main_chain;
+  extend(main_chain, Hash{}, 1, 60);
+  std::vector<TimeBlock> branch;
+  extend(branch, main_chain[30].get_hash(), 1000, 40);
+
+  SegmentStorageOptions options;
+  options.segment_size = 1024;
+  {
+    SegmentStorage<TimeBlock> storage(options);
+    ASSERT_TRUE(storage.initialize(directory.string()));
+    for (const auto &block : main_chain)
+    {
+      ASSERT_TRUE(storage.store_block(block));
+    }
+    // The branch rewrites heights that earlier chunks already recorded
+    for (const auto &block : branch)
+    {
+      ASSERT_TRUE(storage.store_block(block));
+    }
+    fs::copy(directory, crashed, fs::copy_options::recursive);
+  }
+
+  // Every rollover appended a chunk after the first full checkpoint
+  auto chunk_sizes = [](const fs::path &manifest)
+  {
+    std::ifstream file(manifest, std::ios::binary);
+    std::string contents(std::istreambuf_iterator<char>(file), {});
+    std::vector<uint64_t> sizes;
+    for (size_t position = 0; position + 24 <= contents.size();)
+    {
+      uint64_t body_size;
+      std::memcpy(&body_size, contents.data() + position + 16, sizeof(body_size));
+      sizes.push_back(24 + body_size);
+      position += 24 + body_size;
+    }
+    return sizes;
+  };
+  auto crashed_chunks = chunk_sizes(crashed / "MANIFEST");
+  ASSERT_GT(crashed_chunks.size(), 2u);
+  EXPECT_EQ(chunk_sizes(directory / "MANIFEST").size(), 1u); // Compacted on close
+
+  // A crash while appending tears the last chunk; the one before it still counts
+  fs::path torn = fs::temp_directory_path() / "coin_platform_manifest_chunks_test_torn";
+  fs::remove_all(torn);
+  fs::copy(crashed, torn, fs::copy_options::recursive);
+  fs::resize_file(torn / "MANIFEST", fs::file_size(torn / "MANIFEST") - 8);
+
+  for (const fs::path &path : {directory, crashed, torn})
+  {
+    SegmentStorage<TimeBlock> storage(options);
+    ASSERT_TRUE(storage.initialize(path.string()));
+    EXPECT_EQ(storage.get_latest_height(), 70u);
+    EXPECT_EQ(storage.get_block_by_height(30)->get_hash(), main_chain[30].get_hash());
+    EXPECT_EQ(storage.get_block_by_height(31)->get_hash(), branch[0].get_hash());
+    EXPECT_EQ(storage.get_block_by_height(70)->get_hash(), branch.back().get_hash());
+    EXPECT_TRUE(storage.block_exists(main_chain.back().get_hash()));
+    storage.close();
+    fs::remove_all(path);
+  }
+}
+
+TEST(StorageTest, SegmentStoragePublishesFlushedPrefixOfFailedCommit)
+{
+  fs::path directory = fs::temp_directory_path() / "coin_platform_failed_commit_test";
+  fs::remove_all(directory);
+
+  PublicKey public_key = cryptography::derive_public_key(cryptography::generate_private_key());
+  std::vector<TimeBlock> blocks;
+  Hash previous_hash = {};
+  for (TimePoint time = 1; time <= 60; ++time)
+  {
+    blocks.emplace_back(previous_hash, time, public_key);
+    previous_hash = blocks.back().get_hash();
+  }
+  std::span<const TimeBlock> chain(blocks);
+  SegmentStorageOptions options;
+  options.segment_size = 4096;
+
+  size_t stored = 0;
+  {
+    SegmentStorage<TimeBlock> storage(options);
+    ASSERT_TRUE(storage.initialize(directory.string()));
+    ASSERT_TRUE(storage.store_blocks(chain.first(5)));
+
+    // A directory in the way makes rolling over to the next segment fail
+    // after the records that fit in the first one have been committed
+    fs::create_directory(directory / "segment_00000001.log");
+    EXPECT_FALSE(storage.store_blocks(chain.subspan(5, 35)));
+    while (stored < 40 && storage.block_exists(blocks[stored].get_hash()))
+    {
+      ++stored;
+    }
+    ASSERT_GT(stored, 5u);
+    ASSERT_LT(stored, 40u);
+    EXPECT_EQ(storage.get_latest_height(), stored - 1);
+    EXPECT_EQ(storage.get_latest_block()->get_hash(), blocks[stored - 1].get_hash());
+
+    // Later commits continue from the published prefix
+    fs::remove(directory / "segment_00000001.log");
+    ASSERT_TRUE(storage.store_blocks(chain.subspan(stored)));
+  }
+
+  SegmentStorage<TimeBlock> reopened(options);
+  ASSERT_TRUE(reopened.initialize(directory.string()));
+  EXPECT_EQ(reopened.get_latest_height(), 59u);
+  for (const auto &block : blocks)
+  {
+    EXPECT_TRUE(reopened.block_exists(block.get_hash()));
+  }
+  reopened.close();
+  fs::remove_all(directory);
+}
+
+TEST(StorageTest, FileStoragePublishesWrittenPrefixOfFailedBatch)
+{
+  fs::path directory = fs::temp_directory_path() / "coin_platform_file_failed_batch_test";
+  fs::remove_all(directory);
+
+  PublicKey public_key = cryptography::derive_public_key(cryptography::generate_private_key());
+  std::vector<TimeBlock> blocks;
+  Hash previous_hash = {};
+  for (TimePoint time = 1; time <= 5; ++time)
+  {
+    blocks.emplace_back(previous_hash, time, public_key);
+    previous_hash = blocks.back().get_hash();
+  }
+
+  FileStorage<TimeBlock> storage;
+  ASSERT_TRUE(storage.initialize(directory.string()));
+  ASSERT_TRUE(storage.store_block(blocks[0]));
+
+  // A directory in the way of the fourth block's file fails the batch
+  // after the second and third blocks are on disk
+  fs::path blocked = directory / (hex::encode(blocks[3].get_hash()) + ".block.tmp");
+  fs::create_directory(blocked);
+  EXPECT_FALSE(storage.store_blocks(std::span<const TimeBlock>(blocks).subspan(1, 4)));
+  EXPECT_TRUE(storage.block_exists(blocks[1].get_hash()));
+  EXPECT_TRUE(storage.block_exists(blocks[2].get_hash()));
+  EXPECT_TRUE(storage.get_block(blocks[2].get_hash()).has_value());
+  EXPECT_FALSE(storage.block_exists(blocks[3].get_hash()));
+  EXPECT_FALSE(storage.block_exists(blocks[4].get_hash()));
+  EXPECT_EQ(storage.get_latest_block()->get_hash(), blocks[2].get_hash());
+
+  fs::remove(blocked);
+  ASSERT_TRUE(storage.store_blocks(std::span<const TimeBlock>(blocks).subspan(1)));
+  EXPECT_TRUE(storage.block_exists(blocks[4].get_hash()));
+  EXPECT_EQ(storage.get_latest_block()->get_hash(), blocks[4].get_hash());
+  storage.close();
+  fs::remove_all(directory);
+}
+
+TEST(StorageTest, IoUringEngineStoresAndScansLikePsync)
+{
+  fs::path directory = fs::temp_directory_path() / "coin_platform_io_uring_test";
+  fs::remove_all(directory);
+
+  PublicKey public_key = cryptography::derive_public_key(cryptography::generate_private_key());
+  std::vector<TimeBlock> blocks;
+  Hash previous_hash = {};
+  for (TimePoint time = 1; time <= 300; ++time)
+  {
+    blocks.emplace_back(previous_hash, time, public_key);
+    previous_hash = blocks.back().get_hash();
+  }
+
+  // Falls back to pread/pwrite where io_uring is unavailable, so this runs everywhere
+  SegmentStorageOptions options;
+  options.io_engine = IoEngine::io_uring;
+  options.memory_map = false;
+  options.sync_writes = true;
+  options.segment_size = 16 * 1024;
+  {
+    SegmentStorage<TimeBlock> storage(options);
+    ASSERT_TRUE(storage.initialize(directory.string()));
+    ASSERT_TRUE(storage.store_blocks(std::span<const TimeBlock>(blocks).first(100)));
+    for (size_t i = 100; i < blocks.size(); ++i)
+    {
+      ASSERT_TRUE(storage.store_block(blocks[i]));
+    }
+  }
+  for (IoEngine engine : {IoEngine::psync, IoEngine::io_uring})
+  {
+    options.io_engine = engine;
+    SegmentStorage<TimeBlock> storage(options);
+    ASSERT_TRUE(storage.initialize(directory.string()));
+    EXPECT_EQ(storage.get_block(blocks[150].get_hash())->serialize(), blocks[150].serialize());
+    EXPECT_EQ(storage.get_latest_block()->get_hash(), blocks.back().get_hash());
+    size_t height = 0;
+    size_t visited = storage.scan(0, UINT64_MAX, [&](const TimeBlock &block)
+                                  { return block.get_hash() == blocks[height++].get_hash(); });
+    EXPECT_EQ(visited, blocks.size());
+    EXPECT_EQ(height, blocks.size());
+  }
+  fs::remove_all(directory);
+
+  auto ring = IoUring::create(4);
+  if (!ring)
+  {
+    GTEST_SKIP() << "io_uring is not available";
+  }
+  // More operations than the ring has entries, with a sync in between
+  fs::path file_path = fs::temp_directory_path() / "coin_platform_io_uring_ring_test";
+  int fd = ::open(file_path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+  ASSERT_GE(fd, 0);
+  std::vector<bytes> chunks(10, bytes(4096));
+  std::vector<IoUring::Operation> writes;
+  for (size_t i = 0; i < chunks.size(); ++i)
+  {
+    std::fill(chunks[i].begin(), chunks[i].end(), static_cast<byte>(i + 1));
+    writes.push_back({IoUring::Opcode::write, fd, chunks[i].data(), chunks[i].size(), i * 4096});
+  }
+  writes.push_back({IoUring::Opcode::sync, fd});
+  EXPECT_TRUE(ring->execute(writes));
+
+  bytes contents(chunks.size() * 4096);
+  std::vector<IoUring::Operation> reads;
+  for (size_t i = 0; i < chunks.size(); ++i)
+  {
+    reads.push_back({IoUring::Opcode::read, fd, contents.data() + i * 4096, 4096, i * 4096});
+  }
+  EXPECT_TRUE(ring->execute(reads));
+  for (size_t i = 0; i < chunks.size(); ++i)
+  {
+    EXPECT_EQ(contents[i * 4096], static_cast<byte>(i + 1));
+    EXPECT_EQ(contents[i * 4096 + 4095], static_cast<byte>(i + 1));
+  }
+  // Reading past the end of the file fails instead of returning short data
+  IoUring::Operation past_end{IoUring::Opcode::read, fd, contents.data(), 4096, chunks.size() * 4096};
+  EXPECT_FALSE(ring->execute(std::span(&past_end, 1)));
+  // A failed batch is reaped completely, so the ring serves the next one
+  std::vector<IoUring::Operation> mixed = reads;
+  mixed[5].fd = -1;
+  EXPECT_FALSE(ring->execute(mixed));
+  std::fill(contents.begin(), contents.end(), byte(0));
+  EXPECT_TRUE(ring->execute(reads));
+  for (size_t i = 0; i < chunks.size(); ++i)
+  {
+    EXPECT_EQ(contents[i * 4096 + 100], static_cast<byte>(i + 1));
+  }
+  ::close(fd);
+  fs::remove(file_path);
+}
+
+TEST(StorageTest, SegmentStorageDetectsCorruptRecordsOnRead)
+{
+  fs::path directory = fs::temp_directory_path() / "coin_platform_checksum_test";
+  fs::remove_all(directory);
+
+  PublicKey public_key = cryptography::derive_public_key(cryptography::generate_private_key());
+  std::vector<TimeBlock> blocks;
+  Hash previous_hash = {};
+  for (TimePoint time = 1; time <= 20; ++time)
+  {
+    blocks.emplace_back(previous_hash, time, public_key);
+    previous_hash = blocks.back().get_hash();
+  }
+  SegmentStorageOptions options;
+  options.segment_size = 1 << 20;
+  {
+    SegmentStorage<TimeBlock> storage(options);
+    ASSERT_TRUE(storage.initialize(directory.string()));
+    ASSERT_TRUE(storage.store_blocks(blocks));
+  }
+
+  // Flip one payload bit of block 10 behind the storage's back; the
+  // checkpoint means the reopen below does not replay the damaged record
+  fs::path segment = directory / "segment_00000000.log";
+  std::string log;
+  {
+    std::ifstream file(segment, std::ios::binary);
+    log.assign(std::istreambuf_iterator<char>(file), {});
+  }
+  bytes payload = blocks[10].serialize();
+  auto position = std::search(log.begin(), log.end(), payload.begin(), payload.end(),
+                              [](char a, byte b)
+                              { return static_cast<byte>(a) == b; });
+  ASSERT_NE(position, log.end());
+  {
+    std::fstream file(segment, std::ios::binary | std::ios::in | std::ios::out);
+    file.seekp(position - log.begin() + payload.size() / 2);
+    file.put(static_cast<char>(log[position - log.begin() + payload.size() / 2] ^ 0x01));
+  }
+
+  for (bool memory_map : {true, false})
+  {
+    options.memory_map = memory_map;
+    SegmentStorage<TimeBlock> storage(options);
+    ASSERT_TRUE(storage.initialize(directory.string()));
+    EXPECT_TRUE(storage.block_exists(blocks[10].get_hash()));
+    EXPECT_FALSE(storage.get_block(blocks[10].get_hash()));
+    EXPECT_FALSE(storage.get_block_view(blocks[10].get_hash()));
+    EXPECT_EQ(storage.get_block(blocks[9].get_hash())->serialize(), blocks[9].serialize());
+    // A scan stops at the damaged record
+    EXPECT_EQ(storage.scan(0, UINT64_MAX, [](const TimeBlock &)
+                           { return true; }),
+              10u);
+    EXPECT_EQ(storage.scan(11, UINT64_MAX, [](const TimeBlock &)
+                           { return true; }),
+              9u);
+  }
+  fs::remove_all(directory);
+}
+
+TEST(StorageTest, CachingStorageServesTipAndEvictsByBytes)
+{
+  fs::path directory = fs::temp_directory_path() / "coin_platform_caching_storage_test";
+  fs::remove_all(directory);
+
+  PublicKey public_key = cryptography::derive_public_key(cryptography::generate_private_key());
+  TimeBlock first(Hash{}, 1, public_key);
+  TimeBlock second(first.get_hash(), 2, public_key);
+  size_t block_size = first.serialized_size();
+
+  // Room for exactly one block
+  CachingStorage<TimeBlock> storage(std::make_shared<SegmentStorage<TimeBlock>>(), block_size);
+  ASSERT_TRUE(storage.initialize(directory.string()));
+  ASSERT_TRUE(storage.store_block(first));
+  ASSERT_TRUE(storage.store_block(second));
+
+  auto latest = storage.get_latest_block();
+  ASSERT_TRUE(latest);
+  EXPECT_EQ(latest->get_hash(), second.get_hash());
+  ASSERT_TRUE(storage.get_block(first.get_hash())); // Evicted, read from the log
+
+  CacheStats stats = storage.get_stats();
+  EXPECT_EQ(stats.hits, 1u);
+  EXPECT_EQ(stats.misses, 1u);
+  EXPECT_EQ(stats.evictions, 2u);
+  EXPECT_EQ(stats.bytes, block_size);
+
+  storage.close();
+  fs::remove_all(directory);
+}
+
+TEST(StorageTest, CachingStorageTipFollowsConcurrentStores)
+{
+  fs::path directory = fs::temp_directory_path() / "coin_platform_caching_tip_test";
+  fs::remove_all(directory);
+
+  PublicKey public_key = cryptography::derive_public_key(cryptography::generate_private_key());
+  auto backend = std::make_shared<SegmentStorage<TimeBlock>>();
+  CachingStorage<TimeBlock> storage(backend, 1 << 20);
+  ASSERT_TRUE(storage.initialize(directory.string()));
+
+  std::vector<std::thread> writers;
+  for (int writer = 0; writer < 4; ++writer)
+  {
+    writers.emplace_back([&, writer]()
+                         {
+      for (int i = 0; i < 50; ++i)
+      {
+        EXPECT_TRUE(storage.store_block(TimeBlock(Hash{}, writer * 1000 + i + 1, public_key)));
+      } });
+  }
+  for (auto &thread : writers)
+  {
+    thread.join();
+  }
+
+  // The cached tip is whichever block the backend appended last
+  auto cached = storage.get_latest_block();
+  auto stored = backend->get_latest_block();
+  ASSERT_TRUE(cached && stored);
+  EXPECT_EQ(cached->get_hash(), stored->get_hash());
+
+  storage.close();
+  fs::remove_all(directory);
+}
+
 int main(int argc, char **argv)
 {
   ::testing::InitGoogleTest(&argc, argv);
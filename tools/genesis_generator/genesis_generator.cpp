@@ -57,7 +57,7 @@ namespace genesis
         Transaction coinbase_tx(PublicKey{}, public_key_, 50, reference_data);
 
         // Sign the coinbase transaction
-        bytes tx_data_to_sign = coinbase_tx.get_data_to_sign();
+        std::span<const byte> tx_data_to_sign = coinbase_tx.get_data_to_sign();
         Signature tx_signature = cryptography::sign_message(tx_data_to_sign, private_key_);
         coinbase_tx.set_signature(tx_signature);
 
@@ -68,7 +68,7 @@ namespace genesis
         ValueBlock genesis_value_block(previous_hash, time_block_hash, genesis_time, transactions, public_key_);
 
         // Sign the genesis ValueBlock
-        bytes value_block_data_to_sign = genesis_value_block.get_data_to_sign();
+        std::span<const byte> value_block_data_to_sign = genesis_value_block.get_data_to_sign();
         Signature block_signature = cryptography::sign_message(value_block_data_to_sign, private_key_);
         genesis_value_block.set_signature(block_signature);
 
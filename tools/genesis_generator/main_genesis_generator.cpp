@@ -1,6 +1,6 @@
 #include "genesis_generator.hpp"
 #include "../../src/common/types.hpp"
-#include "../../src/common/utilities.hpp"
+#include "../../src/common/hex.hpp"
 #include "../../src/cryptography/cryptography.hpp"
 #include <iostream>
 #include <fstream>
@@ -16,15 +16,15 @@ int main(int argc, char *argv[])
 
     // Convert private key hex string to bytes
     std::string private_key_hex = argv[1];
-    bytes private_key_bytes = utilities::hex_to_bytes(private_key_hex);
-    if (private_key_bytes.size() != PRIVATE_KEY_SIZE)
+    std::optional<bytes> private_key_bytes = hex::decode(private_key_hex);
+    if (!private_key_bytes || private_key_bytes->size() != PRIVATE_KEY_SIZE)
     {
-        std::cerr << "Invalid private key size." << std::endl;
+        std::cerr << "Invalid private key." << std::endl;
         return 1;
     }
 
     PrivateKey private_key;
-    std::copy(private_key_bytes.begin(), private_key_bytes.end(), private_key.begin());
+    std::copy(private_key_bytes->begin(), private_key_bytes->end(), private_key.begin());
 
     genesis::GenesisGenerator generator(private_key);
 
@@ -106,8 +106,8 @@ int main(int argc, char *argv[])
     std::cout << "Genesis block data and hashes have been written to src/common/genesis_blocks.hpp" << std::endl;
 
     // Output the genesis block hashes to the console
-    std::cout << "Time Chain Genesis Block Hash: " << utilities::bytes_to_hex(bytes(time_genesis_hash.begin(), time_genesis_hash.end())) << std::endl;
-    std::cout << "Value Chain Genesis Block Hash: " << utilities::bytes_to_hex(bytes(value_genesis_hash.begin(), value_genesis_hash.end())) << std::endl;
+    std::cout << "Time Chain Genesis Block Hash: " << hex::encode(time_genesis_hash) << std::endl;
+    std::cout << "Value Chain Genesis Block Hash: " << hex::encode(value_genesis_hash) << std::endl;
 
     return 0;
 }
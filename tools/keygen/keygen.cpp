@@ -1,6 +1,6 @@
 #include <iostream>
 #include "../src/cryptography/cryptography.hpp"
-#include "../src/common/utilities.hpp"
+#include "../src/common/hex.hpp"
 
 int main()
 {
@@ -8,7 +8,7 @@ int main()
   PrivateKey private_key = cryptography::generate_private_key();
 
   // Convert the private key to a hexadecimal string
-  std::string private_key_hex = utilities::bytes_to_hex(bytes(private_key.begin(), private_key.end()));
+  std::string private_key_hex = hex::encode(private_key);
 
   // Output the generated private key
   std::cout << "Generated Private Key: " << private_key_hex << std::endl;
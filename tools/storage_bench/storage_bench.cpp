@@ -0,0 +1,185 @@
+// storage_bench.cpp
+//
+// Compares the block storage backends on the same workload: appending a
+// chain of time blocks, fetching them back in random order by hash, and
+// scanning them by height where the backend keeps a height index.
+//
+// Usage: storage_bench [--blocks N] [--batch N] [--sync] [--dir PATH]
+
+#include "../../src/common/types.hpp"
+#include "../../src/cryptography/cryptography.hpp"
+#include "../../src/storage/file_storage.hpp"
+#include "../../src/storage/segment_storage.hpp"
+#include "../../src/time_chain/time_block.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+    struct BenchOptions
+    {
+        size_t blocks = 20000;
+        size_t batch = 1;
+        bool sync_writes = false;
+        std::string directory = "storage_bench_data";
+    };
+
+    struct Backend
+    {
+        std::string name;
+        std::function<std::unique_ptr<StorageInterface<TimeBlock>>()> create;
+    };
+
+    double seconds_since(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    void print_rate(const std::string &backend, const char *phase, size_t count, double seconds)
+    {
+        std::printf("%-16s %-8s %10zu blocks %9.3f s %12.0f blocks/s\n", backend.c_str(), phase, count, seconds,
+                    seconds > 0 ? count / seconds : 0.0);
+    }
+
+    bool run(const Backend &backend, const BenchOptions &options, const std::vector<TimeBlock> &chain)
+    {
+        std::string directory = options.directory + "/" + backend.name;
+        fs::remove_all(directory);
+        auto storage = backend.create();
+        if (!storage->initialize(directory))
+        {
+            std::fprintf(stderr, "%s: failed to initialize storage in %s\n", backend.name.c_str(), directory.c_str());
+            return false;
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < chain.size(); i += options.batch)
+        {
+            size_t count = std::min(options.batch, chain.size() - i);
+            if (!storage->store_blocks(std::span<const TimeBlock>(chain.data() + i, count)))
+            {
+                std::fprintf(stderr, "%s: store failed at block %zu\n", backend.name.c_str(), i);
+                return false;
+            }
+        }
+        print_rate(backend.name, "append", chain.size(), seconds_since(start));
+
+        // Reopen so the reads are not served from anything the writes left in memory
+        storage->close();
+        storage = backend.create();
+        if (!storage->initialize(directory))
+        {
+            std::fprintf(stderr, "%s: failed to reopen storage\n", backend.name.c_str());
+            return false;
+        }
+
+        std::vector<size_t> order(chain.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::shuffle(order.begin(), order.end(), std::mt19937_64(42));
+        start = std::chrono::steady_clock::now();
+        for (size_t index : order)
+        {
+            if (!storage->get_block(chain[index].get_hash()))
+            {
+                std::fprintf(stderr, "%s: block %zu is missing\n", backend.name.c_str(), index);
+                return false;
+            }
+        }
+        print_rate(backend.name, "get", chain.size(), seconds_since(start));
+
+        start = std::chrono::steady_clock::now();
+        size_t scanned = storage->scan(0, UINT64_MAX, [](const TimeBlock &)
+                                       { return true; });
+        if (scanned > 0)
+        {
+            print_rate(backend.name, "scan", scanned, seconds_since(start));
+        }
+
+        storage->close();
+        fs::remove_all(directory);
+        return true;
+    }
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    BenchOptions options;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--blocks") == 0 && i + 1 < argc)
+        {
+            options.blocks = std::stoul(argv[++i]);
+        }
+        else if (std::strcmp(argv[i], "--batch") == 0 && i + 1 < argc)
+        {
+            options.batch = std::max<size_t>(1, std::stoul(argv[++i]));
+        }
+        else if (std::strcmp(argv[i], "--sync") == 0)
+        {
+            options.sync_writes = true;
+        }
+        else if (std::strcmp(argv[i], "--dir") == 0 && i + 1 < argc)
+        {
+            options.directory = argv[++i];
+        }
+        else
+        {
+            std::fprintf(stderr, "Usage: %s [--blocks N] [--batch N] [--sync] [--dir PATH]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    // The storage backends log every write; keep that out of the timings
+    std::cout.rdbuf(nullptr);
+
+    PublicKey public_key = cryptography::derive_public_key(cryptography::generate_private_key());
+    std::vector<TimeBlock> chain;
+    chain.reserve(options.blocks);
+    Hash previous_hash = {};
+    for (size_t i = 0; i < options.blocks; ++i)
+    {
+        chain.emplace_back(previous_hash, static_cast<TimePoint>(i + 1), public_key);
+        previous_hash = chain.back().get_hash();
+    }
+
+    auto segment_options = [&](IoEngine engine)
+    {
+        SegmentStorageOptions segment;
+        segment.sync_writes = options.sync_writes;
+        segment.io_engine = engine;
+        // Reads go through the I/O engine rather than the page cache mappings
+        segment.memory_map = false;
+        return segment;
+    };
+    std::vector<Backend> backends = {
+        {"file", []
+         { return std::make_unique<FileStorage<TimeBlock>>(); }},
+        {"segment-psync", [&]
+         { return std::make_unique<SegmentStorage<TimeBlock>>(segment_options(IoEngine::psync)); }},
+        {"segment-uring", [&]
+         { return std::make_unique<SegmentStorage<TimeBlock>>(segment_options(IoEngine::io_uring)); }},
+    };
+
+    std::printf("%zu blocks, batches of %zu, %s\n", options.blocks, options.batch,
+                options.sync_writes ? "synced commits" : "unsynced commits");
+    for (const Backend &backend : backends)
+    {
+        if (!run(backend, options, chain))
+        {
+            return 1;
+        }
+    }
+    fs::remove_all(options.directory);
+    return 0;
+}